@@ -188,6 +188,7 @@ CompoundHandler::CompoundHandler(const QString &xmlDir)
     m_members(0),
     m_xmlDir(xmlDir), 
     m_refCount(1), 
+    m_xmlSize(0),
     m_memberDict(257), 
     m_memberNameDict(257),
     m_mainHandler(0)
@@ -466,6 +467,7 @@ bool CompoundHandler::parseXML(const char *compId)
 {
   QFile xmlFile(m_xmlDir+"/"+compId+".xml");
   if (!xmlFile.exists()) return FALSE;
+  m_xmlSize = xmlFile.size();
   CompoundErrorHandler errorHandler;
   QXmlInputSource source( xmlFile );
   QXmlSimpleReader reader;
@@ -530,8 +532,7 @@ void CompoundHandler::release()
   debug(2,"CompoundHandler::release() %d->%d\n",m_refCount,m_refCount-1);
   if (--m_refCount<=0)
   {
-    m_mainHandler->unloadCompound(this);
-    delete this; 
+    m_mainHandler->unloadCompound(this); // deletes or caches this compound
   }
 }
 
@@ -144,6 +144,8 @@ class CompoundHandler : public IClass,
     virtual void startTemplateParamList(const QXmlAttributes& attrib);
     virtual void startListOfAllMembers(const QXmlAttributes& attrib);
     virtual void addref() { m_refCount++; }
+    int refCount() const { return m_refCount; }
+    uint xmlSize() const { return m_xmlSize; }
 
     CompoundHandler(const QString &dirName);
     virtual ~CompoundHandler();
@@ -226,6 +228,7 @@ class CompoundHandler : public IClass,
     // local variables
     QString                        m_xmlDir;                    // directory where the info is found
     int                            m_refCount;                  // object reference counter
+    uint                           m_xmlSize;                   // size of the XML file
     QDict<MemberHandler>           m_memberDict;                // id->member lookup
     QDict<QList<MemberHandler> >   m_memberNameDict;            // name->memberlist lookup
     MainHandler*                   m_mainHandler;               // parent object
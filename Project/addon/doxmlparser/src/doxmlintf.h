@@ -1113,6 +1113,17 @@ class IDoxygen
      */
     virtual ICompoundIterator *memberByName(const char * name) const = 0;
 
+    /*! Returns a member given its \a id, without loading the compound 
+     *  that contains it. Only the member's own element is read from disk,
+     *  using the offset index built when indexed access is enabled
+     *  (see setIndexedAccess()). The returned member is owned by the 
+     *  object model and stays valid until the next call to this function,
+     *  or longer if it fits in the memory budget. Its compound() and 
+     *  section() are not available. Returns 0 if the id is not found or 
+     *  indexed access is disabled.
+     */
+    virtual IMember *memberDefById(const char * id) const = 0;
+
     /*! Releases the memory for the object hierarchy obtained by 
      *  createdObjecModelFromXML(). First release all iterators before calling
      *  this function.
@@ -1126,6 +1137,21 @@ class IDoxygen
      */
     virtual void setDebugLevel(int level) = 0;
 
+    /*! Enables indexed access. Must be called before readXMLDir().
+     *  The first time a member is requested via memberDefById(), the byte 
+     *  offset of each member in its compound file is recorded in a sidecar
+     *  file \c index.idx in the XML directory. Later runs read the sidecar 
+     *  instead of \c index.xml as long as it is newer.
+     */
+    virtual void setIndexedAccess(bool enable) = 0;
+
+    /*! Sets the number of bytes of XML data that may stay in memory after
+     *  compounds have been released. Released compounds are kept until 
+     *  the budget is exceeded and then dropped, least recently used first.
+     *  The default of 0 unloads a compound as soon as it is released.
+     */
+    virtual void setMemoryBudget(unsigned long bytes) = 0;
+
     /*! Reads an XML directory produced by doxygen and builds up a data 
      *  structure representing the contents of the XML files in the directory. 
      */
@@ -14,6 +14,16 @@
  */
 
 #include <qxml.h>
+#include <qfileinfo.h>
+#include <qdatastream.h>
+#if !defined(_WIN32)
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <string.h>
 #include "mainhandler.h"
 #include "compoundhandler.h"
 #include "sectionhandler.h"
@@ -50,6 +60,175 @@ class ErrorHandler : public QXmlErrorHandler
 
 //--------------------------------------------------------------------------
 
+static const char *    offsetIndexName    = "/index.idx";
+static const Q_UINT32  offsetIndexMagic   = 0x44584f49; // "DXOI"
+static const Q_UINT32  offsetIndexVersion = 1;
+
+/*! Read-only view on the contents of a compound file. On systems that
+ *  support it the file is memory mapped, so only the pages that are 
+ *  actually touched are read from disk.
+ */
+class MappedFile
+{
+  public:
+    MappedFile(const QString &name) : m_name(name), m_data(0), m_size(0)
+    {
+#if defined(_WIN32)
+      QFile f(name);
+      if (f.open(IO_ReadOnly))
+      {
+        uint size = f.size();
+        m_buf.resize(size+1);
+        if (f.readBlock(m_buf.data(),size)==(int)size)
+        {
+          m_data = m_buf.data();
+          m_size = size;
+        }
+      }
+#else
+      int fd = open(name.utf8(),O_RDONLY);
+      if (fd!=-1)
+      {
+        struct stat st;
+        if (fstat(fd,&st)==0 && st.st_size>0)
+        {
+          void *p = mmap(0,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+          if (p!=MAP_FAILED)
+          {
+            m_data = (const char *)p;
+            m_size = st.st_size;
+          }
+        }
+        close(fd);
+      }
+#endif
+    }
+   ~MappedFile()
+    {
+#if !defined(_WIN32)
+      if (m_data) munmap((void *)m_data,m_size);
+#endif
+    }
+    const QString &name() const { return m_name; }
+    const char *data() const { return m_data; }
+    uint size() const { return m_size; }
+
+  private:
+    QString     m_name;
+    const char *m_data;
+    uint        m_size;
+#if defined(_WIN32)
+    QByteArray  m_buf;
+#endif
+};
+
+/*! Returns the position of \a str in \a data starting the search at 
+ *  \a from, or -1 if it is not found.
+ */
+static int findString(const char *data,uint size,uint from,const char *str)
+{
+  uint len = strlen(str);
+  while (from+len<=size)
+  {
+    const char *p = (const char *)memchr(data+from,str[0],size-from-len+1);
+    if (p==0) break;
+    if (memcmp(p,str,len)==0) return p-data;
+    from = p-data+1;
+  }
+  return -1;
+}
+
+/*! Records the byte range of each <memberdef> element found in 
+ *  \a file in the member entries of compound \a ce.
+ */
+static void scanMemberOffsets(const MappedFile &file,CompoundEntry *ce)
+{
+  QDict<MemberEntry> idDict(ce->memberDict.size());
+  QDictIterator<MemberEntry> mdi(ce->memberDict);
+  MemberEntry *me;
+  for (mdi.toFirst();(me=mdi.current());++mdi)
+  {
+    idDict.insert(me->id.utf8(),me);
+  }
+  const char *data = file.data();
+  uint size = file.size();
+  int start = 0;
+  while ((start=findString(data,size,start,"<memberdef "))!=-1)
+  {
+    int tagEnd = findString(data,size,start,">");
+    int end    = findString(data,size,start,"</memberdef>");
+    if (tagEnd==-1 || end==-1) break;
+    end += 12; // strlen("</memberdef>")
+    int idPos  = findString(data,tagEnd,start," id=\"");
+    if (idPos!=-1)
+    {
+      idPos += 5;
+      int idEnd = findString(data,tagEnd,idPos,"\"");
+      if (idEnd!=-1)
+      {
+        QCString id(idEnd-idPos+1);
+        memcpy(id.rawData(),data+idPos,idEnd-idPos);
+        MemberEntry *me = idDict.find(id);
+        if (me)
+        {
+          me->offset = start;
+          me->length = end-start;
+        }
+      }
+    }
+    start = end;
+  }
+}
+
+/*! Parses a single <memberdef> element taken from a compound file. */
+class MemberDefHandler : public BaseHandler<MemberDefHandler>
+{
+  public:
+    MemberDefHandler() : m_member(0)
+    {
+      addStartHandler("memberdef",this,&MemberDefHandler::startMember);
+    }
+    virtual ~MemberDefHandler() {}
+
+    void startMember(const QXmlAttributes& attrib)
+    {
+      m_member = new MemberHandler(this);
+      m_member->startMember(attrib);
+    }
+
+    MemberHandler *parse(const char *data,uint len)
+    {
+      ErrorHandler errorHandler;
+      QXmlInputSource source;
+      source.setData(QString::fromUtf8(data,len));
+      QXmlSimpleReader reader;
+      reader.setContentHandler( this );
+      reader.setErrorHandler( &errorHandler );
+      reader.parse( source );
+      if (delegate()) // element was not complete
+      {
+        setDelegate(0);
+        delete m_member;
+        m_member=0;
+      }
+      return m_member;
+    }
+
+  private:
+    MemberHandler *m_member;
+};
+
+/*! A member loaded via MainHandler::memberDefById() */
+struct CachedMember
+{
+  CachedMember(MemberHandler *m,uint s) : member(m), size(s) {}
+ ~CachedMember() { delete member; }
+  MemberHandler *member;
+  uint           size;
+};
+
+//--------------------------------------------------------------------------
+
 class CompoundEntryIterator : public ICompoundIterator, 
                               public QListIterator<CompoundEntry>
 {
@@ -90,10 +269,14 @@ class CompoundEntryIterator : public ICompoundIterator,
 
 MainHandler::MainHandler() : m_compoundDict(2999), m_compoundNameDict(2999),
                              m_memberDict(12251), m_memberNameDict(12251),
-                             m_compoundsLoaded(1009)
+                             m_compoundsLoaded(1009),
+                             m_indexedAccess(FALSE), m_offsetsKnown(FALSE),
+                             m_memoryBudget(0), m_cachedBytes(0),
+                             m_mappedFile(0)
 {
   m_compounds.setAutoDelete(TRUE);
   m_memberNameDict.setAutoDelete(TRUE);
+  m_cachedMembers.setAutoDelete(TRUE);
   addStartHandler("doxygenindex"); 
   addEndHandler("doxygenindex");
   addStartHandler("compound",this,&MainHandler::startCompound);
@@ -180,9 +363,122 @@ void MainHandler::dump()
   }
 }
 
+void MainHandler::setIndexedAccess(bool enable)
+{
+  m_indexedAccess = enable;
+}
+
+void MainHandler::setMemoryBudget(unsigned long bytes)
+{
+  m_memoryBudget = bytes;
+  evict();
+}
+
+bool MainHandler::readOffsetIndex()
+{
+  QFileInfo idxInfo(m_xmlDirName+offsetIndexName);
+  QFileInfo xmlInfo(m_xmlDirName+"/index.xml");
+  if (!idxInfo.exists() || 
+      (xmlInfo.exists() && idxInfo.lastModified()<xmlInfo.lastModified())
+     )
+  {
+    return FALSE; // no index or out of date
+  }
+  QFile f(idxInfo.filePath());
+  if (!f.open(IO_ReadOnly)) return FALSE;
+  QDataStream s(&f);
+  Q_UINT32 magic,version,numCompounds;
+  s >> magic >> version >> numCompounds;
+  if (magic!=offsetIndexMagic || version!=offsetIndexVersion) return FALSE;
+  uint i,j;
+  for (i=0;i<numCompounds && !f.atEnd();i++)
+  {
+    CompoundEntry *ce = new CompoundEntry(257);
+    Q_UINT32 numMembers;
+    s >> ce->id >> ce->name >> numMembers;
+    m_compounds.append(ce);
+    m_compoundDict.insert(ce->id.utf8(),ce);
+    m_compoundNameDict.insert(ce->name.utf8(),ce);
+    for (j=0;j<numMembers;j++)
+    {
+      MemberEntry *me = new MemberEntry;
+      Q_UINT32 offset,length;
+      s >> me->id >> me->name >> offset >> length;
+      me->compound = ce;
+      me->offset   = offset;
+      me->length   = length;
+      m_memberDict.insert(me->id.utf8(),me);
+      ce->memberDict.insert(me->name.utf8(),me);
+      QList<CompoundEntry> *cel=0;
+      if ((cel=m_memberNameDict.find(me->name.utf8()))==0)
+      {
+        cel = new QList<CompoundEntry>;
+        m_memberNameDict.insert(me->name.utf8(),cel);
+      }
+      cel->append(ce);
+    }
+  }
+  if (i<numCompounds || f.status()!=IO_Ok) // truncated or unreadable index
+  {
+    debug(1,"Offset index %s is corrupt, ignoring it\n",
+        idxInfo.filePath().data());
+    m_memberNameDict.clear();
+    m_memberDict.clear();
+    m_compoundNameDict.clear();
+    m_compoundDict.clear();
+    m_compounds.clear();
+    return FALSE;
+  }
+  return TRUE;
+}
+
+void MainHandler::buildOffsetIndex()
+{
+  QListIterator<CompoundEntry> cli(m_compounds);
+  CompoundEntry *ce;
+  for (cli.toFirst();(ce=cli.current());++cli)
+  {
+    if (ce->memberDict.isEmpty()) continue;
+    MappedFile file(m_xmlDirName+"/"+ce->id+".xml");
+    if (file.data()) scanMemberOffsets(file,ce);
+  }
+  m_offsetsKnown = TRUE;
+  writeOffsetIndex();
+}
+
+void MainHandler::writeOffsetIndex()
+{
+  QFile f(m_xmlDirName+offsetIndexName);
+  if (!f.open(IO_WriteOnly))
+  {
+    debug(1,"Could not write offset index %s\n",f.name().data());
+    return;
+  }
+  QDataStream s(&f);
+  s << offsetIndexMagic << offsetIndexVersion << (Q_UINT32)m_compounds.count();
+  QListIterator<CompoundEntry> cli(m_compounds);
+  CompoundEntry *ce;
+  for (cli.toFirst();(ce=cli.current());++cli)
+  {
+    s << ce->id << ce->name << (Q_UINT32)ce->memberDict.count();
+    QDictIterator<MemberEntry> mdi(ce->memberDict);
+    MemberEntry *me;
+    for (mdi.toFirst();(me=mdi.current());++mdi)
+    {
+      s << me->id << me->name << (Q_UINT32)me->offset << (Q_UINT32)me->length;
+    }
+  }
+}
+
 bool MainHandler::readXMLDir(const char * xmlDirName)
 {
   m_xmlDirName = xmlDirName;
+  if (m_indexedAccess && readOffsetIndex())
+  {
+    m_offsetsKnown = TRUE;
+    dump();
+    return TRUE;
+  }
   QString xmlFileName=m_xmlDirName+"/index.xml";
   QFile xmlFile(xmlFileName);
   //printf("Trying %s xmlFile.exists()=%d isReadable()=%d\n",
@@ -213,6 +509,12 @@ ICompound *MainHandler::compoundById(const char *id) const
   CompoundHandler *ch = m_compoundsLoaded[ids.utf8()];
   if (ch) // compound already in memory
   {
+    if (ch->refCount()==0) // released, but still in the cache
+    {
+      MainHandler *that = (MainHandler *)this;
+      that->m_cachedCompounds.removeRef(ch);
+      that->m_cachedBytes-=ch->xmlSize();
+    }
     ch->addref(); // returning alias -> increase reference counter
     return ch->toICompound(); 
   }
@@ -238,9 +540,71 @@ ICompound *MainHandler::compoundById(const char *id) const
 
 void MainHandler::unloadCompound(CompoundHandler *ch)
 {
+  if (m_memoryBudget>0) // keep it while it fits in the budget
+  {
+    m_cachedCompounds.append(ch);
+    m_cachedBytes+=ch->xmlSize();
+    evict();
+    return;
+  }
   //printf("unloading compound %s from memory\n",ch->id()->latin1());
   bool result = m_compoundsLoaded.remove(ch->id()->latin1()); 
   if (!result) debug(1,"Failed to unload component!\n");
+  delete ch;
+}
+
+void MainHandler::cacheMember(MemberHandler *mh,uint size)
+{
+  m_cachedMembers.append(new CachedMember(mh,size));
+  m_cachedBytes+=size;
+  evict();
+}
+
+void MainHandler::evict()
+{
+  // drop released compounds first, least recently used first
+  while (m_cachedBytes>m_memoryBudget && !m_cachedCompounds.isEmpty())
+  {
+    CompoundHandler *ch = m_cachedCompounds.take(0);
+    m_cachedBytes-=ch->xmlSize();
+    m_compoundsLoaded.remove(ch->id()->latin1());
+    delete ch;
+  }
+  // then standalone members, but keep the one returned last
+  while (m_cachedBytes>m_memoryBudget && m_cachedMembers.count()>1)
+  {
+    m_cachedBytes-=m_cachedMembers.getFirst()->size;
+    m_cachedMembers.removeFirst();
+  }
+}
+
+IMember *MainHandler::memberDefById(const char *id) const
+{
+  QString ids = id;
+  if (ids.isEmpty() || !m_indexedAccess) return 0;
+  // we disregard the constness here, because the object stays conceptually
+  // unchanged.
+  MainHandler *that = (MainHandler *)this;
+  if (!m_offsetsKnown) that->buildOffsetIndex();
+  MemberEntry *me = m_memberDict[id];
+  if (me==0 || me->length==0) return 0; // id not found
+  QString fileName = m_xmlDirName+"/"+me->compound->id+".xml";
+  if (m_mappedFile==0 || m_mappedFile->name()!=fileName)
+  {
+    delete m_mappedFile;
+    that->m_mappedFile = new MappedFile(fileName);
+  }
+  if (me->offset+me->length>m_mappedFile->size())
+  {
+    debug(1,"Offset index is out of date for %s\n",fileName.data());
+    return 0;
+  }
+  MemberDefHandler handler;
+  MemberHandler *mh = handler.parse(m_mappedFile->data()+me->offset,me->length);
+  if (mh==0) return 0;
+  mh->initialize(that);
+  that->cacheMember(mh,me->length);
+  return (IFunction*)mh;
 }
 
 ICompound *MainHandler::compoundByName(const char *name) const
@@ -287,8 +651,16 @@ void MainHandler::release()
   CompoundHandler *ch;
   for (chi.toFirst();(ch=chi.current());++chi)
   {
-    debug(1,"Compound %s not released\n",ch->name()->latin1());
+    if (ch->refCount()>0)
+    {
+      debug(1,"Compound %s not released\n",ch->name()->latin1());
+    }
   }
+  m_memoryBudget=0;
+  evict();
+  m_cachedMembers.clear();
+  delete m_mappedFile;
+  m_mappedFile=0;
   graphhandler_exit();
   dochandler_exit();
   memberhandler_exit();
@@ -22,7 +22,10 @@
 #include "basehandler.h"
 
 class CompoundHandler;
+class MemberHandler;
+class MappedFile;
 struct CompoundEntry;
+struct CachedMember;
 
 struct IndexEntry
 {
@@ -32,7 +35,10 @@ struct IndexEntry
 
 struct MemberEntry : public IndexEntry
 {
+    MemberEntry() : compound(0), offset(0), length(0) {}
     CompoundEntry *compound;
+    uint           offset; // byte offset of <memberdef> in the compound file
+    uint           length; // length of the <memberdef> element, 0 if unknown
 };
 
 struct CompoundEntry : public IndexEntry
@@ -59,9 +65,12 @@ class MainHandler : public IDoxygen, public BaseHandler<MainHandler>
     virtual ICompound *compoundByName(const char *name) const;
     virtual ICompound *memberById(const char *id) const;
     virtual ICompoundIterator *memberByName(const char *name) const;
+    virtual IMember *memberDefById(const char *id) const;
 
     virtual void release();
     void setDebugLevel(int level);
+    void setIndexedAccess(bool enable);
+    void setMemoryBudget(unsigned long bytes);
     bool readXMLDir(const char *dirName);
     void dump();
     void unloadCompound(CompoundHandler *ch);
@@ -77,6 +86,20 @@ class MainHandler : public IDoxygen, public BaseHandler<MainHandler>
     QString                      m_xmlDirName;
     QDict<CompoundHandler>       m_compoundsLoaded;
     bool                         m_insideMember;
+
+    // indexed access
+    bool readOffsetIndex();
+    void buildOffsetIndex();
+    void writeOffsetIndex();
+    void cacheMember(MemberHandler *mh,uint size);
+    void evict();
+    bool                         m_indexedAccess;
+    bool                         m_offsetsKnown;
+    unsigned long                m_memoryBudget;
+    unsigned long                m_cachedBytes;
+    QList<CompoundHandler>       m_cachedCompounds; // released, least recently used first
+    QList<CachedMember>          m_cachedMembers;   // loaded by memberDefById()
+    MappedFile                  *m_mappedFile;
 };
 
 #endif
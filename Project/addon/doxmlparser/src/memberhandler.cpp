@@ -517,6 +517,7 @@ void MemberHandler::setCompoundHandler(CompoundHandler *c)
 
 ICompound *MemberHandler::compound() const
 {
+  if (m_compound==0) return 0; // member loaded via MainHandler::memberDefById()
   m_compound->addref();
   return m_compound->toICompound();
 }
@@ -23,6 +23,9 @@
 #include <fstream>
 #include <string>
 #include <algorithm>
+#include <map>
+#include <cstring>
+#include <cctype>
 
 // Xapian includes
 #include <xapian.h>
@@ -306,6 +309,273 @@ static void showError(const std::string &callback,const std::string &error)
   exit(0);
 }
 
+//----------------------------------------------------------------------------
+// reader for the search index written by doxygen's built-in server side
+// search (search/search.idx), see searchindex.cpp for the file format.
+
+/** Occurrences of a word in one document of the index */
+struct Posting
+{
+  Posting(unsigned int u,unsigned int f) : urlIdx(u), freq(f) {}
+  unsigned int urlIdx;
+  unsigned int freq;   // occurrences*2, bit 0 is set for high priority docs
+};
+
+/** Word of the index that starts with a word of the query */
+struct WordMatch
+{
+  std::string word;
+  bool full;
+  std::vector<Posting> postings;
+};
+
+/** Reads only the parts of the index needed to answer a query: the skip
+ *  index is binary searched, and then one block of words is scanned.
+ */
+class SearchIndexFile
+{
+  public:
+    SearchIndexFile() : m_file(0), m_numWords(0), m_numUrls(0),
+                        m_urlTable(0), m_skipIndex(0), m_numBlocks(0) {}
+   ~SearchIndexFile() { if (m_file) fclose(m_file); }
+
+    bool open(const std::string &fileName)
+    {
+      m_file = fopen(fileName.c_str(),"rb");
+      if (m_file==0) return false;
+      char header[4];
+      if (fread(header,1,4,m_file)!=4 || memcmp(header,"DOX2",4)!=0) return false;
+      if (fseek(m_file,-16,SEEK_END)!=0) return false;
+      m_numWords  = readInt();
+      m_numUrls   = readInt();
+      m_urlTable  = readInt();
+      m_skipIndex = readInt();
+      m_numBlocks = (m_numWords+blockSize-1)/blockSize;
+      return true;
+    }
+
+    /** Adds all words of the index starting with \a word to \a matches */
+    void find(const std::string &word,std::vector<WordMatch> &matches)
+    {
+      if (m_numBlocks==0) return;
+      unsigned int block = findBlock(word);
+      fseek(m_file,blockOffset(block),SEEK_SET);
+      std::string w;
+      for (unsigned int i=block*blockSize;i<m_numWords;i++)
+      {
+        unsigned int prefixLen = readVarInt();
+        unsigned int len       = readVarInt();
+        w = w.substr(0,prefixLen)+readBytes(len);
+        unsigned int numUrls   = readVarInt();
+        bool match = w.compare(0,word.length(),word)==0;
+        if (!match && w>word) break; // past all words starting with word
+        if (match)
+        {
+          matches.push_back(WordMatch());
+          WordMatch &m = matches.back();
+          m.word = w;
+          m.full = w.length()==word.length();
+          m.postings.reserve(numUrls);
+        }
+        unsigned int urlIdx=0;
+        for (unsigned int j=0;j<numUrls;j++)
+        {
+          urlIdx+=readVarInt();
+          unsigned int freq=readVarInt();
+          if (match) matches.back().postings.push_back(Posting(urlIdx,freq));
+        }
+      }
+    }
+
+    /** Returns the name and url of document \a urlIdx */
+    void document(unsigned int urlIdx,std::string &name,std::string &url)
+    {
+      fseek(m_file,m_urlTable+urlIdx*4,SEEK_SET);
+      fseek(m_file,readInt(),SEEK_SET);
+      name = readString();
+      url  = readString();
+    }
+
+  private:
+    static const unsigned int blockSize = 64;
+
+    unsigned int readInt()
+    {
+      unsigned char b[4];
+      if (fread(b,1,4,m_file)!=4) return 0;
+      return (b[0]<<24)|(b[1]<<16)|(b[2]<<8)|b[3];
+    }
+    unsigned int readVarInt()
+    {
+      unsigned int result=0;
+      int shift=0,c;
+      do
+      {
+        if ((c=fgetc(m_file))==EOF) return result;
+        result|=(c&0x7f)<<shift;
+        shift+=7;
+      } while (c&0x80);
+      return result;
+    }
+    std::string readBytes(unsigned int len)
+    {
+      std::string s(len,'\0');
+      if (len>0 && fread(&s[0],1,len,m_file)!=len) s.clear();
+      return s;
+    }
+    std::string readString()
+    {
+      std::string s;
+      int c;
+      while ((c=fgetc(m_file))!=EOF && c!=0) s+=(char)c;
+      return s;
+    }
+    unsigned int blockOffset(unsigned int block)
+    {
+      fseek(m_file,m_skipIndex+block*4,SEEK_SET);
+      return readInt();
+    }
+    std::string firstWord(unsigned int block)
+    {
+      fseek(m_file,blockOffset(block),SEEK_SET);
+      readVarInt(); // prefix length, always 0 at the start of a block
+      return readBytes(readVarInt());
+    }
+    /** Returns the last block starting with a word <= \a word */
+    unsigned int findBlock(const std::string &word)
+    {
+      unsigned int lo=0,hi=m_numBlocks,found=0;
+      while (lo<hi)
+      {
+        unsigned int mid=(lo+hi)/2;
+        if (firstWord(mid)<=word)
+        {
+          found=mid;
+          lo=mid+1;
+        }
+        else
+        {
+          hi=mid;
+        }
+      }
+      return found;
+    }
+
+    FILE *m_file;
+    unsigned int m_numWords;
+    unsigned int m_numUrls;
+    unsigned int m_urlTable;
+    unsigned int m_skipIndex;
+    unsigned int m_numBlocks;
+};
+
+/** Document found by a query on a SearchIndexFile */
+struct IndexHit
+{
+  IndexHit() : urlIdx(0), rank(0.0) {}
+  unsigned int urlIdx;
+  double rank;
+};
+
+/** Class representing the '>' operator for IndexHit objects based on rank. */
+struct IndexHit_greater
+{
+  bool operator()(const IndexHit &h1,const IndexHit &h2)
+  {
+    return h1.rank>h2.rank;
+  }
+};
+
+/** Performs the query for \a words on \a index and writes the results as
+ *  JSONP. The ranking is the same as the one of doxygen's search.php.
+ */
+static void searchIndexFile(SearchIndexFile &index,const std::string &callback,
+                            const std::string &searchFor,const std::vector<std::string> &words,
+                            int num,int page)
+{
+  std::map<unsigned int,double> ranks;
+  for (std::vector<std::string>::const_iterator it=words.begin();it!=words.end();++it)
+  {
+    std::string word = *it;
+    std::transform(word.begin(),word.end(),word.begin(),::tolower);
+    if (word.length()<2) continue;
+    std::vector<WordMatch> matches;
+    index.find(word,matches);
+    double totalHi=0,totalFreqHi=0,totalFreqLo=0;
+    std::vector<WordMatch>::const_iterator mi;
+    std::vector<Posting>::const_iterator pi;
+    for (mi=matches.begin();mi!=matches.end();++mi)
+    {
+      int multiplier = mi->full ? 2 : 1; // whole word matches have a double weight
+      for (pi=mi->postings.begin();pi!=mi->postings.end();++pi)
+      {
+        if (pi->freq&1) // word occurs in high priority doc
+        {
+          totalHi++;
+          totalFreqHi+=pi->freq*multiplier;
+        }
+        else
+        {
+          totalFreqLo+=pi->freq*multiplier;
+        }
+      }
+    }
+    double totalFreq=(totalHi+1)*totalFreqLo+totalFreqHi;
+    for (mi=matches.begin();mi!=matches.end();++mi)
+    {
+      int multiplier = mi->full ? 2 : 1;
+      for (pi=mi->postings.begin();pi!=mi->postings.end();++pi)
+      {
+        double freq = (pi->freq>>1)*multiplier;
+        if (pi->freq&1) freq+=totalFreqLo;
+        ranks[pi->urlIdx]+=freq/totalFreq;
+      }
+    }
+  }
+  std::vector<IndexHit> hits;
+  hits.reserve(ranks.size());
+  for (std::map<unsigned int,double>::const_iterator ri=ranks.begin();ri!=ranks.end();++ri)
+  {
+    IndexHit hit;
+    hit.urlIdx = ri->first;
+    hit.rank   = ri->second;
+    hits.push_back(hit);
+  }
+  std::stable_sort(hits.begin(),hits.end(),IndexHit_greater());
+
+  unsigned int numHits = hits.size();
+  unsigned int offset  = page*num;
+  unsigned int pages   = num>0 ? (numHits+num-1)/num : 0;
+  if (offset>numHits)     offset=numHits;
+  if (offset+num>numHits) num=numHits-offset;
+
+  // write results as JSONP
+  std::cout << callback.c_str() << "(";
+  std::cout << "{" << std::endl
+            << "  \"hits\":"   << numHits << "," << std::endl
+            << "  \"first\":"  << offset  << "," << std::endl
+            << "  \"count\":"  << num     << "," << std::endl
+            << "  \"page\":"   << page    << "," << std::endl
+            << "  \"pages\":"  << pages   << "," << std::endl
+            << "  \"query\": \""  << escapeString(searchFor)  << "\"," << std::endl
+            << "  \"items\":[" << std::endl;
+  for (unsigned int o=offset;o<offset+num;o++)
+  {
+    std::string name,url;
+    index.document(hits[o].urlIdx,name,url);
+    std::cout << "  {\"type\": \"\"," << std::endl
+              << "   \"name\": \"" << escapeString(name) << "\"," << std::endl
+              << "   \"tag\": \"\"," << std::endl
+              << "   \"url\": \""  << escapeString(url) << "\"," << std::endl
+              << "   \"fragments\":[" << std::endl
+              << "   ]" << std::endl
+              << "  }";
+    if (o<offset+num-1) std::cout << ",";
+    std::cout << std::endl;
+  }
+  std::cout << " ]" << std::endl << "})" << std::endl;
+}
+
 /** Main routine */
 int main(int argc,char **argv)
 {
@@ -348,11 +618,16 @@ int main(int argc,char **argv)
       }
     }
 
-    std::string indexDir = "doxysearch.db";
+    std::string indexDir  = "doxysearch.db";
+    std::string indexFile = "search.idx";
+
+    // use doxygen's own index if there is one, otherwise the Xapian database
+    SearchIndexFile index;
+    bool indexFileOk = index.open(indexFile);
 
     if (queryString=="test") // user test
     {
-      bool dbOk = dirExists(indexDir);
+      bool dbOk = indexFileOk || dirExists(indexDir);
       if (dbOk)
       {
         std::cout << "Test successful.";
@@ -364,6 +639,12 @@ int main(int argc,char **argv)
       exit(0);
     }
 
+    if (indexFileOk)
+    {
+      searchIndexFile(index,callback,searchFor,split(searchFor,' '),num,page);
+      exit(0);
+    }
+
     // create query
     Xapian::Database db(indexDir);
     Xapian::Enquire enquire(db);
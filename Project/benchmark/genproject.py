@@ -0,0 +1,199 @@
+#!/usr/bin/python
+#
+# Generates a synthetic C++ project to benchmark doxygen with.
+#
+# The project consists of headers with documented (template) classes that
+# derive from classes in earlier headers, documented free functions, and
+# for a number of these functions an \ioexample command together with the
+# I/O examples it makes the HTML output read (ioexamples/*.example* and
+# parameterids.txt, relative to the directory doxygen is run from).
+
+from __future__ import print_function
+import argparse, os, random
+
+WORDS = ('value buffer index parser stream node graph entry member symbol '
+         'context scope token output input list cache table record field '
+         'handle offset length result state config option reader writer').split()
+
+TYPES = ('int','long','double','bool','unsigned int','const char *')
+
+FILES_PER_DIR = 100
+
+class Generator:
+	def __init__(self,args):
+		self.args      = args
+		self.random    = random.Random(args.seed)
+		self.symbols   = 0
+		self.functions = [] # (name,[(type,param)])
+
+	def sentence(self,num_words):
+		words = [self.random.choice(WORDS) for i in range(num_words)]
+		return ' '.join(words).capitalize()+'.'
+
+	def comment(self,f,indent,brief,params=None,has_return=False,ioexample=False):
+		print('%s/**' % indent, file=f)
+		print('%s *  \\brief %s' % (indent,brief), file=f)
+		if self.args.comment_lines>0:
+			print('%s *' % indent, file=f)
+			for i in range(self.args.comment_lines):
+				print('%s *  %s' % (indent,self.sentence(10)), file=f)
+		if params:
+			print('%s *' % indent, file=f)
+			for (ptype,pname) in params:
+				print('%s *  \\param %s %s' % (indent,pname,self.sentence(5)), file=f)
+		if has_return:
+			print('%s *  \\return %s' % (indent,self.sentence(4)), file=f)
+		if ioexample:
+			print('%s *  \\ioexample' % indent, file=f)
+		print('%s */' % indent, file=f)
+
+	def params(self):
+		num = self.random.randint(1,4)
+		return [(self.random.choice(TYPES),'%s%d' % (self.random.choice(WORDS),i)) for i in range(num)]
+
+	def file_name(self,i):
+		return 'd%03d/file%05d.h' % (i//FILES_PER_DIR,i)
+
+	def class_name(self,i,j):
+		return 'Class%05d_%d' % (i,j)
+
+	def is_template(self,i,j):
+		# deterministic per class, so derived classes in other files agree
+		return (i*7+j*13)%100 < self.args.template_density*100
+
+	def write_class(self,f,i,j):
+		a = self.args
+		name = self.class_name(i,j)
+		base = ''
+		# each chain of class_depth files forms an inheritance hierarchy
+		if i%a.class_depth!=0:
+			bname = self.class_name(i-1,j%a.classes_per_file)
+			if self.is_template(i-1,j%a.classes_per_file):
+				bname += '<int>'
+			base = ' : public '+bname
+		self.comment(f,'',self.sentence(6))
+		if self.is_template(i,j):
+			print('template<typename T>', file=f)
+		print('class %s%s' % (name,base), file=f)
+		print('{', file=f)
+		print('  public:', file=f)
+		self.symbols += 1
+		for k in range(a.members_per_class):
+			params = self.params()
+			self.comment(f,'    ',self.sentence(5),params,True)
+			rtype = 'T' if self.is_template(i,j) and k%2==0 else self.random.choice(TYPES)
+			plist = ', '.join(['%s %s' % p for p in params])
+			if k%3==0:
+				print('    virtual %s method%d(%s);' % (rtype,k,plist), file=f)
+			else:
+				print('    %s method%d(%s) const;' % (rtype,k,plist), file=f)
+			self.symbols += 1
+		print('  protected:', file=f)
+		self.comment(f,'    ',self.sentence(4))
+		print('    int m_field%d;' % j, file=f)
+		self.symbols += 1
+		print('};', file=f)
+		print('', file=f)
+
+	def write_function(self,f,i,j):
+		name = 'function%05d_%d' % (i,j)
+		params = self.params()
+		# the first functions get the I/O examples written by write_ioexamples()
+		ioexample = len(self.functions)<self.args.ioexamples
+		self.comment(f,'',self.sentence(6),params,True,ioexample)
+		print('int %s(%s);' % (name,', '.join(['%s %s' % p for p in params])), file=f)
+		print('', file=f)
+		self.functions.append((name,params))
+		self.symbols += 1
+
+	def write_file(self,i):
+		a = self.args
+		file_name = self.file_name(i)
+		path = os.path.join(a.outputdir,'src',file_name)
+		if not os.path.isdir(os.path.dirname(path)):
+			os.makedirs(os.path.dirname(path))
+		guard = 'FILE%05d_H' % i
+		with open(path,'w') as f:
+			print('/** \\file', file=f)
+			print(' *  \\brief %s' % self.sentence(8), file=f)
+			print(' */', file=f)
+			print('', file=f)
+			print('#ifndef %s' % guard, file=f)
+			print('#define %s' % guard, file=f)
+			print('', file=f)
+			if i%a.class_depth!=0:
+				print('#include "../%s"' % self.file_name(i-1), file=f)
+				print('', file=f)
+			print('/** \\brief %s */' % self.sentence(4), file=f)
+			print('namespace ns%03d {' % (i//FILES_PER_DIR), file=f)
+			print('', file=f)
+			for j in range(a.classes_per_file):
+				self.write_class(f,i,j)
+			for j in range(a.functions_per_file):
+				self.write_function(f,i,j)
+			print('}', file=f)
+			print('', file=f)
+			print('#endif', file=f)
+
+	def write_ioexamples(self):
+		a = self.args
+		count = min(a.ioexamples,len(self.functions))
+		if count==0:
+			return
+		dir = os.path.join(a.outputdir,'ioexamples')
+		if not os.path.isdir(dir):
+			os.makedirs(dir)
+		with open(os.path.join(a.outputdir,'parameterids.txt'),'w') as ids:
+			for fid in range(count):
+				(name,params) = self.functions[fid]
+				base = os.path.join(dir,name)
+				with open(base+'.parameter.example.i','w') as fi:
+					with open(base+'.parameter.example.o','w') as fo:
+						for (ptype,pname) in params:
+							print('%s\t%d' % (pname,self.random.randint(0,100)), file=fi)
+							print('%s\t%d' % (pname,self.random.randint(0,100)), file=fo)
+				with open(base+'.return.example','w') as fr:
+					fr.write('$return_value\t%d' % self.random.randint(0,1000))
+				pid = 0
+				for (ptype,pname) in params:
+					print('%d\t%d\t%s\t%s\t%s\tdo not know' % (fid,pid,name,ptype,pname), file=ids)
+					pid += 1
+				print('%d\t%d\t%s\tint\t$return_value\tdo not know' % (fid,pid,name), file=ids)
+
+	def run(self):
+		for i in range(self.args.files):
+			self.write_file(i)
+		self.write_ioexamples()
+		return self.symbols
+
+def symbols_per_file(args):
+	return args.classes_per_file*(args.members_per_class+2)+args.functions_per_file
+
+def add_arguments(parser):
+	parser.add_argument('--files',type=int,default=100,help='number of header files to generate')
+	parser.add_argument('--symbols',type=int,help='approximate number of symbols; overrides --files')
+	parser.add_argument('--classes-per-file',type=int,default=4,help='number of classes per file')
+	parser.add_argument('--members-per-class',type=int,default=8,help='number of member functions per class')
+	parser.add_argument('--functions-per-file',type=int,default=4,help='number of free functions per file')
+	parser.add_argument('--class-depth',type=int,default=4,help='depth of the class hierarchies')
+	parser.add_argument('--template-density',type=float,default=0.25,help='fraction of classes that are templates')
+	parser.add_argument('--comment-lines',type=int,default=3,help='lines of detailed description per comment block')
+	parser.add_argument('--ioexamples',type=int,default=10,help='number of functions with I/O examples')
+	parser.add_argument('--seed',type=int,default=1,help='seed for the random generator')
+
+def generate(args):
+	if args.symbols:
+		args.files = max(1,args.symbols//symbols_per_file(args))
+	args.class_depth = max(1,args.class_depth)
+	return Generator(args).run()
+
+def main():
+	parser = argparse.ArgumentParser(description='generate a synthetic C++ project for benchmarking doxygen')
+	parser.add_argument('--outputdir',nargs='?',default='.',help='directory to write the project to')
+	add_arguments(parser)
+	args = parser.parse_args()
+	symbols = generate(args)
+	print('Generated %d files with %d symbols in %s' % (args.files,symbols,args.outputdir))
+
+if __name__ == '__main__':
+	main()
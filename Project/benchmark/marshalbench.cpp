@@ -0,0 +1,171 @@
+/******************************************************************************
+ *
+ * Copyright (C) 1997-2015 by Dimitri van Heesch.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License is hereby
+ * granted. No representations are made about the suitability of this software
+ * for any purpose. It is provided "as is" without express or implied warranty.
+ * See the GNU General Public License for more details.
+ *
+ * Documents produced by Doxygen are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+ */
+
+/** @file
+ *  @brief Micro-benchmark for the marshalling of entries.
+ *
+ *  Parses the given source files into Entry trees and measures how long it
+ *  takes to write all entries to the entry storage and to read them back,
+ *  both with the field by field format (marshalEntry()) and with the block
+ *  format (marshalEntryBlock()), and both with the storage kept in memory
+ *  and in a file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <qfile.h>
+#include <qfileinfo.h>
+#include <qlist.h>
+#include "doxygen.h"
+#include "entry.h"
+#include "marshal.h"
+#include "filestorage.h"
+#include "parserintf.h"
+#include "commentcnv.h"
+#include "bufstr.h"
+#include "profiler.h"
+#include "config.h"
+#include "util.h"
+
+static const char *storageName = "marshalbench.db";
+
+static void collectEntries(Entry *e,QList<Entry> &entries)
+{
+  entries.append(e);
+  QListIterator<Entry> eli(*e->children());
+  Entry *child;
+  for (eli.toFirst();(child=eli.current());++eli)
+  {
+    collectEntries(child,entries);
+  }
+}
+
+static void parseFile(Entry *root,const char *fileName)
+{
+  QCString extension;
+  int ei = QCString(fileName).findRev('.');
+  if (ei!=-1) extension=QCString(fileName).mid(ei);
+  ParserInterface *parser = Doxygen::parserManager->getParser(extension);
+  QFileInfo fi(fileName);
+  BufStr inBuf(fi.size()+4096);
+  if (!readInputFile(fileName,inBuf))
+  {
+    fprintf(stderr,"Cannot read %s\n",fileName);
+    exit(1);
+  }
+  inBuf.addChar('\n');
+  BufStr convBuf(inBuf.curPos()+1024);
+  convertCppComments(&inBuf,&convBuf,fileName);
+  convBuf.addChar('\0');
+  QStrList filesInSameTu;
+  parser->startTranslationUnit(fileName);
+  parser->parseInput(fileName,convBuf.data(),root,FALSE,filesInSameTu);
+  parser->finishTranslationUnit();
+}
+
+/** Writes and reads back all \a entries \a runs times, returns the time
+ *  spent writing and reading in milliseconds and the size of the storage.
+ */
+static void run(QList<Entry> &entries,bool block,uint memLimit,int runs,
+                double &writeTime,double &readTime,int64 &size)
+{
+  int64 *offsets = new int64[entries.count()];
+  writeTime=0;
+  readTime=0;
+  int r;
+  for (r=0;r<runs;r++)
+  {
+    FileStorage storage;
+    storage.setName(storageName);
+    storage.setMemoryLimit(memLimit);
+    double start = Profiler::now();
+    storage.open(IO_WriteOnly);
+    QListIterator<Entry> eli(entries);
+    Entry *e;
+    int i=0;
+    for (eli.toFirst();(e=eli.current());++eli,i++)
+    {
+      offsets[i]=storage.pos();
+      if (block) marshalEntryBlock(&storage,e); else marshalEntry(&storage,e);
+    }
+    size=storage.pos();
+    storage.close();
+    writeTime+=Profiler::now()-start;
+
+    start = Profiler::now();
+    storage.open(IO_ReadOnly);
+    for (i=0;i<(int)entries.count();i++)
+    {
+      storage.seek(offsets[i]);
+      delete (block ? unmarshalEntryBlock(&storage) : unmarshalEntry(&storage));
+    }
+    storage.close();
+    readTime+=Profiler::now()-start;
+  }
+  writeTime/=runs*1000.0;
+  readTime/=runs*1000.0;
+  delete[] offsets;
+}
+
+int main(int argc,char **argv)
+{
+  if (argc<2)
+  {
+    printf("Usage: %s [-runs <n>] source_file...\n",argv[0]);
+    exit(1);
+  }
+  int runs=5;
+  int first=1;
+  if (argc>3 && qstrcmp(argv[1],"-runs")==0)
+  {
+    runs=QMAX(1,atoi(argv[2]));
+    first=3;
+  }
+
+  initDoxygen();
+  Config_getBool(QUIET)=TRUE;
+  Config_getBool(WARNINGS)=FALSE;
+  Config_getBool(EXTRACT_ALL)=TRUE;
+  checkConfiguration();
+  adjustConfiguration();
+
+  Entry *root = new Entry;
+  int i;
+  for (i=first;i<argc;i++)
+  {
+    parseFile(root,argv[i]);
+  }
+  QList<Entry> entries;
+  collectEntries(root,entries);
+  printf("%d entries from %d files, %d runs\n\n",entries.count(),argc-first,runs);
+
+  printf("%-8s %-8s %10s %10s %10s\n","format","storage","size KB","write ms","read ms");
+  int b,m;
+  for (b=0;b<2;b++)
+  {
+    for (m=0;m<2;m++)
+    {
+      double writeTime,readTime;
+      int64 size;
+      run(entries,b==1,m==0 ? 0x7fffffff : 0,runs,writeTime,readTime,size);
+      printf("%-8s %-8s %10.0f %10.2f %10.2f\n",b==0 ? "fields" : "block",
+             m==0 ? "memory" : "file",size/1024.0,writeTime,readTime);
+    }
+  }
+
+  QFile::remove(storageName);
+  delete root;
+  return 0;
+}
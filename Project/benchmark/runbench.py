@@ -0,0 +1,219 @@
+#!/usr/bin/python
+#
+# Runs doxygen on a synthetic project with a fixed configuration per
+# output format and reports the time spent parsing the input, generating
+# the output and running dot, together with the peak memory use.
+#
+# The phase timings are taken from the profile doxygen writes when run
+# with "-d profile", so the doxygen under test must support that option.
+
+from __future__ import print_function
+import argparse, json, os, shutil, subprocess, sys, time
+import genproject
+
+try:
+	import resource
+except ImportError: # not available on Windows
+	resource = None
+
+# approximate number of symbols per scale
+SCALES = { 'small': 10000, 'medium': 100000, 'large': 1000000 }
+
+# settings appended to the base Doxyfile for each benchmark
+FORMATS = [
+	('parse',   []),
+	('html',    ['GENERATE_HTML=YES','SEARCHENGINE=YES']),
+	('latex',   ['GENERATE_LATEX=YES']),
+	('rtf',     ['GENERATE_RTF=YES']),
+	('man',     ['GENERATE_MAN=YES']),
+	('xml',     ['GENERATE_XML=YES']),
+	('dot',     ['GENERATE_HTML=YES','HAVE_DOT=YES','CLASS_GRAPH=YES',
+	             'INCLUDE_GRAPH=YES','COLLABORATION_GRAPH=NO']),
+]
+
+# parseInput() and generateOutput() are not phases themselves; the first
+# phase of generateOutput() is always the style sheet one.
+FIRST_OUTPUT_PHASE = 'Generating style sheet'
+DOT_PHASE          = 'Running dot'
+
+class Benchmark:
+	def __init__(self,args,project_dir,symbols,name,options):
+		self.args        = args
+		self.project_dir = project_dir
+		self.symbols     = symbols
+		self.name        = name
+		self.options     = options
+		self.out_dir     = os.path.join(args.outputdir,args.scale,name)
+
+	def prepare(self):
+		shutil.rmtree(self.out_dir,ignore_errors=True)
+		os.makedirs(self.out_dir)
+		doxyfile = os.path.join(self.out_dir,'Doxyfile')
+		shutil.copy(os.path.join(self.args.inputdir,'Doxyfile'),doxyfile)
+		with open(doxyfile,'a') as f:
+			print('OUTPUT_DIRECTORY=%s' % self.out_dir, file=f)
+			print('NUM_PROC_THREADS=%d' % self.args.threads, file=f)
+			for option in self.options:
+				print(option, file=f)
+		return doxyfile
+
+	def execute(self,doxyfile):
+		# doxygen is run from the project directory: INPUT is relative to it
+		# and \ioexample reads ioexamples/ and parameterids.txt from the
+		# working directory, appending the names of the documented
+		# functions to log files there, which are removed between runs
+		for log_name in ('functions-doc.txt','functions-over200.txt'):
+			path = os.path.join(self.project_dir,log_name)
+			if os.path.isfile(path):
+				os.remove(path)
+		cmd = [self.args.doxygen,'-d','profile',doxyfile]
+		with open(os.path.join(self.out_dir,'doxygen.log'),'w') as log:
+			start = time.time()
+			p = subprocess.Popen(cmd,cwd=self.project_dir,stdout=log,stderr=subprocess.STDOUT)
+			if hasattr(os,'wait4'):
+				(pid,status,usage) = os.wait4(p.pid,0)
+				returncode = status
+			else:
+				returncode = p.wait()
+				usage = None
+			wall = time.time()-start
+		if returncode!=0:
+			print('Error: failed to run %s, see %s/doxygen.log' % (' '.join(cmd),self.out_dir))
+			sys.exit(1)
+		peak_rss = None
+		if usage:
+			# ru_maxrss is in kilobytes on Linux and in bytes on Mac OS X
+			peak_rss = usage.ru_maxrss*1024 if sys.platform!='darwin' else usage.ru_maxrss
+		return (wall,peak_rss)
+
+	def phases(self):
+		with open(os.path.join(self.out_dir,'doxygen_profile.json')) as f:
+			profile = json.load(f)
+		parse = output = dot = 0.0
+		in_output = False
+		for phase in profile['phases']:
+			if phase['name']==FIRST_OUTPUT_PHASE:
+				in_output = True
+			seconds = phase['duration_ms']/1000.0
+			if phase['name']==DOT_PHASE:
+				dot += seconds
+			elif in_output:
+				output += seconds
+			else:
+				parse += seconds
+		return (parse,output,dot,profile)
+
+	def run(self):
+		doxyfile = self.prepare()
+		best = None
+		for i in range(self.args.repeat):
+			(wall,peak_rss) = self.execute(doxyfile)
+			(parse,output,dot,profile) = self.phases()
+			result = {
+				'name':      self.name,
+				'symbols':   self.symbols,
+				'wall_s':    wall,
+				'parse_s':   parse,
+				'output_s':  output,
+				'dot_s':     dot,
+				'peak_rss':  peak_rss,
+				'external':  profile['external'],
+				'counters':  profile['counters'],
+			}
+			if best is None or wall<best['wall_s']:
+				best = result
+		if not self.args.keep:
+			for entry in os.listdir(self.out_dir):
+				path = os.path.join(self.out_dir,entry)
+				if os.path.isdir(path):
+					shutil.rmtree(path,ignore_errors=True)
+		return best
+
+def rate(symbols,seconds):
+	return '%10.0f' % (symbols/seconds) if seconds>0 else '%10s' % '-'
+
+def megabytes(num_bytes):
+	return '%8.1f' % (num_bytes/1048576.0) if num_bytes else '%8s' % '-'
+
+def print_results(results,baseline):
+	print('%-8s %8s %8s %8s %8s %10s %10s %8s' %
+	      ('format','wall s','parse s','output s','dot s','parse/s','output/s','rss MB'))
+	for r in results:
+		print('%-8s %8.2f %8.2f %8.2f %8.2f %s %s %s' %
+		      (r['name'],r['wall_s'],r['parse_s'],r['output_s'],r['dot_s'],
+		       rate(r['symbols'],r['parse_s']),rate(r['symbols'],r['output_s']),
+		       megabytes(r['peak_rss'])))
+	if baseline:
+		print('')
+		print('%-8s %8s %8s %8s %8s %8s' % ('format','wall','parse','output','dot','rss'))
+		for r in results:
+			b = baseline.get(r['name'])
+			if not b:
+				continue
+			ratios = []
+			for key in ('wall_s','parse_s','output_s','dot_s','peak_rss'):
+				if r[key] and b[key]:
+					ratios.append('%7.2fx' % (float(b[key])/r[key]))
+				else:
+					ratios.append('%8s' % '-')
+			print('%-8s %s' % (r['name'],' '.join(ratios)))
+
+def main():
+	parser = argparse.ArgumentParser(description='run doxygen benchmarks')
+	parser.add_argument('--doxygen',nargs='?',default='doxygen',help='path/name of the doxygen executable')
+	parser.add_argument('--inputdir',nargs='?',default=os.path.dirname(os.path.abspath(__file__)),help='directory containing the benchmark Doxyfile')
+	parser.add_argument('--outputdir',nargs='?',default='.',help='output directory for the project and the results')
+	parser.add_argument('--scale',choices=sorted(SCALES.keys()),default='small',help='size of the generated project')
+	parser.add_argument('--format',nargs='+',dest='formats',choices=[f[0] for f in FORMATS],help='formats to benchmark (default all)')
+	parser.add_argument('--threads',type=int,default=0,help='value of NUM_PROC_THREADS for the runs')
+	parser.add_argument('--repeat',type=int,default=1,help='number of runs per format; the fastest is reported')
+	parser.add_argument('--compare',nargs='?',help='results file of an earlier run to compare with')
+	parser.add_argument('--keep',help='keep the generated output',action="store_true")
+	genproject.add_arguments(parser)
+	args = parser.parse_args()
+	args.doxygen   = os.path.abspath(args.doxygen) if os.path.exists(args.doxygen) else args.doxygen
+	args.outputdir = os.path.abspath(args.outputdir)
+	args.symbols   = args.symbols or SCALES[args.scale]
+
+	# generate the project once per scale and settings
+	project_dir = os.path.join(args.outputdir,args.scale,'project')
+	stamp = os.path.join(project_dir,'settings.json')
+	settings = dict((k,v) for (k,v) in vars(args).items()
+	                if k in ('symbols','classes_per_file','members_per_class','functions_per_file',
+	                         'class_depth','template_density','comment_lines','ioexamples','seed'))
+	symbols = None
+	if os.path.isfile(stamp):
+		with open(stamp) as f:
+			old = json.load(f)
+		if old.get('settings')==settings:
+			symbols = old['generated_symbols']
+	if symbols is None:
+		shutil.rmtree(project_dir,ignore_errors=True)
+		os.makedirs(project_dir)
+		args.outputdir, outputdir = project_dir, args.outputdir
+		symbols = genproject.generate(args)
+		args.outputdir = outputdir
+		with open(stamp,'w') as f:
+			json.dump({'settings':settings,'generated_symbols':symbols},f)
+	print('Benchmarking %s project with %d symbols' % (args.scale,symbols))
+
+	results = []
+	for (name,options) in FORMATS:
+		if args.formats and name not in args.formats:
+			continue
+		r = Benchmark(args,project_dir,symbols,name,options).run()
+		results.append(r)
+
+	baseline = None
+	if args.compare:
+		with open(args.compare) as f:
+			baseline = dict((r['name'],r) for r in json.load(f)['results'])
+	print_results(results,baseline)
+
+	result_file = os.path.join(args.outputdir,args.scale,'results.json')
+	with open(result_file,'w') as f:
+		json.dump({'scale':args.scale,'symbols':symbols,'results':results},f,indent=2)
+	print('Results written to %s' % result_file)
+
+if __name__ == '__main__':
+	main()
@@ -18,6 +18,11 @@
 #include "membername.h"
 #include "filename.h"
 #include "tooltip.h"
+#include <qthread.h>
+#include <qmutex.h>
+#include <qwaitcondition.h>
+#include <qqueue.h>
+#include <qvaluelist.h>
 
 static Definition *g_currentDefinition=0;
 static MemberDef  *g_currentMemberDef=0;
@@ -38,15 +43,135 @@ ClangParser *ClangParser::s_instance = 0;
 //--------------------------------------------------------------------------
 #if USE_LIBCLANG
 
+/** @brief A translation unit that is parsed in one go, possibly ahead
+ *  of time on a worker thread.
+ *
+ *  The input (arguments and file contents) is prepared on the main
+ *  thread, parseTranslationUnit() produces the tokens and cursors.
+ */
+struct ClangTUJob
+{
+  ClangTUJob() : argv(0), argc(0), ufs(0), sources(0), numFiles(0),
+                 tu(0), tokens(0), numTokens(0), cursors(0),
+                 done(FALSE), cancelled(FALSE) {}
+  QCString fileName;
+  char **argv;
+  int argc;
+  CXUnsavedFile *ufs;
+  QCString *sources;
+  uint numFiles;
+  QStrList inputFiles;   //!< other input files passed to prepare()
+  QStrList filesInTu;    //!< other input files, after parsing only those that are included
+  CXTranslationUnit tu;
+  CXToken *tokens;
+  uint numTokens;
+  CXCursor *cursors;
+  QStrList diagnostics;  //!< warnings produced by the compiler
+  bool done;
+  bool cancelled;
+};
+
+/** Queue of translation units shared with the parser threads */
+class ClangTUQueue
+{
+  public:
+    void enqueue(ClangTUJob *job)
+    {
+      QMutexLocker locker(&m_mutex);
+      m_queue.enqueue(job);
+      m_jobAvailable.wakeOne();
+    }
+    /** Returns the next job to parse, or 0 if the thread should stop */
+    ClangTUJob *dequeue()
+    {
+      QMutexLocker locker(&m_mutex);
+      while (m_queue.isEmpty())
+      {
+        m_jobAvailable.wait(&m_mutex);
+      }
+      return m_queue.dequeue();
+    }
+    bool isCancelled(ClangTUJob *job)
+    {
+      QMutexLocker locker(&m_mutex);
+      return job->cancelled;
+    }
+    void cancel(ClangTUJob *job)
+    {
+      QMutexLocker locker(&m_mutex);
+      job->cancelled=TRUE;
+    }
+    void finished(ClangTUJob *job)
+    {
+      QMutexLocker locker(&m_mutex);
+      job->done=TRUE;
+      m_jobDone.wakeAll();
+    }
+    void waitFor(ClangTUJob *job)
+    {
+      QMutexLocker locker(&m_mutex);
+      while (!job->done)
+      {
+        m_jobDone.wait(&m_mutex);
+      }
+    }
+  private:
+    QQueue<ClangTUJob> m_queue;
+    QMutex             m_mutex;
+    QWaitCondition     m_jobAvailable;
+    QWaitCondition     m_jobDone;
+};
+
+static void parseTranslationUnit(CXIndex index,ClangTUJob *job);
+
+/** Worker thread parsing translation units ahead of the main thread */
+class ClangTUThread : public QThread
+{
+  public:
+    ClangTUThread(ClangTUQueue *queue) : m_queue(queue), m_index(0) {}
+    void run()
+    {
+      // each thread uses its own index, translation units created 
+      // with it can outlive the thread
+      m_index = clang_createIndex(0, 0);
+      ClangTUJob *job;
+      while ((job=m_queue->dequeue()))
+      {
+        if (!m_queue->isCancelled(job))
+        {
+          parseTranslationUnit(m_index,job);
+        }
+        m_queue->finished(job);
+      }
+    }
+    CXIndex index() const { return m_index; }
+  private:
+    ClangTUQueue *m_queue;
+    CXIndex       m_index;
+};
+
 class ClangParser::Private
 {
   public:
     enum DetectedLang { Detected_Cpp, Detected_ObjC, Detected_ObjCpp };
-    Private() : tu(0), tokens(0), numTokens(0), cursors(0), 
+    Private() : index(0), tu(0), tokens(0), numTokens(0), cursors(0), 
                 ufs(0), sources(0), numFiles(0), fileMapping(257),
                 detectedLang(Detected_Cpp)
-    { fileMapping.setAutoDelete(TRUE); }
+    { fileMapping.setAutoDelete(TRUE); threads.setAutoDelete(TRUE); }
+   ~Private()
+    {
+      QValueList<CXIndex>::ConstIterator it;
+      for (it=threadIndexes.begin();it!=threadIndexes.end();++it)
+      {
+        clang_disposeIndex(*it);
+      }
+      if (index) clang_disposeIndex(index);
+    }
     int getCurrentTokenLine();
+    void prepare(ClangTUJob *job,const char *fileName,const QStrList &files);
+    void adopt(ClangTUJob *job,QStrList &filesInTranslationUnit);
+    ClangTUJob *takePrefetched(const char *fileName,const QStrList &files);
+    void dispose(ClangTUJob *job);
     CXIndex index;
     CXTranslationUnit tu;
     QCString fileName;
@@ -60,6 +185,12 @@ class ClangParser::Private
     uint numFiles;
     QDict<uint> fileMapping;
     DetectedLang detectedLang;
+
+    // translation units parsed ahead of time
+    ClangTUQueue         queue;
+    QList<ClangTUThread> threads;
+    QList<ClangTUJob>    prefetched;     // in the order in which they were queued
+    QValueList<CXIndex>  threadIndexes;  // indexes of threads that have stopped
 };
 
 static QCString detab(const QCString &s)
@@ -129,21 +260,20 @@ static void inclusionVisitor(CXFile includedFile,
   clang_disposeString(incFileName);
 }
 
-/** filter the \a files and only keep those that are found as include files
- *  within the current translation unit.
- *  @param[in,out] files The list of files to filter.
+/** filter the files of \a job and only keep those that are found as 
+ *  include files within its translation unit.
  */ 
-void ClangParser::determineInputFilesInSameTu(QStrList &files)
+static void determineInputFilesInSameTu(ClangTUJob *job)
 {
   // put the files in this translation unit in a dictionary
   QDict<void> incFound(257);
-  clang_getInclusions(p->tu,
+  clang_getInclusions(job->tu,
       inclusionVisitor,
       (CXClientData)&incFound
       );
   // create a new filtered file list
   QStrList resultIncludes;
-  QStrListIterator it2(files);
+  QStrListIterator it2(job->filesInTu);
   for (it2.toFirst();it2.current();++it2)
   {
     if (incFound.find(it2.current()))
@@ -152,20 +282,71 @@ void ClangParser::determineInputFilesInSameTu(QStrList &files)
     }
   }
   // replace the original list
-  files=resultIncludes;
+  job->filesInTu=resultIncludes;
 }
 
-void ClangParser::start(const char *fileName,QStrList &filesInTranslationUnit)
+/** Lets libclang parse the translation unit of \a job and annotate the
+ *  tokens of its main file. Can be called from any thread, only data
+ *  owned by \a job is used.
+ */
+static void parseTranslationUnit(CXIndex index,ClangTUJob *job)
+{
+  // let libclang do the actual parsing
+  job->tu = clang_parseTranslationUnit(index, 0,
+                                       job->argv, job->argc, job->ufs, job->numFiles, 
+                                       CXTranslationUnit_DetailedPreprocessingRecord);
+  // free arguments
+  for (int i=0;i<job->argc;++i)
+  {
+    free(job->argv[i]);
+  }
+  free(job->argv);
+  job->argv = 0;
+  job->argc = 0;
+
+  if (job->tu)
+  {
+    // filter out any includes not found by the clang parser
+    determineInputFilesInSameTu(job);
+
+    // collect any warnings that the compiler produced
+    for (uint i=0, n=clang_getNumDiagnostics(job->tu); i!=n; ++i) 
+    {
+      CXDiagnostic diag = clang_getDiagnostic(job->tu, i); 
+      CXString string = clang_formatDiagnostic(diag,
+          clang_defaultDiagnosticDisplayOptions()); 
+      job->diagnostics.append(clang_getCString(string));
+      clang_disposeString(string);
+      clang_disposeDiagnostic(diag);
+    }
+
+    // create a source range for the given file
+    CXFile f = clang_getFile(job->tu, job->fileName.data());
+    CXSourceLocation fileBegin = clang_getLocationForOffset(job->tu, f, 0);
+    CXSourceLocation fileEnd   = clang_getLocationForOffset(job->tu, f, job->ufs[0].Length);
+    CXSourceRange    fileRange = clang_getRange(fileBegin, fileEnd);
+
+    // produce a token stream for the file
+    clang_tokenize(job->tu,fileRange,&job->tokens,&job->numTokens);
+
+    // produce cursors for each token in the stream
+    job->cursors=new CXCursor[job->numTokens];
+    clang_annotateTokens(job->tu,job->tokens,job->numTokens,job->cursors);
+  }
+}
+
+/** Prepares the arguments and the file contents to parse \a fileName
+ *  together with \a files. Must be called on the main thread in the
+ *  order in which the files are parsed, as the language detection
+ *  depends on the files seen before.
+ */
+void ClangParser::Private::prepare(ClangTUJob *job,const char *fileName,const QStrList &files)
 {
-  static bool clangAssistedParsing = Config_getBool(CLANG_ASSISTED_PARSING);
   static QStrList &includePath = Config_getList(INCLUDE_PATH);
   static QStrList clangOptions = Config_getList(CLANG_OPTIONS);
-  if (!clangAssistedParsing) return;
-  //printf("ClangParser::start(%s)\n",fileName);
-  p->fileName = fileName;
-  p->index    = clang_createIndex(0, 0);
-  p->curLine  = 1;
-  p->curToken = 0;
+  job->fileName   = fileName;
+  job->inputFiles = files;
+  job->filesInTu  = files;
   char **argv = (char**)malloc(sizeof(char*)*(4+Doxygen::inputPaths.count()+includePath.count()+clangOptions.count()));
   QDictIterator<void> di(Doxygen::inputPaths);
   int argc=0;
@@ -196,25 +377,25 @@ void ClangParser::start(const char *fileName,QStrList &filesInTranslationUnit)
   // we use the source file to detected the language. Detection will fail if you
   // pass a bunch of .h files containing ObjC code, and no sources :-(
   SrcLangExt lang = getLanguageFromFileName(fileName);
-  if (lang==SrcLangExt_ObjC || p->detectedLang!=ClangParser::Private::Detected_Cpp)
+  if (lang==SrcLangExt_ObjC || detectedLang!=ClangParser::Private::Detected_Cpp)
   {
     QCString fn = fileName;
-    if (p->detectedLang==ClangParser::Private::Detected_Cpp && 
+    if (detectedLang==ClangParser::Private::Detected_Cpp && 
         (fn.right(4).lower()==".cpp" || fn.right(4).lower()==".cxx" ||
          fn.right(3).lower()==".cc" || fn.right(2).lower()==".c"))
     { // fall back to C/C++ once we see an extension that indicates this
-      p->detectedLang = ClangParser::Private::Detected_Cpp;
+      detectedLang = ClangParser::Private::Detected_Cpp;
     }
     else if (fn.right(3).lower()==".mm") // switch to Objective C++
     {
-      p->detectedLang = ClangParser::Private::Detected_ObjCpp;
+      detectedLang = ClangParser::Private::Detected_ObjCpp;
     }
     else if (fn.right(2).lower()==".m") // switch to Objective C
     {
-      p->detectedLang = ClangParser::Private::Detected_ObjC;
+      detectedLang = ClangParser::Private::Detected_ObjC;
     }
   }
-  switch(p->detectedLang)
+  switch(detectedLang)
   {
     case ClangParser::Private::Detected_Cpp: 
       argv[argc++]=strdup("c++"); 
@@ -230,76 +411,182 @@ void ClangParser::start(const char *fileName,QStrList &filesInTranslationUnit)
   // provide the input and and its dependencies as unsaved files so we can
   // pass the filtered versions
   argv[argc++]=strdup(fileName);
+  job->argv = argv;
+  job->argc = argc;
   static bool filterSourceFiles = Config_getBool(FILTER_SOURCE_FILES);
-  //printf("source %s ----------\n%s\n-------------\n\n",
-  //    fileName,p->source.data());
-  uint numUnsavedFiles = filesInTranslationUnit.count()+1;
-  p->numFiles = numUnsavedFiles;
-  p->sources = new QCString[numUnsavedFiles];
-  p->ufs     = new CXUnsavedFile[numUnsavedFiles];
-  p->sources[0]      = detab(fileToString(fileName,filterSourceFiles,TRUE));
-  p->ufs[0].Filename = strdup(fileName);
-  p->ufs[0].Contents = p->sources[0].data();
-  p->ufs[0].Length   = p->sources[0].length();
-  QStrListIterator it(filesInTranslationUnit);
+  uint numUnsavedFiles = files.count()+1;
+  job->numFiles = numUnsavedFiles;
+  job->sources  = new QCString[numUnsavedFiles];
+  job->ufs      = new CXUnsavedFile[numUnsavedFiles];
+  job->sources[0]      = detab(fileToString(fileName,filterSourceFiles,TRUE));
+  job->ufs[0].Filename = strdup(fileName);
+  job->ufs[0].Contents = job->sources[0].data();
+  job->ufs[0].Length   = job->sources[0].length();
+  QStrListIterator it(files);
   uint i=1;
   for (it.toFirst();it.current() && i<numUnsavedFiles;++it,i++)
   {
-    p->fileMapping.insert(it.current(),new uint(i));
-    p->sources[i]      = detab(fileToString(it.current(),filterSourceFiles,TRUE));
-    p->ufs[i].Filename = strdup(it.current());
-    p->ufs[i].Contents = p->sources[i].data();
-    p->ufs[i].Length   = p->sources[i].length();
+    job->sources[i]      = detab(fileToString(it.current(),filterSourceFiles,TRUE));
+    job->ufs[i].Filename = strdup(it.current());
+    job->ufs[i].Contents = job->sources[i].data();
+    job->ufs[i].Length   = job->sources[i].length();
   }
+}
 
-  // let libclang do the actual parsing
-  p->tu = clang_parseTranslationUnit(p->index, 0,
-                                     argv, argc, p->ufs, numUnsavedFiles, 
-                                     CXTranslationUnit_DetailedPreprocessingRecord);
-  // free arguments
-  for (int i=0;i<argc;++i)
+/** Makes the parsed translation unit of \a job the current one and 
+ *  deletes \a job.
+ */
+void ClangParser::Private::adopt(ClangTUJob *job,QStrList &filesInTranslationUnit)
+{
+  fileName  = job->fileName;
+  tu        = job->tu;
+  tokens    = job->tokens;
+  numTokens = job->numTokens;
+  cursors   = job->cursors;
+  ufs       = job->ufs;
+  sources   = job->sources;
+  numFiles  = job->numFiles;
+  curLine   = 1;
+  curToken  = 0;
+  fileMapping.clear();
+  for (uint i=1;i<numFiles;i++)
   {
-    free(argv[i]);
+    fileMapping.insert(ufs[i].Filename,new uint(i));
   }
-  free(argv);
-
-  if (p->tu)
+  if (tu)
   {
-    // filter out any includes not found by the clang parser
-    determineInputFilesInSameTu(filesInTranslationUnit);
-
+    filesInTranslationUnit = job->filesInTu;
     // show any warnings that the compiler produced
-    for (uint i=0, n=clang_getNumDiagnostics(p->tu); i!=n; ++i) 
+    QStrListIterator it(job->diagnostics);
+    for (it.toFirst();it.current();++it)
     {
-      CXDiagnostic diag = clang_getDiagnostic(p->tu, i); 
-      CXString string = clang_formatDiagnostic(diag,
-          clang_defaultDiagnosticDisplayOptions()); 
-      err("%s [clang]\n",clang_getCString(string));
-      clang_disposeString(string);
-      clang_disposeDiagnostic(diag);
+      err("%s [clang]\n",it.current());
     }
+  }
+  else
+  {
+    err("clang: Failed to parse translation unit %s\n",job->fileName.data());
+  }
+  delete job;
+}
 
-    // create a source range for the given file
-    QFileInfo fi(fileName);
-    CXFile f = clang_getFile(p->tu, fileName);
-    CXSourceLocation fileBegin = clang_getLocationForOffset(p->tu, f, 0);
-    CXSourceLocation fileEnd   = clang_getLocationForOffset(p->tu, f, p->ufs[0].Length);
-    CXSourceRange    fileRange = clang_getRange(fileBegin, fileEnd);
+/** Returns the job for \a fileName and \a files queued with prefetch(),
+ *  after waiting for it to be parsed. Jobs queued before it are no longer 
+ *  needed and are dropped. Returns 0 if \a fileName was not prefetched
+ *  with the same files.
+ */
+ClangTUJob *ClangParser::Private::takePrefetched(const char *fileName,const QStrList &files)
+{
+  QListIterator<ClangTUJob> it(prefetched);
+  ClangTUJob *job;
+  for (;(job=it.current());++it)
+  {
+    if (job->fileName==fileName) break;
+  }
+  if (job==0) return 0;
+  ClangTUJob *skipped;
+  while ((skipped=prefetched.getFirst())!=job)
+  {
+    prefetched.removeFirst();
+    dispose(skipped);
+  }
+  prefetched.removeFirst();
+  bool sameFiles = job->inputFiles.count()==files.count();
+  QStrListIterator it1(job->inputFiles),it2(files);
+  for (;sameFiles && it1.current();++it1,++it2)
+  {
+    sameFiles = qstrcmp(it1.current(),it2.current())==0;
+  }
+  if (!sameFiles)
+  {
+    dispose(job);
+    return 0;
+  }
+  queue.waitFor(job);
+  return job;
+}
 
-    // produce a token stream for the file
-    clang_tokenize(p->tu,fileRange,&p->tokens,&p->numTokens);
+/** Frees a job that was not used, waiting for it if it is being parsed */
+void ClangParser::Private::dispose(ClangTUJob *job)
+{
+  queue.cancel(job);
+  queue.waitFor(job);
+  if (job->tu)
+  {
+    delete[] job->cursors;
+    clang_disposeTokens(job->tu,job->tokens,job->numTokens);
+    clang_disposeTranslationUnit(job->tu);
+  }
+  for (int i=0;i<job->argc;++i)
+  {
+    free(job->argv[i]);
+  }
+  free(job->argv);
+  for (uint i=0;i<job->numFiles;i++)
+  {
+    free((void *)job->ufs[i].Filename);
+  }
+  delete[] job->ufs;
+  delete[] job->sources;
+  delete job;
+}
 
-    // produce cursors for each token in the stream
-    p->cursors=new CXCursor[p->numTokens];
-    clang_annotateTokens(p->tu,p->tokens,p->numTokens,p->cursors);
+void ClangParser::start(const char *fileName,QStrList &filesInTranslationUnit)
+{
+  static bool clangAssistedParsing = Config_getBool(CLANG_ASSISTED_PARSING);
+  if (!clangAssistedParsing) return;
+  //printf("ClangParser::start(%s)\n",fileName);
+  ClangTUJob *job = p->takePrefetched(fileName,filesInTranslationUnit);
+  if (job==0) // not parsed ahead, parse it now
+  {
+    if (p->index==0) p->index = clang_createIndex(0, 0);
+    job = new ClangTUJob;
+    p->prepare(job,fileName,filesInTranslationUnit);
+    parseTranslationUnit(p->index,job);
   }
-  else
+  p->adopt(job,filesInTranslationUnit);
+}
+
+void ClangParser::prefetch(const char *fileName,const QStrList &filesInTranslationUnit)
+{
+  static bool clangAssistedParsing = Config_getBool(CLANG_ASSISTED_PARSING);
+  if (!clangAssistedParsing || getNumProcThreads()<=1) return;
+  if (p->threads.isEmpty())
   {
-    p->tokens    = 0;
-    p->numTokens = 0;
-    p->cursors   = 0;
-    err("clang: Failed to parse translation unit %s\n",fileName);
+    int i;
+    for (i=0;i<getNumProcThreads();i++)
+    {
+      ClangTUThread *thread = new ClangTUThread(&p->queue);
+      thread->start();
+      p->threads.append(thread);
+    }
   }
+  ClangTUJob *job = new ClangTUJob;
+  p->prepare(job,fileName,filesInTranslationUnit);
+  p->prefetched.append(job);
+  p->queue.enqueue(job);
+}
+
+void ClangParser::finishPrefetching()
+{
+  ClangTUJob *job;
+  while ((job=p->prefetched.getFirst()))
+  {
+    p->prefetched.removeFirst();
+    p->dispose(job);
+  }
+  QListIterator<ClangTUThread> li(p->threads);
+  ClangTUThread *thread;
+  for (li.toFirst();(thread=li.current());++li)
+  {
+    p->queue.enqueue(0); // add terminator for each thread
+  }
+  for (li.toFirst();(thread=li.current());++li)
+  {
+    thread->wait();
+    p->threadIndexes.append(thread->index());
+  }
+  p->threads.clear();
 }
 
 void ClangParser::switchToFile(const char *fileName)
@@ -347,7 +634,6 @@ void ClangParser::finish()
     delete[] p->cursors;
     clang_disposeTokens(p->tu,p->tokens,p->numTokens);
     clang_disposeTranslationUnit(p->tu);
-    clang_disposeIndex(p->index);
     p->fileMapping.clear();
     p->tokens    = 0;
     p->numTokens = 0;
@@ -911,6 +1197,14 @@ void ClangParser::start(const char *,QStrList &)
 {
 }
 
+void ClangParser::prefetch(const char *,const QStrList &)
+{
+}
+
+void ClangParser::finishPrefetching()
+{
+}
+
 void ClangParser::switchToFile(const char *)
 {
 }
@@ -24,6 +24,18 @@ class ClangParser
      */
     void start(const char *fileName,QStrList &filesInTranslationUnit);
 
+    /** Parses the translation unit for \a fileName on a worker thread, so
+     *  that a later call to start() with the same arguments can use the
+     *  result. Does nothing when only a single thread may be used.
+     *  Files must be prefetched in the order in which they are started.
+     */
+    void prefetch(const char *fileName,const QStrList &filesInTranslationUnit);
+
+    /** Drops the translation units that were prefetched but not started
+     *  and stops the worker threads.
+     */
+    void finishPrefetching();
+
     /** Switches to another file within the translation unit started
      *  with start().
      *  @param[in] fileName The name of the file to switch to.
@@ -56,7 +68,6 @@ class ClangParser
     void linkInclude(CodeOutputInterface &ol,FileDef *fd,
                    uint &line,uint &column,
                    const char *text);
-    void determineInputFilesInSameTu(QStrList &filesInTranslationUnit);
     class Private;
     Private *p;
     ClangParser();
@@ -146,6 +146,18 @@ class ClassDefImpl
 
     QList<MemberList> memberLists;
 
+    /*! The member lists indexed by memberListIndex(), allocated on first use */
+    MemberList **memberListByType;
+
+    /*! Per member list type (indexed by memberListIndex()), whether a base
+     *  class contributes declarations to the inherited members sections.
+     *  Allocated on first use.
+     */
+    uchar *inheritedDecls;
+
+    /*! Cached result of hasAdditionalInheritedMembers(), -1 if not computed yet */
+    int additionalInheritedMembers;
+
     /* user defined member groups */
     MemberGroupSDict *memberGroupSDict;
 
@@ -237,6 +249,9 @@ void ClassDefImpl::init(const char *defFileName, const char *name,
   taggedInnerClasses = 0;
   tagLessRef = 0;
   spec=0;
+  memberListByType = 0;
+  inheritedDecls = 0;
+  additionalInheritedMembers = -1;
   //QCString ns;
   //extractNamespaceName(name,className,ns);
   //printf("m_name=%s m_className=%s ns=%s\n",m_name.data(),m_className.data(),ns.data());
@@ -280,6 +295,8 @@ ClassDefImpl::~ClassDefImpl()
   delete tempArgs;
   delete typeConstraints;
   delete taggedInnerClasses;
+  delete[] memberListByType;
+  delete[] inheritedDecls;
 }
 
 // constructs a new class definition
@@ -1475,7 +1492,7 @@ void ClassDef::endMemberDeclarations(OutputList &ol)
 {
   //printf("%s: ClassDef::endMemberDeclarations()\n",name().data());
   static bool inlineInheritedMembers = Config_getBool(INLINE_INHERITED_MEMB);
-  if (!inlineInheritedMembers && countAdditionalInheritedMembers()>0)
+  if (!inlineInheritedMembers && hasAdditionalInheritedMembers())
   {
     ol.startMemberHeader("inherited");
     ol.parseText(theTranslator->trAdditionalInheritedMembers());
@@ -2726,6 +2743,12 @@ bool ClassDef::isLinkableInProject() const
   }
 }
 
+/*! the memory used by this class, including its implementation data */
+uint ClassDef::objectSize() const
+{
+  return Definition::objectSize()-sizeof(Definition)+sizeof(ClassDef)+sizeof(ClassDefImpl);
+}
+
 bool ClassDef::isLinkable() const
 {
   if (m_impl->templateMaster)
@@ -2836,6 +2859,79 @@ static bool isStandardFunc(MemberDef *md)
          md->isDestructor();        // destructor
 }
 
+// relation between two members with the same name, see memberRelation()
+enum MemberRelation
+{
+  MemberRelation_NotInBase = 1, //!< members are in unrelated classes
+  MemberRelation_Match     = 2, //!< member in (base of) same class with matching arguments
+  MemberRelation_NoMatch   = 3  //!< member in (base of) same class with other arguments
+};
+
+// cache of memberRelation() results, per source member per destination member
+static QPtrDict< QPtrDict<void> > *g_memberRelations = 0;
+
+/*! Determines how \a srcMd, found in a base class, relates to \a dstMd,
+ *  a member with the same name that is already part of the class.
+ *  The same pairs are compared again for every class deriving from the
+ *  base, so while merging all classes the outcome is cached.
+ */
+static MemberRelation memberRelation(MemberDef *srcMd,MemberDef *dstMd)
+{
+  QPtrDict<void> *dstDict = 0;
+  if (g_memberRelations)
+  {
+    dstDict = g_memberRelations->find(srcMd);
+    if (dstDict)
+    {
+      void *rel = dstDict->find(dstMd);
+      if (rel) return (MemberRelation)(long)rel;
+    }
+  }
+  MemberRelation result = MemberRelation_NotInBase;
+  ClassDef *srcCd = srcMd->getClassDef();
+  ClassDef *dstCd = dstMd->getClassDef();
+  //printf("  Is %s a base class of %s?\n",srcCd->name().data(),dstCd->name().data());
+  if (srcCd==dstCd || dstCd->isBaseClass(srcCd,TRUE))
+    // member is in the same or a base class
+  {
+    ArgumentList *srcAl = srcMd->argumentList();
+    ArgumentList *dstAl = dstMd->argumentList();
+    bool found=matchArguments2(
+        srcMd->getOuterScope(),srcMd->getFileDef(),srcAl,
+        dstMd->getOuterScope(),dstMd->getFileDef(),dstAl,
+        TRUE
+        );
+    //printf("  Yes, matching (%s<->%s): %d\n",
+    //    argListToString(srcMd->argumentList()).data(),
+    //    argListToString(dstMd->argumentList()).data(),
+    //    found);
+    result = found ? MemberRelation_Match : MemberRelation_NoMatch;
+  }
+  if (g_memberRelations)
+  {
+    if (dstDict==0)
+    {
+      dstDict = new QPtrDict<void>(17);
+      g_memberRelations->insert(srcMd,dstDict);
+    }
+    dstDict->insert(dstMd,(void*)(long)result);
+  }
+  return result;
+}
+
+void ClassDef::startMergingMembers()
+{
+  delete g_memberRelations;
+  g_memberRelations = new QPtrDict< QPtrDict<void> >(10007);
+  g_memberRelations->setAutoDelete(TRUE);
+}
+
+void ClassDef::endMergingMembers()
+{
+  delete g_memberRelations;
+  g_memberRelations = 0;
+}
+
 /*!
  * recusively merges the `all members' lists of a class base
  * with that of this class. Must only be called for classes without
@@ -2893,28 +2989,16 @@ void ClassDef::mergeMembers()
               bool hidden=FALSE;
               MemberNameInfoIterator dstMnii(*dstMni);
               MemberInfo *dstMi;
-              ClassDef *srcCd = srcMd->getClassDef();
               for ( ; (dstMi=dstMnii.current()) && !found; ++dstMnii )
               {
                 MemberDef *dstMd = dstMi->memberDef;
                 if (srcMd!=dstMd) // different members
                 {
-                  ClassDef *dstCd = dstMd->getClassDef();
-                  //printf("  Is %s a base class of %s?\n",srcCd->name().data(),dstCd->name().data());
-                  if (srcCd==dstCd || dstCd->isBaseClass(srcCd,TRUE))
+                  MemberRelation rel = memberRelation(srcMd,dstMd);
+                  if (rel!=MemberRelation_NotInBase)
                     // member is in the same or a base class
                   {
-                    ArgumentList *srcAl = srcMd->argumentList();
-                    ArgumentList *dstAl = dstMd->argumentList();
-                    found=matchArguments2(
-                        srcMd->getOuterScope(),srcMd->getFileDef(),srcAl,
-                        dstMd->getOuterScope(),dstMd->getFileDef(),dstAl,
-                        TRUE
-                        );
-                    //printf("  Yes, matching (%s<->%s): %d\n",
-                    //    argListToString(srcMd->argumentList()).data(),
-                    //    argListToString(dstMd->argumentList()).data(),
-                    //    found);
+                    found = rel==MemberRelation_Match;
                     hidden = hidden  || !found;
                   }
                   else // member is in a non base class => multiple inheritance
@@ -2962,7 +3046,7 @@ void ClassDef::mergeMembers()
                 }
               }
               //printf("member %s::%s hidden %d ambigue %d srcMi->ambigClass=%p\n",
-              //    srcCd->name().data(),srcMd->name().data(),hidden,ambigue,srcMi->ambigClass);
+              //    srcMd->getClassDef()->name().data(),srcMd->name().data(),hidden,ambigue,srcMi->ambigClass);
 
               // TODO: fix the case where a member is hidden by inheritance
               //       of a member with the same name but with another prototype,
@@ -4000,26 +4084,44 @@ bool ClassDef::isAccessibleMember(MemberDef *md)
   return md->getClassDef() && isBaseClass(md->getClassDef(),TRUE);
 }
 
+// number of entries in the arrays indexed by member list type; must be
+// larger than the highest MemberListType value without its flag bits.
+static const int numMemberListIndices = 80;
+
+static inline int memberListIndex(MemberListType lt)
+{
+  int index = lt & (MemberListType_privateLists-1);
+  return index<numMemberListIndices ? index : -1;
+}
+
 MemberList *ClassDef::createMemberList(MemberListType lt)
 {
   m_impl->memberLists.setAutoDelete(TRUE);
-  QListIterator<MemberList> mli(m_impl->memberLists);
-  MemberList *ml;
-  for (mli.toFirst();(ml=mli.current());++mli)
+  MemberList *ml = getMemberList(lt);
+  if (ml) return ml;
+  // not found, create a new member list
+  ml = new MemberList(lt);
+  m_impl->memberLists.append(ml);
+  int index = memberListIndex(lt);
+  if (index!=-1)
   {
-    if (ml->listType()==lt)
+    if (m_impl->memberListByType==0)
     {
-      return ml;
+      m_impl->memberListByType = new MemberList*[numMemberListIndices];
+      memset(m_impl->memberListByType,0,numMemberListIndices*sizeof(MemberList*));
     }
+    m_impl->memberListByType[index] = ml;
   }
-  // not found, create a new member list
-  ml = new MemberList(lt);
-  m_impl->memberLists.append(ml);
   return ml;
 }
 
 MemberList *ClassDef::getMemberList(MemberListType lt)
 {
+  int index = memberListIndex(lt);
+  if (index!=-1)
+  {
+    return m_impl->memberListByType ? m_impl->memberListByType[index] : 0;
+  }
   QListIterator<MemberList> mli(m_impl->memberLists);
   MemberList *ml;
   for (;(ml=mli.current());++mli)
@@ -4058,86 +4160,83 @@ void ClassDef::sortMemberLists()
   }
 }
 
-int ClassDef::countMemberDeclarations(MemberListType lt,ClassDef *inheritedFrom,
-                                      int lt2,bool invert,bool showAlways,QPtrDict<void> *visitedClasses)
+/*! Returns TRUE if this class, being a base class, adds declarations of
+ *  type \a lt or \a lt2 to the inherited members sections of a derived class.
+ */
+bool ClassDef::hasDecMembersForInheritance(MemberListType lt,int lt2)
 {
-  //printf("%s: countMemberDeclarations for %d and %d\n",name().data(),lt,lt2);
-  int count=0;
-  MemberList * ml  = getMemberList(lt);
-  MemberList * ml2 = getMemberList((MemberListType)lt2);
-  if (getLanguage()!=SrcLangExt_VHDL) // use specific declarations function
+  if (getLanguage()==SrcLangExt_VHDL) return FALSE;
+  MemberList *ml = getMemberList(lt);
+  if (ml)
   {
-    if (ml)
-    {
-      ml->countDecMembers();
-      count+=ml->numDecMembers();
-      //printf("-> ml=%d\n",ml->numDecMembers());
-    }
-    if (ml2)
-    {
-      ml2->countDecMembers();
-      count+=ml2->numDecMembers();
-      //printf("-> ml2=%d\n",ml2->numDecMembers());
-    }
-    // also include grouped members that have their own section in the class (see bug 722759)
-    if (inheritedFrom && m_impl->memberGroupSDict)
-    {
-      MemberGroupSDict::Iterator mgli(*m_impl->memberGroupSDict);
-      MemberGroup *mg;
-      for (;(mg=mgli.current());++mgli)
-      {
-        count+=mg->countGroupedInheritedMembers(lt);
-        if (lt2!=1) count+=mg->countGroupedInheritedMembers((MemberListType)lt2);
-      }
-    }
-    static bool inlineInheritedMembers = Config_getBool(INLINE_INHERITED_MEMB);
-    if (!inlineInheritedMembers) // show inherited members as separate lists
+    ml->countDecMembers();
+    if (ml->numDecMembers()>0) return TRUE;
+  }
+  MemberList *ml2 = lt2!=-1 ? getMemberList((MemberListType)lt2) : 0;
+  if (ml2)
+  {
+    ml2->countDecMembers();
+    if (ml2->numDecMembers()>0) return TRUE;
+  }
+  // also include grouped members that have their own section in the class (see bug 722759)
+  if (m_impl->memberGroupSDict)
+  {
+    MemberGroupSDict::Iterator mgli(*m_impl->memberGroupSDict);
+    MemberGroup *mg;
+    for (;(mg=mgli.current());++mgli)
     {
-      count+=countInheritedDecMembers(lt,inheritedFrom,invert,showAlways,visitedClasses);
+      if (mg->countGroupedInheritedMembers(lt)>0) return TRUE;
+      if (lt2!=-1 && mg->countGroupedInheritedMembers((MemberListType)lt2)>0) return TRUE;
     }
   }
-  //printf("-> %d\n",count);
-  return count;
+  static bool inlineInheritedMembers = Config_getBool(INLINE_INHERITED_MEMB);
+  if (!inlineInheritedMembers) // show inherited members as separate lists
+  {
+    return hasInheritedDecMembers(lt);
+  }
+  return FALSE;
 }
 
-
-int ClassDef::countInheritedDecMembers(MemberListType lt,
-                                       ClassDef *inheritedFrom,bool invert,bool showAlways,
-                                       QPtrDict<void> *visitedClasses)
-{
-  int inhCount = 0;
-  int count = countMembersIncludingGrouped(lt,inheritedFrom,FALSE);
-  bool process = count>0;
-  //printf("%s: countInheritedDecMembers: lt=%d process=%d count=%d invert=%d\n",
-  //    name().data(),lt,process,count,invert);
-  if ((process^invert) || showAlways)
+/*! Returns TRUE if any of the (indirect) base classes adds declarations
+ *  to the inherited members section of type \a lt. The result is cached
+ *  per class and list type, so a base class shared by many derived classes
+ *  is only inspected once.
+ */
+bool ClassDef::hasInheritedDecMembers(MemberListType lt)
+{
+  enum { Unknown=0, Busy, None, Some };
+  if (m_impl->inherits==0) return FALSE;
+  int index = memberListIndex(lt);
+  if (index==-1) return FALSE;
+  if (m_impl->inheritedDecls==0)
+  {
+    m_impl->inheritedDecls = new uchar[numMemberListIndices];
+    memset(m_impl->inheritedDecls,Unknown,numMemberListIndices);
+  }
+  uchar &state = m_impl->inheritedDecls[index];
+  if (state==Busy) return FALSE; // guard for cycles in the class hierarchy
+  if (state!=Unknown) return state==Some;
+  state = Busy;
+  bool found = FALSE;
+  BaseClassListIterator it(*m_impl->inherits);
+  BaseClassDef *ibcd;
+  for (it.toFirst();(ibcd=it.current()) && !found;++it)
   {
-    if (m_impl->inherits)
+    ClassDef *icd=ibcd->classDef;
+    int lt1,lt2;
+    if (icd->isLinkable())
     {
-      BaseClassListIterator it(*m_impl->inherits);
-      BaseClassDef *ibcd;
-      for (it.toFirst();(ibcd=it.current());++it)
+      convertProtectionLevel(lt,ibcd->prot,&lt1,&lt2);
+      //printf("%s: convert %d->(%d,%d) prot=%d\n",
+      //    icd->name().data(),lt,lt1,lt2,ibcd->prot);
+      if (lt1!=-1)
       {
-        ClassDef *icd=ibcd->classDef;
-        int lt1,lt2;
-        if (icd->isLinkable())
-        {
-          convertProtectionLevel(lt,ibcd->prot,&lt1,&lt2);
-          //printf("%s: convert %d->(%d,%d) prot=%d\n",
-          //    icd->name().data(),lt,lt1,lt2,ibcd->prot);
-          if (visitedClasses->find(icd)==0)
-          {
-            visitedClasses->insert(icd,icd); // guard for multiple virtual inheritance
-            if (lt1!=-1)
-            {
-              inhCount+=icd->countMemberDeclarations((MemberListType)lt1,inheritedFrom,lt2,FALSE,TRUE,visitedClasses);
-            }
-          }
-        }
+        found = icd->hasDecMembersForInheritance((MemberListType)lt1,lt2);
       }
     }
   }
-  return inhCount;
+  state = found ? Some : None;
+  return found;
 }
 
 void ClassDef::getTitleForMemberListType(MemberListType type,
@@ -4164,30 +4263,32 @@ void ClassDef::getTitleForMemberListType(MemberListType type,
   subtitle="";
 }
 
-int ClassDef::countAdditionalInheritedMembers()
+bool ClassDef::hasAdditionalInheritedMembers()
 {
-  int totalCount=0;
-  QListIterator<LayoutDocEntry> eli(
-      LayoutDocManager::instance().docEntries(LayoutDocManager::Class));
-  LayoutDocEntry *lde;
-  for (eli.toFirst();(lde=eli.current());++eli)
+  if (m_impl->additionalInheritedMembers==-1)
   {
-    if (lde->kind()==LayoutDocEntry::MemberDecl)
+    bool found=FALSE;
+    QListIterator<LayoutDocEntry> eli(
+        LayoutDocManager::instance().docEntries(LayoutDocManager::Class));
+    LayoutDocEntry *lde;
+    for (eli.toFirst();(lde=eli.current()) && !found;++eli)
     {
-      LayoutDocEntryMemberDecl *lmd = (LayoutDocEntryMemberDecl*)lde;
-      if (lmd->type!=MemberListType_friends) // friendship is not inherited
+      if (lde->kind()==LayoutDocEntry::MemberDecl)
       {
-        //MemberList *ml = getMemberList(lmd->type);
-        //if (ml==0 || ml->numDecMembers()==0)
-        //{
-          QPtrDict<void> visited(17);
-          totalCount+=countInheritedDecMembers(lmd->type,this,TRUE,FALSE,&visited);
-        //}
+        LayoutDocEntryMemberDecl *lmd = (LayoutDocEntryMemberDecl*)lde;
+        if (lmd->type!=MemberListType_friends) // friendship is not inherited
+        {
+          // inherited members only get an additional section if the class
+          // has no section of that type itself
+          found = countMembersIncludingGrouped(lmd->type,this,FALSE)==0 &&
+                  hasInheritedDecMembers(lmd->type);
+        }
       }
     }
+    m_impl->additionalInheritedMembers = found;
+    //printf("%s: hasAdditionalInheritedMembers()=%d\n",name().data(),found);
   }
-  //printf("countAdditonalInheritedMembers()=%d\n",totalCount);
-  return totalCount;
+  return m_impl->additionalInheritedMembers;
 }
 
 void ClassDef::writeAdditionalInheritedMembers(OutputList &ol)
@@ -4246,11 +4347,12 @@ void ClassDef::writeInheritedMemberDeclarations(OutputList &ol,
 {
   ol.pushGeneratorState();
   ol.disableAllBut(OutputGenerator::Html);
-  int count = countMembersIncludingGrouped(lt,inheritedFrom,FALSE);
-  bool process = count>0;
+  // the members of this class only matter if we are not showing all anyway
+  bool process = showAlways ||
+                 ((countMembersIncludingGrouped(lt,inheritedFrom,FALSE)>0)^invert);
   //printf("%s: writeInheritedMemberDec: lt=%d process=%d invert=%d always=%d\n",
   //    name().data(),lt,process,invert,showAlways);
-  if ((process^invert) || showAlways)
+  if (process)
   {
     if (m_impl->inherits)
     {
@@ -105,6 +105,8 @@ class ClassDef : public Definition
     /** Used for RTTI, this is a class */
     DefType definitionType() const { return TypeClass; }
 
+    uint objectSize() const;
+
     /** Returns the unique base name (without extension) of the class's file on disk */
     QCString getOutputFileBase() const;
     QCString getInstanceOutputFileBase() const; 
@@ -378,6 +380,11 @@ class ClassDef : public Definition
     void addTypeConstraints();
     void computeAnchors();
     void mergeMembers();
+    /** Enables caching of the member comparisons done by mergeMembers()
+     *  until endMergingMembers() is called.
+     */
+    static void startMergingMembers();
+    static void endMergingMembers();
     void sortMemberLists();
     void distributeMemberGroupDocumentation();
     void writeDocumentation(OutputList &ol);
@@ -398,6 +405,11 @@ class ClassDef : public Definition
     int countMembersIncludingGrouped(MemberListType lt,ClassDef *inheritedFrom,bool additional);
     int countInheritanceNodes();
     void writeTagFile(FTextStream &);
+
+    /** Returns TRUE if the class page needs an "Additional Inherited
+     *  Members" section. The result is computed once and then cached.
+     */
+    bool hasAdditionalInheritedMembers();
     
     bool visited;
 
@@ -435,14 +447,10 @@ class ClassDef : public Definition
     void writeMoreLink(OutputList &ol,const QCString &anchor);
     void writeDetailedDocumentationBody(OutputList &ol);
     
-    int countAdditionalInheritedMembers();
     void writeAdditionalInheritedMembers(OutputList &ol);
     void addClassAttributes(OutputList &ol);
-    int countMemberDeclarations(MemberListType lt,ClassDef *inheritedFrom,
-                                int lt2,bool invert,bool showAlways,QPtrDict<void> *visitedClasses);
-    int countInheritedDecMembers(MemberListType lt,
-                                 ClassDef *inheritedFrom,bool invert,bool showAlways,
-                                 QPtrDict<void> *visitedClasses);
+    bool hasDecMembersForInheritance(MemberListType lt,int lt2);
+    bool hasInheritedDecMembers(MemberListType lt);
     void getTitleForMemberListType(MemberListType type,
                QCString &title,QCString &subtitle);
     QCString includeStatement() const;
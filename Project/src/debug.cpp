@@ -48,6 +48,7 @@ static LabelMap s_labels[] =
   { "markdown",     Debug::Markdown     },
   { "filteroutput", Debug::FilterOutput },
   { "lex",          Debug::Lex },
+  { "profile",      Debug::Profile },
   { 0,             (Debug::DebugMask)0  }
 };
 
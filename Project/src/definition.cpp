@@ -18,6 +18,7 @@
 #include <ctype.h>
 #include <qregexp.h>
 #include "md5.h"
+#include "filtercache.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
@@ -41,6 +42,7 @@
 #include "namespacedef.h"
 #include "filedef.h"
 #include "dirdef.h"
+#include "stringpool.h"
 
 #define START_MARKER 0x4445465B // DEF[
 #define END_MARKER   0x4445465D // DEF]
@@ -75,8 +77,8 @@ class DefinitionImpl
     QCString qualifiedName;
     QCString ref;   // reference to external documentation
 
-    bool hidden;
-    bool isArtificial;
+    bool hidden : 1;
+    bool isArtificial : 1;
 
     Definition *outerScope;  // not owner
 
@@ -112,7 +114,7 @@ DefinitionImpl::~DefinitionImpl()
 
 void DefinitionImpl::init(const char *df, const char *n)
 {
-  defFileName = df;
+  defFileName = StringPool::intern(df);
   int lastDot = defFileName.findRev('.');
   if (lastDot!=-1)
   {
@@ -598,12 +600,12 @@ void Definition::_setDocumentation(const char *d,const char *docFile,int docLine
     }
     if (docLine!=-1) // store location if valid
     {
-      m_impl->details->file = docFile;
+      m_impl->details->file = StringPool::intern(docFile);
       m_impl->details->line = docLine;
     }
     else
     {
-      m_impl->details->file = docFile;
+      m_impl->details->file = StringPool::intern(docFile);
       m_impl->details->line = 1;
     }
   }
@@ -668,12 +670,12 @@ void Definition::_setBriefDescription(const char *b,const char *briefFile,int br
       m_impl->brief->doc=brief;
       if (briefLine!=-1)
       {
-        m_impl->brief->file = briefFile;
+        m_impl->brief->file = StringPool::intern(briefFile);
         m_impl->brief->line = briefLine;
       }
       else
       {
-        m_impl->brief->file = briefFile;
+        m_impl->brief->file = StringPool::intern(briefFile);
         m_impl->brief->line = 1;
       }
     }
@@ -699,7 +701,7 @@ void Definition::_setInbodyDocumentation(const char *doc,const char *inbodyFile,
   if (m_impl->inbodyDocs->doc.isEmpty()) // fresh inbody docs
   {
     m_impl->inbodyDocs->doc  = doc;
-    m_impl->inbodyDocs->file = inbodyFile;
+    m_impl->inbodyDocs->file = StringPool::intern(inbodyFile);
     m_impl->inbodyDocs->line = inbodyLine;
   }
   else // another inbody documentation fragment, append this to the end
@@ -742,9 +744,7 @@ bool readCodeFragment(const char *fileName,
   }
   else // use filter
   {
-    QCString cmd=filter+" \""+fileName+"\"";
-    Debug::print(Debug::ExtCmd,0,"Executing popen(`%s`)\n",qPrint(cmd));
-    f = portable_popen(cmd,"r");
+    f = FilterCache::openFilteredFile(fileName,filter);
   }
   bool found = lang==SrcLangExt_VHDL   || 
                lang==SrcLangExt_Tcl    || 
@@ -866,16 +866,12 @@ bool readCodeFragment(const char *fileName,
         endLine=lineNr-1;
       }
     }
+    fclose(f);
     if (usePipe) 
     {
-      portable_pclose(f); 
       Debug::print(Debug::FilterOutput, 0, "Filter output\n");
       Debug::print(Debug::FilterOutput,0,"-------------\n%s\n-------------\n",qPrint(result));
     }
-    else 
-    {
-      fclose(f);
-    }
   }
   result = transcodeCharacterStringToUTF8(result);
   //fprintf(stderr,"readCodeFragement(%d-%d)=%s\n",startLine,endLine,result.data());
@@ -1868,6 +1864,16 @@ bool Definition::isReference() const
   return !m_impl->ref.isEmpty(); 
 }
 
+uint Definition::objectSize() const
+{
+  uint size = sizeof(Definition)+sizeof(DefinitionImpl);
+  if (m_impl->details)    size+=sizeof(DocInfo);
+  if (m_impl->inbodyDocs) size+=sizeof(DocInfo);
+  if (m_impl->brief)      size+=sizeof(BriefInfo);
+  if (m_impl->body)       size+=sizeof(BodyInfo);
+  return size;
+}
+
 int Definition::getStartBodyLine() const         
 { 
   return m_impl->body ? m_impl->body->startLine : -1; 
@@ -1905,7 +1911,7 @@ MemberSDict *Definition::getReferencedByMembers() const
 
 void Definition::setReference(const char *r) 
 { 
-  m_impl->ref=r; 
+  m_impl->ref=StringPool::intern(r); 
 }
 
 SrcLangExt Definition::getLanguage() const
@@ -274,6 +274,11 @@ class Definition : public DefinitionIntf
 
     QCString id() const;
 
+    /** Returns the approximate number of bytes used by this object and
+     *  its private data, not counting the text of its strings.
+     */
+    virtual uint objectSize() const;
+
     //-----------------------------------------------------------------------------------
     // ----  setters -----
     //-----------------------------------------------------------------------------------
@@ -54,6 +54,7 @@
 #include "growbuf.h"
 #include "markdown.h"
 #include "htmlentity.h"
+#include "profiler.h"
 
 // debug off
 #define DBG(x) do {} while(0)
@@ -7212,6 +7213,7 @@ DocRoot *validatingParseDoc(const char *fileName,int startLine,
   //printf("========== validating %s at line %d\n",fileName,startLine);
   //printf("---------------- input --------------------\n%s\n----------- end input -------------------\n",input);
   //g_token = new TokenInfo;
+  Profiler::count(Profiler::DocsParsed);
 
   // store parser state so we can re-enter this function if needed
   //bool fortranOpt = Config_getBool(OPTIMIZE_FOR_FORTRAN);
@@ -47,6 +47,7 @@
 #include "namespacedef.h"
 #include "memberdef.h"
 #include "membergroup.h"
+#include "profiler.h"
 
 #define MAP_CMD "cmapx"
 
@@ -1261,6 +1262,7 @@ DotManager::~DotManager()
 
 void DotManager::addRun(DotRunner *run)
 {
+  Profiler::count(Profiler::DotJobs);
   m_dotRuns.append(run);
 }
 
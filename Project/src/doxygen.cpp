@@ -98,6 +98,11 @@
 #include "settings.h"
 #include "context.h"
 #include "fileparser.h"
+#include "profiler.h"
+#include "stringpool.h"
+#include "filtercache.h"
+#include "clangparser.h"
+#include "image.h"
 
 // provided by the generated file resources.cpp
 extern void initResources();
@@ -180,6 +185,7 @@ static QDict<FileDef>   g_usingDeclarations(1009); // used classes
 static FileStorage     *g_storage = 0;
 static bool             g_successfulRun = FALSE;
 static bool             g_dumpSymbolMap = FALSE;
+static bool             g_memoryReport = FALSE;
 static bool             g_useOutputTemplate = FALSE;
 
 void clearAll()
@@ -219,10 +225,12 @@ class Statistics
       stat *entry= new stat(name,0);
       stats.append(entry);
       time.restart();
+      Profiler::beginPhase(name);
     }
     void end()
     {
       stats.getLast()->elapsed=((double)time.elapsed())/1000.0;
+      Profiler::endPhase();
     }
     void print()
     {
@@ -7790,21 +7798,69 @@ static void mergeCategories()
 
 // builds the list of all members for each class
 
+/** Returns the depth of \a cd in the inheritance graph: 0 for a class without
+ *  base classes, otherwise one more than the deepest of its base classes.
+ *  Results are stored in \a levels (offset by one) and every class visited
+ *  is appended to the list of its level in \a classesPerLevel.
+ */
+static int inheritanceLevel(ClassDef *cd,QPtrDict<void> &levels,
+                            QIntDict<ClassList> &classesPerLevel,int depth=0)
+{
+  void *l = levels.find(cd);
+  if (l) return (int)(long)l-1;
+  int level=0;
+  if (depth<256 && cd->baseClasses()) // guard against recursive class relations
+  {
+    BaseClassListIterator bcli(*cd->baseClasses());
+    BaseClassDef *bcd;
+    for (;(bcd=bcli.current());++bcli)
+    {
+      level = QMAX(level,inheritanceLevel(bcd->classDef,levels,classesPerLevel,depth+1)+1);
+    }
+  }
+  if (levels.find(cd)==0) // not added while looking at the base classes
+  {
+    levels.insert(cd,(void*)(long)(level+1));
+    ClassList *cl = classesPerLevel.find(level);
+    if (cl==0)
+    {
+      cl = new ClassList;
+      classesPerLevel.insert(level,cl);
+    }
+    cl->append(cd);
+  }
+  return level;
+}
+
 static void buildCompleteMemberLists()
 {
   ClassDef *cd;
   ClassSDict::Iterator cli(*Doxygen::classSDict);
-  // merge the member list of base classes into the inherited classes.
+  // order the classes by their depth in the inheritance graph, so that
+  // the members of all base classes are merged before those of the class.
+  QPtrDict<void> levels(10007);
+  QIntDict<ClassList> classesPerLevel(257);
+  classesPerLevel.setAutoDelete(TRUE);
+  int maxLevel=0;
   for (cli.toFirst();(cd=cli.current());++cli)
   {
-    if (// !cd->isReference() && // not an external class
-         cd->subClasses()==0 && // is a root of the hierarchy
-         cd->baseClasses()) // and has at least one base class
+    maxLevel = QMAX(maxLevel,inheritanceLevel(cd,levels,classesPerLevel));
+  }
+  // merge the member list of base classes into the inherited classes.
+  ClassDef::startMergingMembers();
+  int level;
+  for (level=1;level<=maxLevel;level++)
+  {
+    ClassList *cl = classesPerLevel.find(level);
+    if (cl==0) continue;
+    ClassListIterator cli2(*cl);
+    for (;(cd=cli2.current());++cli2)
     {
       //printf("*** merging members for %s\n",cd->name().data());
       cd->mergeMembers();
     }
   }
+  ClassDef::endMergingMembers();
   // now sort the member list of all classes.
   for (cli.toFirst();(cd=cli.current());++cli)
   {
@@ -7837,6 +7893,31 @@ static void generateFileSources()
           g_filesToProcess.insert(fd->absFilePath(),(void*)0x8);
         }
       }
+      // let libclang parse the next translation units while the sources
+      // of the current one are written
+      QList<FileDef> tuFiles;
+      for (fnli.toFirst();(fn=fnli.current());++fnli)
+      {
+        FileNameIterator fni(*fn);
+        FileDef *fd;
+        for (;(fd=fni.current());++fni)
+        {
+          if (fd->isSource() && !fd->isReference() &&
+              ((fd->generateSourceFile() && !g_useOutputTemplate) || Doxygen::parseSourcesNeeded) &&
+              (fd->getLanguage()==SrcLangExt_Cpp || fd->getLanguage()==SrcLangExt_ObjC))
+          {
+            tuFiles.append(fd);
+          }
+        }
+      }
+      QListIterator<FileDef> pfi(tuFiles);
+      int i;
+      for (i=0;i<getNumProcThreads() && pfi.current();i++,++pfi)
+      {
+        QStrList filesInSameTu;
+        pfi.current()->getAllIncludeFilesRecursively(filesInSameTu);
+        ClangParser::instance()->prefetch(pfi.current()->absFilePath(),filesInSameTu);
+      }
       // process source files (and their include dependencies)
       for (fnli.toFirst();(fn=fnli.current());++fnli)
       {
@@ -7846,6 +7927,13 @@ static void generateFileSources()
         {
           if (fd->isSource() && !fd->isReference())
           {
+            if (pfi.current())
+            {
+              QStrList filesInSameTu;
+              pfi.current()->getAllIncludeFilesRecursively(filesInSameTu);
+              ClangParser::instance()->prefetch(pfi.current()->absFilePath(),filesInSameTu);
+              ++pfi;
+            }
             QStrList filesInSameTu;
             fd->getAllIncludeFilesRecursively(filesInSameTu);
             fd->startParsing();
@@ -7894,6 +7982,7 @@ static void generateFileSources()
           }
         }
       }
+      ClangParser::instance()->finishPrefetching();
       // process remaining files
       for (fnli.toFirst();(fn=fnli.current());++fnli)
       {
@@ -8063,6 +8152,26 @@ static void addSourceReferences()
 
 //----------------------------------------------------------------------------
 
+/** Determines for all classes whether they need an "Additional Inherited
+ *  Members" section. Each class caches the outcome per member list type,
+ *  so shared base classes are visited once instead of once per page.
+ */
+static void computeInheritedMemberCounts()
+{
+  if (Config_getBool(INLINE_INHERITED_MEMB)) return;
+  ClassSDict::Iterator cli(*Doxygen::classSDict);
+  ClassDef *cd=0;
+  for (cli.toFirst();(cd=cli.current());++cli)
+  {
+    if (cd->isLinkableInProject() && cd->templateMaster()==0)
+    {
+      cd->hasAdditionalInheritedMembers();
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+
 static void sortMemberLists()
 {
   // sort class member lists
@@ -9340,6 +9449,7 @@ static void parseFile(ParserInterface *parser,
     extension = ".no_extension";
   }
 
+  ProfileScope profileScope(fileName,"parse");
   QFileInfo fi(fileName);
   BufStr preBuf(fi.size()+4096);
 
@@ -9348,7 +9458,7 @@ static void parseFile(ParserInterface *parser,
   {
     BufStr inBuf(fi.size()+4096);
     msg("Preprocessing %s...\n",fn);
-    readInputFile(fileName,inBuf);
+    preReadInputFile(fileName,inBuf);
     preprocessFile(fileName,inBuf,preBuf);
   }
   else // no preprocessing
@@ -9456,10 +9566,23 @@ static void parseFiles(Entry *root,EntryNav *rootNav)
   else // normal pocessing
 #endif
   {
+    // run the input filters of the next files while the current one is parsed
+    int prefetchDepth = getNumProcThreads()>1 ? 2*getNumProcThreads() : 0;
+    StringListIterator pfi(g_inputFiles);
+    int i;
+    for (i=0;i<prefetchDepth && pfi.current();i++,++pfi)
+    {
+      FilterCache::prefetch(*pfi.current(),getFileFilter(*pfi.current(),FALSE));
+    }
     StringListIterator it(g_inputFiles);
     QCString *s;
     for (;(s=it.current());++it)
     {
+      if (pfi.current())
+      {
+        FilterCache::prefetch(*pfi.current(),getFileFilter(*pfi.current(),FALSE));
+        ++pfi;
+      }
       bool ambig;
       QStrList filesInSameTu;
       FileDef *fd=findFileDef(Doxygen::inputNameDict,s->data(),ambig);
@@ -9547,19 +9670,19 @@ static QDict<void> g_pathsVisited(1009);
 // The directory is read iff the recusiveFlag is set.
 // The contents of all files is append to the input string
 
-int readDir(QFileInfo *fi,
-            FileNameList *fnList,
-            FileNameDict *fnDict,
-            StringDict  *exclDict,
-            QStrList *patList,
-            QStrList *exclPatList,
-            StringList *resultList,
-            StringDict *resultDict,
-            bool errorIfNotExist,
-            bool recursive,
-            QDict<void> *killDict,
-            QDict<void> *paths
-           )
+static int readDir(QFileInfo *fi,
+                   FileNameList *fnList,
+                   FileNameDict *fnDict,
+                   StringDict  *exclDict,
+                   const FilePatternSet *patSet,
+                   const FilePatternSet *exclPatSet,
+                   StringList *resultList,
+                   StringDict *resultDict,
+                   bool errorIfNotExist,
+                   bool recursive,
+                   QDict<void> *killDict,
+                   QDict<void> *paths
+                  )
 {
   QCString dirName = fi->absFilePath().utf8();
   if (paths && paths->find(dirName)==0)
@@ -9585,9 +9708,11 @@ int readDir(QFileInfo *fi,
     QFileInfoListIterator it( *list );
     QFileInfo *cfi;
 
+    bool excludeSymlinks = Config_getBool(EXCLUDE_SYMLINKS);
     while ((cfi=it.current()))
     {
-      if (exclDict==0 || exclDict->find(cfi->absFilePath().utf8())==0)
+      QCString absFilePath = cfi->absFilePath().utf8();
+      if (exclDict==0 || exclDict->find(absFilePath)==0)
       { // file should not be excluded
         //printf("killDict->find(%s)\n",cfi->absFilePath().data());
         if (!cfi->exists() || !cfi->isReadable())
@@ -9598,13 +9723,13 @@ int readDir(QFileInfo *fi,
           }
         }
         else if (cfi->isFile() &&
-            (!Config_getBool(EXCLUDE_SYMLINKS) || !cfi->isSymLink()) &&
-            (patList==0 || patternMatch(*cfi,patList)) &&
-            !patternMatch(*cfi,exclPatList) &&
-            (killDict==0 || killDict->find(cfi->absFilePath().utf8())==0)
+            (!excludeSymlinks || !cfi->isSymLink()) &&
+            (patSet==0 || patSet->match(*cfi)) &&
+            !exclPatSet->match(*cfi) &&
+            (killDict==0 || killDict->find(absFilePath)==0)
             )
         {
-          totalSize+=cfi->size()+cfi->absFilePath().length()+4;
+          totalSize+=cfi->size()+absFilePath.length()+4;
           QCString name=cfi->fileName().utf8();
           //printf("New file %s\n",name.data());
           if (fnDict)
@@ -9617,7 +9742,7 @@ int readDir(QFileInfo *fi,
             }
             else
             {
-              fn = new FileName(cfi->absFilePath().utf8(),name);
+              fn = new FileName(absFilePath,name);
               fn->append(fd);
               if (fnList) fnList->inSort(fn);
               fnDict->insert(name,fn);
@@ -9626,21 +9751,21 @@ int readDir(QFileInfo *fi,
           QCString *rs=0;
           if (resultList || resultDict)
           {
-            rs=new QCString(cfi->absFilePath().utf8());
+            rs=new QCString(absFilePath);
           }
           if (resultList) resultList->append(rs);
-          if (resultDict) resultDict->insert(cfi->absFilePath().utf8(),rs);
-          if (killDict) killDict->insert(cfi->absFilePath().utf8(),(void *)0x8);
+          if (resultDict) resultDict->insert(absFilePath,rs);
+          if (killDict) killDict->insert(absFilePath,(void *)0x8);
         }
         else if (recursive &&
-            (!Config_getBool(EXCLUDE_SYMLINKS) || !cfi->isSymLink()) &&
+            (!excludeSymlinks || !cfi->isSymLink()) &&
             cfi->isDir() &&
-            !patternMatch(*cfi,exclPatList) &&
-            cfi->fileName().at(0)!='.') // skip "." ".." and ".dir"
+            cfi->fileName().at(0)!='.' && // skip "." ".." and ".dir"
+            !exclPatSet->match(*cfi))     // prune excluded subtrees
         {
           cfi->setFile(cfi->absFilePath());
           totalSize+=readDir(cfi,fnList,fnDict,exclDict,
-              patList,exclPatList,resultList,resultDict,errorIfNotExist,
+              patSet,exclPatSet,resultList,resultDict,errorIfNotExist,
               recursive,killDict,paths);
         }
       }
@@ -9735,8 +9860,11 @@ int readFileOrDirectory(const char *s,
         }
         else if (fi.isDir()) // readable dir
         {
-          totalSize+=readDir(&fi,fnList,fnDict,exclDict,patList,
-              exclPatList,resultList,resultDict,errorIfNotExist,
+          // compile the patterns once for all files in the directory tree
+          FilePatternSet patSet(patList);
+          FilePatternSet exclPatSet(exclPatList);
+          totalSize+=readDir(&fi,fnList,fnDict,exclDict,patList ? &patSet : 0,
+              &exclPatSet,resultList,resultDict,errorIfNotExist,
               recursive,killDict,paths);
         }
       }
@@ -9917,11 +10045,106 @@ static void dumpSymbolMap()
   }
 }
 
+/** Memory use of the definitions of one type */
+struct MemoryUsage
+{
+  MemoryUsage() : count(0), objectBytes(0), stringBytes(0) {}
+  uint  count;
+  ulong objectBytes;
+  ulong stringBytes;
+};
+
+static void addStringSize(MemoryUsage &mu,QPtrDict<void> &seen,const char *s)
+{
+  uint len = qstrlen(s);
+  // short strings are stored inside the QCString object itself
+  if (len<=sizeof(QCString)-3) return;
+  void *data = (void*)s;
+  if (seen.find(data)==0) // text not counted before
+  {
+    seen.insert(data,data);
+    mu.stringBytes+=len+1;
+  }
+}
+
+static void addDefinitionSize(MemoryUsage *usage,QPtrDict<void> &seen,Definition *d)
+{
+  MemoryUsage &mu = usage[d->definitionType()];
+  mu.count++;
+  mu.objectBytes+=d->objectSize();
+  // only accessors returning (a shared copy of) the stored text are used,
+  // so the data pointers identify the text
+  addStringSize(mu,seen,d->name());
+  addStringSize(mu,seen,d->documentation());
+  addStringSize(mu,seen,d->briefDescription());
+  addStringSize(mu,seen,d->getDefFileName());
+  if (d->definitionType()==Definition::TypeMember)
+  {
+    MemberDef *md = (MemberDef *)d;
+    addStringSize(mu,seen,md->typeString());
+    addStringSize(mu,seen,md->argsString());
+    addStringSize(mu,seen,md->declaration());
+    addStringSize(mu,seen,md->definition());
+    addStringSize(mu,seen,md->initializer());
+    addStringSize(mu,seen,md->excpString());
+    addStringSize(mu,seen,md->bitfieldString());
+  }
+}
+
+/** Prints an estimate of the memory used by the symbols found in the input.
+ *  Strings sharing the same text are counted once.
+ */
+static void writeMemoryReport()
+{
+  static const char *typeNames[] =
+  { "class", "file", "namespace", "member", "group", "package", "page", "dir" };
+  const int numTypes = sizeof(typeNames)/sizeof(typeNames[0]);
+  MemoryUsage usage[numTypes];
+  QPtrDict<void> seen(100003);
+  QDictIterator<DefinitionIntf> di(*Doxygen::symbolMap);
+  DefinitionIntf *intf;
+  for (;(intf=di.current());++di)
+  {
+    if (intf->definitionType()==DefinitionIntf::TypeSymbolList) // list of symbols
+    {
+      DefinitionListIterator dli(*(DefinitionList*)intf);
+      Definition *d;
+      for (dli.toFirst();(d=dli.current());++dli)
+      {
+        addDefinitionSize(usage,seen,d);
+      }
+    }
+    else // single symbol
+    {
+      Definition *d = (Definition *)intf;
+      if (d!=Doxygen::globalScope) addDefinitionSize(usage,seen,d);
+    }
+  }
+  MemoryUsage total;
+  msg("Memory report (approximate):\n");
+  msg("  %-10s %10s %14s %14s\n","type","count","object bytes","string bytes");
+  int i;
+  for (i=0;i<numTypes;i++)
+  {
+    if (usage[i].count==0) continue;
+    msg("  %-10s %10u %14lu %14lu\n",typeNames[i],
+        usage[i].count,usage[i].objectBytes,usage[i].stringBytes);
+    total.count+=usage[i].count;
+    total.objectBytes+=usage[i].objectBytes;
+    total.stringBytes+=usage[i].stringBytes;
+  }
+  msg("  %-10s %10u %14lu %14lu\n","total",
+      total.count,total.objectBytes,total.stringBytes);
+  msg("  string pool: %u strings, %lu bytes, %lu reuses\n",
+      StringPool::count(),StringPool::size(),StringPool::hits());
+}
+
 // print developer options of doxygen
 static void devUsage()
 {
   msg("Developer parameters:\n");
   msg("  -m          dump symbol map\n");
+  msg("  --memory-report  print the memory used by the symbols after parsing\n");
   msg("  -b          output to wizard\n");
   msg("  -T          activates output generation via Django like template\n");
   msg("  -d <level>  enable a debug level, such as (multiple invocations of -d are possible):\n");
@@ -10122,6 +10345,8 @@ void cleanUpDoxygen()
   delete Doxygen::hiddenClasses;
   delete Doxygen::namespaceSDict;
   delete Doxygen::directories;
+  StringPool::clear();
+  FilterCache::cleanup();
 
   //delete Doxygen::symbolMap; <- we cannot do this unless all static lists
   //                              (such as Doxygen::namespaceSDict)
@@ -10378,6 +10603,10 @@ void readConfiguration(int argc, char **argv)
           cleanUpDoxygen();
           exit(0);
         }
+        else if (qstrcmp(&argv[optind][2],"memory-report")==0)
+        {
+          g_memoryReport = TRUE;
+        }
         else
         {
           err("Unknown option \"-%s\"\n",&argv[optind][1]);
@@ -10407,6 +10636,7 @@ void readConfiguration(int argc, char **argv)
     }
     optind++;
   }
+  Profiler::init();
 
   /**************************************************************************
    *            Parse or generate the config file                           *
@@ -10681,6 +10911,13 @@ static void writeTagFile()
   */
 
   tagFile << "</tagfile>" << endl;
+  tag.close();
+
+  if (Config_getBool(GENERATE_TAGFILE_INDEX))
+  {
+    msg("Generating binary index for tag file %s...\n",generateTagFile.data());
+    writeTagFileIndex(generateTagFile);
+  }
 }
 
 static void exitDoxygen()
@@ -10876,6 +11113,38 @@ void searchInputFiles()
   g_s.end();
 }
 
+//----------------------------------------------------------------------------
+
+static void countEntryLoads(EntryNav *nav,int &entries,int &loads,int &maxLoads)
+{
+  if (nav->loadCount()>0)
+  {
+    entries++;
+    loads+=nav->loadCount();
+    maxLoads=QMAX(maxLoads,nav->loadCount());
+  }
+  if (nav->children())
+  {
+    EntryNavListIterator eli(*nav->children());
+    EntryNav *e;
+    for (;(e=eli.current());++eli)
+    {
+      countEntryLoads(e,entries,loads,maxLoads);
+    }
+  }
+}
+
+/** Reports how often the entries were read back from the entry storage
+ *  by the passes in parseInput().
+ */
+static void reportEntryLoads(EntryNav *rootNav)
+{
+  int entries=0,loads=0,maxLoads=0;
+  countEntryLoads(rootNav,entries,loads,maxLoads);
+  msg("entry storage: %d entries read back %d times (%.1f on average, at most %d)\n",
+      entries,loads,entries>0 ? (double)loads/entries : 0.0,maxLoads);
+}
+
 
 void parseInput()
 {
@@ -11060,6 +11329,7 @@ void parseInput()
 
   g_storage = new FileStorage;
   g_storage->setName(Doxygen::entryDBFileName);
+  g_storage->setMemoryLimit((uint)Config_getInt(ENTRY_CACHE_SIZE)*1024*1024);
   if (!g_storage->open(IO_WriteOnly))
   {
     err("Failed to create temporary storage file %s\n",
@@ -11072,6 +11342,7 @@ void parseInput()
   msg("Reading and parsing tag files\n");
 
   QStrList &tagFileList = Config_getList(TAGFILES);
+  preloadTagFiles(tagFileList);
   char *s=tagFileList.first();
   while (s)
   {
@@ -11276,6 +11547,11 @@ void parseInput()
   Doxygen::classSDict->sort();
   g_s.end();
 
+  if (Debug::isFlagSet(Debug::Time) || Profiler::isEnabled())
+  {
+    reportEntryLoads(rootNav);
+  }
+
   msg("Freeing entry tree\n");
   delete rootNav;
   g_storage->close();
@@ -11376,6 +11652,11 @@ void parseInput()
   g_s.begin("Adding members to index pages...\n");
   addMembersToIndex();
   g_s.end();
+
+  // done after all member relations and documentation are final
+  g_s.begin("Computing inherited member counts...\n");
+  computeInheritedMemberCounts();
+  g_s.end();
 }
 
 void generateOutput()
@@ -11394,6 +11675,11 @@ void generateOutput()
     exit(0);
   }
 
+  if (g_memoryReport)
+  {
+    writeMemoryReport();
+  }
+
   initSearchIndexer();
 
   bool generateHtml  = Config_getBool(GENERATE_HTML);
@@ -11666,6 +11952,9 @@ void generateOutput()
     copyExtraFiles(Config_getList(LATEX_EXTRA_FILES),"LATEX_EXTRA_FILES",Config_getString(LATEX_OUTPUT));
   }
 
+  // wait for the images that are still being encoded
+  ImageManager::instance()->finish();
+
   if (generateHtml &&
       Config_getBool(GENERATE_HTMLHELP) &&
       !Config_getString(HHC_LOCATION).isEmpty())
@@ -11715,6 +12004,8 @@ void generateOutput()
     msg("Note: based on cache misses the ideal setting for LOOKUP_CACHE_SIZE is %d at the cost of higher memory usage.\n",cacheParam);
   }
 
+  Profiler::writeReport(Config_getString(OUTPUT_DIRECTORY));
+
   if (Debug::isFlagSet(Debug::Time))
   {
     msg("Total elapsed time: %.3f seconds\n(of which %.3f seconds waiting for external tools to finish)\n",
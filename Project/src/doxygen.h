@@ -176,18 +176,6 @@ int readFileOrDirectory(const char *s,
                         QDict<void> *killDict = 0,
                         QDict<void> *paths = 0
                        );
-int readDir(QFileInfo *fi,
-            FileNameList *fnList,
-            FileNameDict *fnDict,
-            StringDict  *exclDict,
-            QStrList *patList,
-            QStrList *exclPatList,
-            StringList *resultList,
-            StringDict *resultDict,
-            bool errorIfNotExist,
-            bool recursive,
-            QDict<void> *killDict
-           );
 void copyAndFilterFile(const char *fileName,BufStr &dest);
 
 #endif
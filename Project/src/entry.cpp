@@ -25,6 +25,7 @@
 #include "filestorage.h"
 #include "arguments.h"
 #include "config.h"
+#include "profiler.h"
 //------------------------------------------------------------------
 
 #define HEADER ('D'<<24)+('O'<<16)+('X'<<8)+'!'
@@ -331,7 +332,7 @@ Entry *Entry::removeSubEntry(Entry *e)
 EntryNav::EntryNav(EntryNav *parent, Entry *e)
              : m_parent(parent), m_subList(0), m_section(e->section), m_type(e->type),
               m_name(e->name), m_fileDef(0), m_lang(e->lang), 
-              m_info(0), m_offset(-1), m_noLoad(FALSE) 
+              m_info(0), m_offset(-1), m_noLoad(FALSE), m_loadCount(0) 
 {
   if (e->tagInfo)
   {
@@ -397,10 +398,15 @@ bool EntryNav::loadEntry(FileStorage *storage)
     return FALSE;
   }
   if (m_info)  delete m_info;
-  m_info = unmarshalEntry(storage);
+  m_info = unmarshalEntryBlock(storage);
   m_info->name = m_name;
   m_info->type = m_type;
   m_info->section = m_section;
+  if (m_loadCount++==0)
+  {
+    Profiler::count(Profiler::EntriesLoaded);
+  }
+  Profiler::count(Profiler::EntryLoads);
   return TRUE;
 }
 
@@ -408,7 +414,7 @@ bool EntryNav::saveEntry(Entry *e,FileStorage *storage)
 {
   m_offset = storage->pos();
   //printf("EntryNav::saveEntry offset=%llx\n",m_offset);
-  marshalEntry(storage,e);
+  marshalEntryBlock(storage,e);
   return TRUE;
 }
 
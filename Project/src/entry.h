@@ -352,6 +352,7 @@ class EntryNav
     const QList<EntryNav> *children() const { return m_subList; }
     EntryNav *parent() const { return m_parent; }
     FileDef *fileDef() const { return m_fileDef; }
+    int loadCount() const { return m_loadCount; }
 
   private:
 
@@ -370,6 +371,7 @@ class EntryNav
     Entry       *m_info;
     int64        m_offset;
     bool         m_noLoad;
+    int          m_loadCount;   //!< number of times the entry was read back
 };
 
 
@@ -15,6 +15,8 @@
 
 #include <qfile.h>
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 #include "store.h"
 
 
@@ -24,23 +26,85 @@
 /** @brief Store implementation based on a file. 
     Writing is linear, after that the file is re-opened for reading.
     Reading is random (seek+read).
+    The first part of the data, up to the limit set with setMemoryLimit(),
+    is kept in memory instead of in the file.
  */
 class FileStorage : public StorageIntf
 {
   public:
-    FileStorage() : m_readOnly(FALSE) {}
+    FileStorage() : m_readOnly(FALSE), m_pos(0), m_mem(0), m_memSize(0), 
+                    m_memAlloc(0), m_memLimit(0), m_spilled(FALSE) {}
     FileStorage( const QString &name) : 
-                    m_readOnly(FALSE)    { m_file.setName(name); }
-    int read(char *buf,uint size)        { return m_file.readBlock(buf,size); }
-    int write(const char *buf,uint size) { assert(m_readOnly==FALSE); return m_file.writeBlock(buf,size); }
-    bool open( int m )                   { m_readOnly = m==IO_ReadOnly; return m_file.open(m); }
-    bool seek(int64 pos)                 { return m_file.seek(pos); }
-    int64 pos() const                    { return m_file.pos(); }
+                    m_readOnly(FALSE), m_pos(0), m_mem(0), m_memSize(0), 
+                    m_memAlloc(0), m_memLimit(0), m_spilled(FALSE)
+                                         { m_file.setName(name); }
+   ~FileStorage()                        { free(m_mem); }
+    int read(char *buf,uint size)
+    {
+      uint n=0;
+      if (m_pos<(int64)m_memSize) // (partly) in memory
+      {
+        n = QMIN(size,m_memSize-(uint)m_pos);
+        memcpy(buf,m_mem+m_pos,n);
+        m_pos+=n;
+        if (m_pos==(int64)m_memSize) m_file.seek(0); // continue at the start of the file
+        if (n==size) return n;
+      }
+      int r = m_file.readBlock(buf+n,size-n);
+      if (r<0) return r;
+      m_pos+=r;
+      return n+r;
+    }
+    int write(const char *buf,uint size) 
+    { 
+      assert(m_readOnly==FALSE); 
+      if (!m_spilled && m_memSize+size<=m_memLimit)
+      {
+        if (m_memSize+size>m_memAlloc)
+        {
+          m_memAlloc = QMIN(m_memLimit,QMAX(m_memSize+size,m_memAlloc*2+4096));
+          m_mem = (char *)realloc(m_mem,m_memAlloc);
+        }
+        memcpy(m_mem+m_memSize,buf,size);
+        m_memSize+=size;
+        m_pos+=size;
+        return size;
+      }
+      m_spilled=TRUE; // the rest goes to the file
+      int r = m_file.writeBlock(buf,size); 
+      if (r>0) m_pos+=r;
+      return r;
+    }
+    bool open( int m )
+    { 
+      m_readOnly = m==IO_ReadOnly; 
+      m_pos = 0;
+      if (!m_readOnly) // start with an empty store
+      {
+        m_memSize = 0;
+        m_spilled = FALSE;
+      }
+      return m_file.open(m); 
+    }
+    bool seek(int64 pos)
+    { 
+      m_pos = pos;
+      return pos<(int64)m_memSize || m_file.seek(pos-m_memSize); 
+    }
+    int64 pos() const                    { return m_pos; }
     void close()                         { m_file.close(); }
     void setName( const char *name )     { m_file.setName(name); }
+    /** Keeps up to \a limit bytes of the data in memory. */
+    void setMemoryLimit(uint limit)      { m_memLimit = limit; }
   private:
     bool m_readOnly;
     QFile m_file;
+    int64 m_pos;
+    char *m_mem;
+    uint m_memSize;
+    uint m_memAlloc;
+    uint m_memLimit;
+    bool m_spilled;
 };
 
 #if 0 // experimental version using mmap after opening the file as read only.
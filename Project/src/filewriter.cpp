@@ -0,0 +1,214 @@
+/******************************************************************************
+ *
+ * Copyright (C) 1997-2015 by Dimitri van Heesch.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License is hereby
+ * granted. No representations are made about the suitability of this software
+ * for any purpose. It is provided "as is" without express or implied warranty.
+ * See the GNU General Public License for more details.
+ *
+ * Documents produced by Doxygen are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+ */
+
+#include <stdio.h>
+
+#include <qgstring.h>
+#include <qthread.h>
+#include <qmutex.h>
+#include <qwaitcondition.h>
+#include <qqueue.h>
+#include <qlist.h>
+
+#include "filewriter.h"
+#include "ftextstream.h"
+#include "message.h"
+#include "portable.h"
+
+/** A file generated in memory, waiting to be written to disk */
+struct FileWriteJob
+{
+  // the name is deep copied, QCString's reference count is not thread safe
+  FileWriteJob(const QCString &name,QGString *d,bool app)
+    : fileName(name.data()), data(d), append(app) {}
+ ~FileWriteJob() { delete data; }
+  QCString  fileName;
+  QGString *data;
+  bool      append;
+};
+
+/** Queue of generated files shared with the writer threads.
+ *  The number of pending files is bounded to limit memory usage.
+ */
+class FileWriteQueue
+{
+  public:
+    FileWriteQueue(uint maxPending) : m_maxPending(maxPending), m_failed(FALSE) {}
+    void enqueue(FileWriteJob *job)
+    {
+      QMutexLocker locker(&m_mutex);
+      while (m_queue.count()>=m_maxPending)
+      {
+        m_bufferNotFull.wait(&m_mutex);
+      }
+      m_queue.enqueue(job);
+      m_bufferNotEmpty.wakeAll();
+    }
+    FileWriteJob *dequeue()
+    {
+      QMutexLocker locker(&m_mutex);
+      while (m_queue.isEmpty())
+      {
+        m_bufferNotEmpty.wait(&m_mutex);
+      }
+      FileWriteJob *job = m_queue.dequeue();
+      m_bufferNotFull.wakeAll();
+      return job;
+    }
+    void setFailed()
+    {
+      QMutexLocker locker(&m_mutex);
+      m_failed=TRUE;
+    }
+    bool failed()
+    {
+      QMutexLocker locker(&m_mutex);
+      return m_failed;
+    }
+  private:
+    QWaitCondition       m_bufferNotEmpty;
+    QWaitCondition       m_bufferNotFull;
+    QQueue<FileWriteJob> m_queue;
+    uint                 m_maxPending;
+    bool                 m_failed;
+    QMutex               m_mutex;
+};
+
+/** Worker thread writing generated files to disk */
+class FileWriterThread : public QThread
+{
+  public:
+    FileWriterThread(FileWriteQueue *queue) : m_queue(queue) {}
+    void run()
+    {
+      FileWriteJob *job;
+      while ((job=m_queue->dequeue()))
+      {
+        FILE *f = portable_fopen(job->fileName,job->append ? "ab" : "wb");
+        if (f==0)
+        {
+          err("Cannot open file %s for writing!\n",job->fileName.data());
+          m_queue->setFailed();
+        }
+        else
+        {
+          uint len = job->data->length();
+          if (len>0 && fwrite(job->data->data(),1,len,f)!=len)
+          {
+            err("Failed to write file %s!\n",job->fileName.data());
+            m_queue->setFailed();
+          }
+          fclose(f);
+        }
+        delete job;
+      }
+    }
+  private:
+    FileWriteQueue *m_queue;
+};
+
+//------------------------------------------------------------------------------------------
+
+struct FileWriterPool::Private
+{
+  Private(uint maxPending) : queue(maxPending) {}
+  FileWriteQueue         queue;
+  QList<FileWriterThread> threads;
+};
+
+FileWriterPool::FileWriterPool(int numThreads,uint maxPending)
+{
+  p = new Private(maxPending);
+  p->threads.setAutoDelete(TRUE);
+  int i;
+  for (i=0;i<numThreads;i++)
+  {
+    FileWriterThread *thread = new FileWriterThread(&p->queue);
+    thread->start();
+    p->threads.append(thread);
+  }
+}
+
+FileWriterPool::~FileWriterPool()
+{
+  finish();
+  delete p;
+}
+
+bool FileWriterPool::finish()
+{
+  QListIterator<FileWriterThread> li(p->threads);
+  FileWriterThread *thread;
+  for (li.toFirst();(thread=li.current());++li)
+  {
+    p->queue.enqueue(0); // add terminator for each thread
+  }
+  for (li.toFirst();(thread=li.current());++li)
+  {
+    thread->wait();
+  }
+  p->threads.clear();
+  return !p->queue.failed();
+}
+
+void FileWriterPool::write(const QCString &fileName,QGString *data)
+{
+  p->queue.enqueue(new FileWriteJob(fileName,data,FALSE));
+}
+
+void FileWriterPool::append(const QCString &fileName,QGString *data)
+{
+  p->queue.enqueue(new FileWriteJob(fileName,data,TRUE));
+}
+
+//------------------------------------------------------------------------------------------
+
+PooledOutputFile::PooledOutputFile(const QCString &fileName,FileWriterPool *pool)
+  : m_fileName(fileName), m_pool(pool), m_file(fileName), m_data(0), m_stream(0)
+{
+}
+
+PooledOutputFile::~PooledOutputFile()
+{
+  close();
+}
+
+bool PooledOutputFile::open()
+{
+  if (m_pool)
+  {
+    m_data = new QGString;
+    m_stream = new FTextStream(m_data);
+    return TRUE;
+  }
+  if (!m_file.open(IO_WriteOnly)) return FALSE;
+  m_stream = new FTextStream(&m_file);
+  return TRUE;
+}
+
+void PooledOutputFile::close()
+{
+  delete m_stream;
+  m_stream=0;
+  if (m_data)
+  {
+    m_pool->write(m_fileName,m_data);
+    m_data=0;
+  }
+  else if (m_file.isOpen())
+  {
+    m_file.close();
+  }
+}
@@ -0,0 +1,83 @@
+/******************************************************************************
+ *
+ * Copyright (C) 1997-2015 by Dimitri van Heesch.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License is hereby
+ * granted. No representations are made about the suitability of this software
+ * for any purpose. It is provided "as is" without express or implied warranty.
+ * See the GNU General Public License for more details.
+ *
+ * Documents produced by Doxygen are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+ */
+
+#ifndef FILEWRITER_H
+#define FILEWRITER_H
+
+#include <qcstring.h>
+#include <qfile.h>
+
+class QGString;
+class FTextStream;
+
+/** @brief Pool of threads writing files that were generated in memory.
+ *
+ *  Output generators keep producing the contents of the next file on the
+ *  main thread while earlier files are written to disk by the pool.
+ */
+class FileWriterPool
+{
+  public:
+    /** Starts \a numThreads writer threads. At most \a maxPending files
+     *  are kept in memory, write() blocks when that limit is reached.
+     */
+    FileWriterPool(int numThreads,uint maxPending);
+
+    /** Waits until all queued files are written and stops the threads. */
+   ~FileWriterPool();
+
+    /** Waits until all queued files are written and stops the threads.
+     *  Returns FALSE if any file could not be written. No files can be
+     *  queued afterwards.
+     */
+    bool finish();
+
+    /** Queues \a data to be written to \a fileName. Takes ownership of \a data. */
+    void write(const QCString &fileName,QGString *data);
+
+    /** Queues \a data to be appended to \a fileName. Takes ownership of \a data.
+     *  The blocks of a file are appended in the order in which they are
+     *  queued if the pool has a single thread.
+     */
+    void append(const QCString &fileName,QGString *data);
+
+  private:
+    struct Private;
+    Private *p;
+};
+
+/** @brief Output file that is written directly or via a FileWriterPool.
+ *
+ *  When a pool is passed the contents are collected in memory and handed
+ *  to the pool when the file is closed, otherwise the file is written
+ *  directly.
+ */
+class PooledOutputFile
+{
+  public:
+    PooledOutputFile(const QCString &fileName,FileWriterPool *pool);
+   ~PooledOutputFile();
+    bool open();
+    FTextStream &stream() { return *m_stream; }
+    void close();
+  private:
+    QCString        m_fileName;
+    FileWriterPool *m_pool;
+    QFile           m_file;
+    QGString       *m_data;
+    FTextStream    *m_stream;
+};
+
+#endif
@@ -0,0 +1,362 @@
+/******************************************************************************
+ *
+ * Copyright (C) 1997-2015 by Dimitri van Heesch.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License is hereby
+ * granted. No representations are made about the suitability of this software
+ * for any purpose. It is provided "as is" without express or implied warranty.
+ * See the GNU General Public License for more details.
+ *
+ * Documents produced by Doxygen are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+ */
+
+#include <stdio.h>
+
+#include <qcache.h>
+#include <qdict.h>
+#include <qdir.h>
+#include <qfile.h>
+#include <qlist.h>
+#include <qqueue.h>
+#include <qthread.h>
+#include <qmutex.h>
+#include <qwaitcondition.h>
+
+#include "filtercache.h"
+#include "bufstr.h"
+#include "config.h"
+#include "debug.h"
+#include "message.h"
+#include "portable.h"
+#include "util.h"
+#include "md5.h"
+
+/** Runs \a cmd and appends its output to \a output.
+ *  Called from the filter threads, so it only uses plain C I/O.
+ */
+static bool runFilter(const char *cmd,BufStr &output)
+{
+  FILE *f=portable_popen(cmd,"r");
+  if (!f) return FALSE;
+  const int bufSize=65536;
+  char *buf = new char[bufSize];
+  int numRead;
+  while ((numRead=(int)fread(buf,1,bufSize,f))>0)
+  {
+    output.addArray(buf,numRead);
+  }
+  delete[] buf;
+  portable_pclose(f);
+  return TRUE;
+}
+
+/** Stores the MD5 digest of the contents of \a fileName in \a digest
+ *  as a string of 32 hex digits.
+ */
+static bool contentDigest(const char *fileName,char *digest)
+{
+  FILE *f=portable_fopen(fileName,"rb");
+  if (!f) return FALSE;
+  const int bufSize=65536;
+  unsigned char *buf = new unsigned char[bufSize];
+  struct MD5Context ctx;
+  MD5Init(&ctx);
+  int numRead;
+  while ((numRead=(int)fread(buf,1,bufSize,f))>0)
+  {
+    MD5Update(&ctx,buf,numRead);
+  }
+  delete[] buf;
+  fclose(f);
+  unsigned char sig[16];
+  MD5Final(sig,&ctx);
+  MD5SigToString(sig,digest,33);
+  return TRUE;
+}
+
+//------------------------------------------------------------------------------------------
+
+/** Filter run that was started ahead of the parser. The command is only
+ *  read by the filter thread, the job is owned by the main thread.
+ */
+struct FilterJob
+{
+  FilterJob(const char *cmd,const char *dig)
+    : command(cmd), output(4096), ok(FALSE), done(FALSE)
+  {
+    qstrncpy(digest,dig,sizeof(digest));
+  }
+  QCString command;
+  char     digest[33];
+  BufStr   output;
+  bool     ok;
+  bool     done;
+};
+
+static QMutex               g_jobMutex;
+static QWaitCondition       g_jobAvailable;
+static QWaitCondition       g_jobDone;
+static QQueue<FilterJob>    g_jobQueue;
+
+/** Thread running the filters of prefetched files */
+class FilterThread : public QThread
+{
+  public:
+    void run()
+    {
+      for (;;)
+      {
+        g_jobMutex.lock();
+        while (g_jobQueue.isEmpty())
+        {
+          g_jobAvailable.wait(&g_jobMutex);
+        }
+        FilterJob *job = g_jobQueue.dequeue();
+        g_jobMutex.unlock();
+        if (job==0) return; // terminator
+
+        bool ok = runFilter(job->command.data(),job->output);
+
+        g_jobMutex.lock();
+        job->ok   = ok;
+        job->done = TRUE;
+        g_jobDone.wakeAll();
+        g_jobMutex.unlock();
+      }
+    }
+};
+
+//------------------------------------------------------------------------------------------
+
+static bool                 g_initialized = FALSE;
+static QCache<BufStr>      *g_outputCache = 0;
+static QCString             g_cacheDir;
+static QList<FilterThread>  g_filterThreads;
+static QDict<FilterJob>     g_pendingJobs(1009); // prefetched jobs keyed on command
+static int                  g_filterRuns = 0;
+static int                  g_cacheHits = 0;
+
+static void initFilterCache()
+{
+  if (g_initialized) return;
+  g_initialized=TRUE;
+  g_pendingJobs.setAutoDelete(TRUE);
+  g_filterThreads.setAutoDelete(TRUE);
+  int cacheSize = Config_getInt(FILTER_CACHE_SIZE);
+  if (cacheSize>0)
+  {
+    g_outputCache = new QCache<BufStr>(cacheSize*1024,1009);
+    g_outputCache->setAutoDelete(TRUE);
+  }
+  g_cacheDir = Config_getString(FILTER_CACHE_DIR);
+  if (!g_cacheDir.isEmpty())
+  {
+    QDir dir;
+    if (!dir.exists(g_cacheDir) && !dir.mkdir(g_cacheDir))
+    {
+      err("Could not create filter cache directory %s\n",g_cacheDir.data());
+      g_cacheDir.resize(0);
+    }
+  }
+  int numThreads = getNumProcThreads();
+  if (numThreads>1)
+  {
+    int i;
+    for (i=0;i<numThreads;i++)
+    {
+      FilterThread *thread = new FilterThread;
+      thread->start();
+      g_filterThreads.append(thread);
+    }
+  }
+}
+
+static QCString filterCommand(const char *fileName,const QCString &filter)
+{
+  return filter+" \""+fileName+"\"";
+}
+
+/** Returns the cache key for the output of \a cmd on a file with contents
+ *  \a digest. The command includes the file name, as filters may use it.
+ */
+static QCString cacheKey(const QCString &cmd,const char *digest)
+{
+  return cmd+"\t"+digest;
+}
+
+/** Returns the name of the file in FILTER_CACHE_DIR for \a key */
+static QCString cacheFileName(const QCString &key)
+{
+  uchar sig[16];
+  char name[33];
+  MD5Buffer((const unsigned char *)key.data(),key.length(),sig);
+  MD5SigToString(sig,name,33);
+  return g_cacheDir+"/"+name;
+}
+
+static void storeOutput(const QCString &key,const BufStr &output)
+{
+  uint len = output.curPos();
+  if (g_outputCache)
+  {
+    BufStr *copy = new BufStr(len+1);
+    copy->addArray(output.data(),len);
+    if (!g_outputCache->insert(key,copy,len/1024+1))
+    {
+      delete copy; // larger than the whole cache
+    }
+  }
+  if (!g_cacheDir.isEmpty())
+  {
+    QFile f(cacheFileName(key));
+    if (!f.exists() && f.open(IO_WriteOnly))
+    {
+      if (len>0) f.writeBlock(output.data(),len);
+      f.close();
+    }
+  }
+}
+
+static bool isCached(const QCString &key)
+{
+  if (g_outputCache && g_outputCache->find(key,FALSE)) return TRUE;
+  return !g_cacheDir.isEmpty() && QFile::exists(cacheFileName(key));
+}
+
+static bool lookupOutput(const QCString &key,BufStr &buf)
+{
+  if (g_outputCache)
+  {
+    BufStr *output = g_outputCache->find(key);
+    if (output)
+    {
+      buf.addArray(output->data(),output->curPos());
+      return TRUE;
+    }
+  }
+  if (!g_cacheDir.isEmpty())
+  {
+    QFile f(cacheFileName(key));
+    if (f.open(IO_ReadOnly))
+    {
+      BufStr output(f.size()+1);
+      uint len = f.size();
+      output.skip(len);
+      if (f.readBlock(output.data(),len)==(int)len)
+      {
+        buf.addArray(output.data(),len);
+        storeOutput(key,output);
+        return TRUE;
+      }
+    }
+  }
+  return FALSE;
+}
+
+void FilterCache::prefetch(const char *fileName,const QCString &filter)
+{
+  if (filter.isEmpty()) return;
+  initFilterCache();
+  if (g_filterThreads.isEmpty()) return;
+  QCString cmd = filterCommand(fileName,filter);
+  if (g_pendingJobs.find(cmd)) return;
+  char digest[33];
+  // unreadable files and cached output are left to readFilteredFile()
+  if (!contentDigest(fileName,digest) || isCached(cacheKey(cmd,digest))) return;
+  Debug::print(Debug::ExtCmd,0,"Executing popen(`%s`) in the background\n",qPrint(cmd));
+  FilterJob *job = new FilterJob(cmd.data(),digest);
+  g_pendingJobs.insert(cmd,job);
+  g_jobMutex.lock();
+  g_jobQueue.enqueue(job);
+  g_jobAvailable.wakeOne();
+  g_jobMutex.unlock();
+}
+
+bool FilterCache::readFilteredFile(const char *fileName,const QCString &filter,BufStr &buf)
+{
+  initFilterCache();
+  QCString cmd = filterCommand(fileName,filter);
+  FilterJob *job = g_pendingJobs.take(cmd);
+  if (job) // filter was started in the background
+  {
+    g_jobMutex.lock();
+    while (!job->done)
+    {
+      g_jobDone.wait(&g_jobMutex);
+    }
+    g_jobMutex.unlock();
+    bool ok = job->ok;
+    if (ok)
+    {
+      g_filterRuns++;
+      buf.addArray(job->output.data(),job->output.curPos());
+      storeOutput(cacheKey(cmd,job->digest),job->output);
+    }
+    delete job;
+    return ok;
+  }
+
+  char digest[33];
+  bool hasDigest = contentDigest(fileName,digest);
+  if (hasDigest && lookupOutput(cacheKey(cmd,digest),buf))
+  {
+    g_cacheHits++;
+    return TRUE;
+  }
+  Debug::print(Debug::ExtCmd,0,"Executing popen(`%s`)\n",qPrint(cmd));
+  BufStr output(4096);
+  if (!runFilter(cmd,output))
+  {
+    return FALSE;
+  }
+  g_filterRuns++;
+  buf.addArray(output.data(),output.curPos());
+  if (hasDigest)
+  {
+    storeOutput(cacheKey(cmd,digest),output);
+  }
+  return TRUE;
+}
+
+FILE *FilterCache::openFilteredFile(const char *fileName,const QCString &filter)
+{
+  BufStr output(4096);
+  if (!readFilteredFile(fileName,filter,output)) return 0;
+  FILE *f = tmpfile();
+  if (f==0) return 0;
+  if (output.curPos()>0) fwrite(output.data(),1,output.curPos(),f);
+  rewind(f);
+  return f;
+}
+
+void FilterCache::cleanup()
+{
+  if (!g_initialized) return;
+  QListIterator<FilterThread> li(g_filterThreads);
+  FilterThread *thread;
+  g_jobMutex.lock();
+  for (li.toFirst();(thread=li.current());++li)
+  {
+    g_jobQueue.enqueue(0); // add terminator for each thread
+  }
+  g_jobAvailable.wakeAll();
+  g_jobMutex.unlock();
+  for (li.toFirst();(thread=li.current());++li)
+  {
+    thread->wait();
+  }
+  g_filterThreads.clear();
+  g_pendingJobs.clear();
+  if (g_filterRuns>0 || g_cacheHits>0)
+  {
+    Debug::print(Debug::ExtCmd,0,"Input filters: %d runs, %d cache hits\n",g_filterRuns,g_cacheHits);
+  }
+  delete g_outputCache;
+  g_outputCache=0;
+  g_filterRuns=0;
+  g_cacheHits=0;
+  g_initialized=FALSE;
+}
@@ -0,0 +1,57 @@
+/******************************************************************************
+ *
+ * Copyright (C) 1997-2015 by Dimitri van Heesch.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License is hereby
+ * granted. No representations are made about the suitability of this software
+ * for any purpose. It is provided "as is" without express or implied warranty.
+ * See the GNU General Public License for more details.
+ *
+ * Documents produced by Doxygen are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+ */
+
+#ifndef FILTERCACHE_H
+#define FILTERCACHE_H
+
+#include <stdio.h>
+#include <qcstring.h>
+
+class BufStr;
+
+/** @brief Runs input filters and caches their output.
+ *
+ *  The output is cached per filter command and contents of the input
+ *  file, so a file that is filtered for parsing and again for the source
+ *  browser runs the filter only once. When FILTER_CACHE_DIR is set the
+ *  output is also kept on disk for later runs. Files can be prefetched,
+ *  in which case their filters are run by a pool of threads ahead of the
+ *  parser.
+ */
+class FilterCache
+{
+  public:
+    /** Starts running \a filter on \a fileName in the background. Does
+     *  nothing if doxygen runs single threaded, \a filter is empty or the
+     *  output for the current contents of \a fileName is already cached.
+     */
+    static void prefetch(const char *fileName,const QCString &filter);
+
+    /** Appends the output of \a filter for \a fileName to \a buf.
+     *  Returns FALSE if the filter could not be executed.
+     */
+    static bool readFilteredFile(const char *fileName,const QCString &filter,BufStr &buf);
+
+    /** Returns a temporary file positioned at the start of the output of
+     *  \a filter for \a fileName, or 0 if the filter could not be executed.
+     *  The file should be closed with fclose().
+     */
+    static FILE *openFilteredFile(const char *fileName,const QCString &filter);
+
+    /** Stops the background filters and frees the cached output. */
+    static void cleanup();
+};
+
+#endif
@@ -2266,6 +2266,7 @@ void HtmlGenerator::writeSearchPage()
     writePageFooter(t,"Search","","");
   }
   QCString scriptName = htmlOutput+"/search/search.js";
+  QFile::remove(scriptName); // may be a read-only link into the RESOURCE_CACHE_DIR
   QFile sf(scriptName);
   if (sf.open(IO_WriteOnly))
   {
@@ -2329,6 +2330,7 @@ void HtmlGenerator::writeExternalSearchPage()
     writePageFooter(t,"Search","","");
   }
   QCString scriptName = Config_getString(HTML_OUTPUT)+"/search/search.js";
+  QFile::remove(scriptName); // may be a read-only link into the RESOURCE_CACHE_DIR
   QFile sf(scriptName);
   if (sf.open(IO_WriteOnly))
   {
@@ -18,9 +18,21 @@
 
 #include "image.h"
 #include <qfile.h>
+#include <qfileinfo.h>
+#include <qthread.h>
+#include <qmutex.h>
+#include <qwaitcondition.h>
+#include <qqueue.h>
+#include <qlist.h>
 #include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "lodepng.h"
 #include "config.h"
+#include "message.h"
+#include "portable.h"
+#include "util.h"
 
 typedef unsigned char  Byte;
 
@@ -380,6 +392,38 @@ void Image::fillRect(int x,int y,int lwidth,int lheight,uchar colIndex,uint mask
         setPixel(xp,yp,colIndex);
 }
 
+/** A PNG image waiting to be encoded and written to disk */
+struct PngJob
+{
+  /** Copies the \a w x \a h pixels of \a pixels. Must be created on the
+   *  main thread, as it reads the configuration and the current directory.
+   */
+  PngJob(const char *name,const uchar *pixels,int w,int h,int bytesPerPixel)
+    : fileName(QFileInfo(name).absFilePath().utf8()), width(w), height(h)
+  {
+    uint size = w*h*bytesPerPixel;
+    data = (uchar *)malloc(size);
+    memcpy(data,pixels,size);
+    LodePNG_Encoder_init(&encoder);
+    if (Config_getBool(FAST_PNG_COMPRESSION))
+    {
+      // a smaller LZ77 window makes encoding about 2.5 times faster,
+      // at the cost of a few percent in size.
+      encoder.settings.zlibsettings.windowSize = 512;
+    }
+  }
+ ~PngJob()
+  {
+    LodePNG_Encoder_cleanup(&encoder);
+    free(data);
+  }
+  QCString        fileName;
+  uchar          *data;
+  int             width;
+  int             height;
+  LodePNG_Encoder encoder;
+};
+
 bool Image::save(const char *fileName,int mode)
 {
 #if 0
@@ -400,10 +444,7 @@ bool Image::save(const char *fileName,int mode)
   }
 #endif
   static bool useTransparency = Config_getBool(FORMULA_TRANSPARENT);
-  uchar* buffer;
-  size_t bufferSize;
-  LodePNG_Encoder encoder;
-  LodePNG_Encoder_init(&encoder);
+  PngJob *job = new PngJob(fileName,data,width,height,1);
   int numCols = mode==0 ? 8 : 16;
   Color *pPal = mode==0         ? palette  : 
                 useTransparency ? palette2 : 
@@ -411,16 +452,12 @@ bool Image::save(const char *fileName,int mode)
   int i;
   for (i=0;i<numCols;i++,pPal++)
   {
-    LodePNG_InfoColor_addPalette(&encoder.infoPng.color,
+    LodePNG_InfoColor_addPalette(&job->encoder.infoPng.color,
                                  pPal->red,pPal->green,pPal->blue,pPal->alpha);
   }
-  encoder.infoPng.color.colorType = 3; 
-  encoder.infoRaw.color.colorType = 3;
-  LodePNG_encode(&encoder, &buffer, &bufferSize, data, width, height);
-  LodePNG_saveFile(buffer, bufferSize, fileName);
-  free(buffer);
-  LodePNG_Encoder_cleanup(&encoder);
-  return TRUE;
+  job->encoder.infoPng.color.colorType = 3; 
+  job->encoder.infoRaw.color.colorType = 3;
+  return ImageManager::instance()->addJob(job);
 }
 
 //----------------------------------------------------------------
@@ -524,17 +561,185 @@ ColoredImage::~ColoredImage()
 
 bool ColoredImage::save(const char *fileName)
 {
-  uchar *buffer;
-  size_t bufferSize;
-  LodePNG_Encoder encoder;
-  LodePNG_Encoder_init(&encoder);
-  encoder.infoPng.color.colorType = m_hasAlpha ? 6 : 2; // 2=RGB 24 bit, 6=RGBA 32 bit
-  encoder.infoRaw.color.colorType = 6; // 6=RGBA 32 bit
-  LodePNG_encode(&encoder, &buffer, &bufferSize, m_data, m_width, m_height);
-  LodePNG_saveFile(buffer, bufferSize, fileName);
-  LodePNG_Encoder_cleanup(&encoder);
+  PngJob *job = new PngJob(fileName,m_data,m_width,m_height,4);
+  job->encoder.infoPng.color.colorType = m_hasAlpha ? 6 : 2; // 2=RGB 24 bit, 6=RGBA 32 bit
+  job->encoder.infoRaw.color.colorType = 6; // 6=RGBA 32 bit
+  return ImageManager::instance()->addJob(job);
+}
+
+//----------------------------------------------------------------
+
+/** Encodes the image of \a job and writes it, unless the file is unchanged.
+ *  Returns FALSE if the image could not be encoded or written.
+ */
+static bool writePng(PngJob *job)
+{
+  uchar *buffer=0;
+  size_t bufferSize=0;
+  bool ok=TRUE;
+  LodePNG_encode(&job->encoder, &buffer, &bufferSize, job->data, job->width, job->height);
+  if (job->encoder.error)
+  {
+    err("Failed to encode image %s (error %d)!\n",job->fileName.data(),job->encoder.error);
+    ok=FALSE;
+  }
+  else if (!fileHasContent(job->fileName,(const char *)buffer,(uint)bufferSize))
+  {
+    remove(job->fileName); // replace rather than overwrite, it may be a link
+    FILE *f = portable_fopen(job->fileName,"wb");
+    if (f==0)
+    {
+      err("Cannot open file %s for writing!\n",job->fileName.data());
+      ok=FALSE;
+    }
+    else
+    {
+      if (bufferSize>0 && fwrite(buffer,1,bufferSize,f)!=bufferSize)
+      {
+        err("Failed to write file %s!\n",job->fileName.data());
+        ok=FALSE;
+      }
+      fclose(f);
+    }
+  }
   free(buffer);
-  return TRUE;
+  return ok;
+}
+
+/** Queue of images shared with the worker threads.
+ *  The number of pending images is bounded to limit memory usage.
+ */
+class PngJobQueue
+{
+  public:
+    PngJobQueue(uint maxPending) : m_maxPending(maxPending), m_failed(FALSE) {}
+    void enqueue(PngJob *job)
+    {
+      QMutexLocker locker(&m_mutex);
+      while (m_queue.count()>=m_maxPending)
+      {
+        m_bufferNotFull.wait(&m_mutex);
+      }
+      m_queue.enqueue(job);
+      m_bufferNotEmpty.wakeAll();
+    }
+    PngJob *dequeue()
+    {
+      QMutexLocker locker(&m_mutex);
+      while (m_queue.isEmpty())
+      {
+        m_bufferNotEmpty.wait(&m_mutex);
+      }
+      PngJob *job = m_queue.dequeue();
+      m_bufferNotFull.wakeAll();
+      return job;
+    }
+    void setFailed()
+    {
+      QMutexLocker locker(&m_mutex);
+      m_failed=TRUE;
+    }
+    /** Returns TRUE if an image failed since the previous call */
+    bool takeFailed()
+    {
+      QMutexLocker locker(&m_mutex);
+      bool failed=m_failed;
+      m_failed=FALSE;
+      return failed;
+    }
+  private:
+    QWaitCondition m_bufferNotEmpty;
+    QWaitCondition m_bufferNotFull;
+    QQueue<PngJob> m_queue;
+    uint           m_maxPending;
+    bool           m_failed;
+    QMutex         m_mutex;
+};
+
+/** Worker thread encoding and writing images */
+class PngWorkerThread : public QThread
+{
+  public:
+    PngWorkerThread(PngJobQueue *queue) : m_queue(queue) {}
+    void run()
+    {
+      PngJob *job;
+      while ((job=m_queue->dequeue()))
+      {
+        if (!writePng(job)) m_queue->setFailed();
+        delete job;
+      }
+    }
+  private:
+    PngJobQueue *m_queue;
+};
+
+struct ImageManager::Private
+{
+  Private(int n) : numThreads(n), queue(n*4) {}
+  int                    numThreads;
+  PngJobQueue            queue;
+  QList<PngWorkerThread> threads;
+};
+
+ImageManager *ImageManager::m_theInstance = 0;
+
+ImageManager *ImageManager::instance()
+{
+  if (m_theInstance==0)
+  {
+    m_theInstance = new ImageManager;
+  }
+  return m_theInstance;
 }
 
+ImageManager::ImageManager()
+{
+  p = new Private(getNumProcThreads());
+  p->threads.setAutoDelete(TRUE);
+}
+
+ImageManager::~ImageManager()
+{
+  finish();
+  delete p;
+}
 
+bool ImageManager::addJob(PngJob *job)
+{
+  if (p->numThreads<=1) // no threads to work with
+  {
+    bool ok = writePng(job);
+    if (!ok) p->queue.setFailed();
+    delete job;
+    return ok;
+  }
+  if (p->threads.isEmpty()) // start the workers on first use
+  {
+    int i;
+    for (i=0;i<p->numThreads;i++)
+    {
+      PngWorkerThread *thread = new PngWorkerThread(&p->queue);
+      thread->start();
+      p->threads.append(thread);
+    }
+  }
+  p->queue.enqueue(job);
+  return TRUE;
+}
+
+bool ImageManager::finish()
+{
+  QListIterator<PngWorkerThread> li(p->threads);
+  PngWorkerThread *thread;
+  for (li.toFirst();(thread=li.current());++li)
+  {
+    p->queue.enqueue(0); // add terminator for each worker
+  }
+  for (li.toFirst();(thread=li.current());++li)
+  {
+    thread->wait();
+  }
+  p->threads.clear();
+  return !p->queue.takeFailed();
+}
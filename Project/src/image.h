@@ -37,6 +37,9 @@ class Image
     void drawVertArrow(int x,int ys,int ye,uchar colIndex,uint mask);
     void drawRect(int x,int y,int width,int height,uchar colIndex,uint mask);
     void fillRect(int x,int y,int width,int height,uchar colIndex,uint mask);
+    /** Writes the image as a PNG file via the ImageManager, see
+     *  ImageManager::addJob() for the meaning of the return value.
+     */
     bool save(const char *fileName,int mode=0);
     friend uint stringLength(const char *s);
     uint getWidth() const { return width; }
@@ -58,6 +61,9 @@ class ColoredImage
            const uchar *greyLevels,const uchar *alphaLevels,
            int saturation,int hue,int gamma);
    ~ColoredImage();
+    /** Writes the image as a PNG file via the ImageManager, see
+     *  ImageManager::addJob() for the meaning of the return value.
+     */
     bool save(const char *fileName);
     static void hsl2rgb(double h,double s,double l,
                         double *pRed,double *pGreen,double *pBlue);
@@ -68,4 +74,37 @@ class ColoredImage
     bool m_hasAlpha;
 };
 
+struct PngJob;
+
+/** @brief Encodes and writes the PNG images drawn by doxygen.
+ *
+ *  The images are encoded on worker threads while the main thread continues
+ *  generating output. An image whose file already has the same content is
+ *  not rewritten. Errors are reported with err() when they occur; callers
+ *  that need to know whether an image was written should check the result
+ *  of finish().
+ */
+class ImageManager
+{
+  public:
+    static ImageManager *instance();
+    /** Queues \a job to be encoded, takes ownership of \a job.
+     *  When doxygen runs single threaded the image is written right away
+     *  and FALSE is returned if that failed. Otherwise TRUE is returned and
+     *  the outcome is only known after finish().
+     */
+    bool addJob(PngJob *job);
+    /** Waits until all queued images are written. Returns FALSE if an
+     *  image added since the previous call could not be written.
+     */
+    bool finish();
+
+  private:
+    ImageManager();
+   ~ImageManager();
+    struct Private;
+    Private *p;
+    static ImageManager *m_theInstance;
+};
+
 #endif
@@ -1,5 +1,7 @@
 #include <qfile.h>
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "sortdict.h"
 #include "marshal.h"
@@ -13,6 +15,54 @@
 
 #define HEADER ('D'<<24)+('O'<<16)+('X'<<8)+'!'
 
+/** @brief Storage in a memory buffer. 
+ *
+ *  Used to marshal an entry as a single block, so that it can be written
+ *  to and read from the real storage with one call.
+ */
+class MarshalBuffer : public StorageIntf
+{
+  public:
+    MarshalBuffer() : m_data(0), m_size(0), m_alloc(0), m_pos(0) {}
+   ~MarshalBuffer() { free(m_data); }
+    /** Empties the buffer before writing a new block */
+    void clear() { m_size=0; m_pos=0; }
+    /** Returns room for a block of \a size bytes that is read next */
+    char *reserve(uint size) { grow(size); m_size=size; m_pos=0; return m_data; }
+    const char *data() const { return m_data; }
+    uint size() const { return m_size; }
+    int read(char *buf,uint size)
+    {
+      uint n = QMIN(size,m_size-m_pos);
+      memcpy(buf,m_data+m_pos,n);
+      m_pos+=n;
+      return n;
+    }
+    int write(const char *buf,uint size)
+    {
+      grow(m_size+size);
+      memcpy(m_data+m_size,buf,size);
+      m_size+=size;
+      return size;
+    }
+  private:
+    void grow(uint size)
+    {
+      if (size>m_alloc)
+      {
+        m_alloc = QMAX(size,m_alloc*2+1024);
+        m_data  = (char *)realloc(m_data,m_alloc);
+      }
+    }
+    char *m_data;
+    uint  m_size;
+    uint  m_alloc;
+    uint  m_pos;
+};
+
+// entries are only marshalled from the main thread
+static MarshalBuffer g_entryBuffer;
+
 void marshalInt(StorageIntf *s,int v)
 {
   uchar b[4];
@@ -413,6 +463,17 @@ void marshalEntryTree(StorageIntf *s,Entry *e)
   }
 }
 
+/** Marshals entry \a e as a length prefixed block. Compared to marshalEntry()
+ *  this needs only two writes to \a s instead of a few for every field.
+ */
+void marshalEntryBlock(StorageIntf *s,Entry *e)
+{
+  g_entryBuffer.clear();
+  marshalEntry(&g_entryBuffer,e);
+  marshalUInt(s,g_entryBuffer.size());
+  s->write(g_entryBuffer.data(),g_entryBuffer.size());
+}
+
 //------------------------------------------------------------------
 
 int unmarshalInt(StorageIntf *s)
@@ -799,3 +860,13 @@ Entry * unmarshalEntryTree(StorageIntf *s)
   }
   return e;
 }
+
+/** Unmarshals an entry written by marshalEntryBlock(). The block is read
+ *  from \a s at once, the fields are then decoded from memory.
+ */
+Entry * unmarshalEntryBlock(StorageIntf *s)
+{
+  uint len = unmarshalUInt(s);
+  s->read(g_entryBuffer.reserve(len),len);
+  return unmarshalEntry(&g_entryBuffer);
+}
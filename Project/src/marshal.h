@@ -66,6 +66,7 @@ void marshalExampleSDict(StorageIntf *s,ExampleSDict *ed);
 void marshalMemberLists(StorageIntf *s,SDict<MemberList> *mls);
 void marshalEntry(StorageIntf *s,Entry *e);
 void marshalEntryTree(StorageIntf *s,Entry *e);
+void marshalEntryBlock(StorageIntf *s,Entry *e);
 
 //----- unmarshaling function: byte stream -> datatype ------------------
 
@@ -93,5 +94,6 @@ ExampleSDict *       unmarshalExampleSDict(StorageIntf *s);
 SDict<MemberList> *  unmarshalMemberLists(StorageIntf *s);
 Entry *              unmarshalEntry(StorageIntf *s);
 Entry *              unmarshalEntryTree(StorageIntf *s);
+Entry *              unmarshalEntryBlock(StorageIntf *s);
 
 #endif
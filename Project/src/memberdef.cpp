@@ -45,6 +45,7 @@
 #include "namespacedef.h"
 #include "filedef.h"
 #include "config.h"
+#include "stringpool.h"
 
 //-----------------------------------------------------------------------------
 
@@ -476,7 +477,7 @@ class MemberDefImpl
     NamespaceDef *nspace;     // the namespace this member is in.
 
     MemberDef  *enumScope;    // the enclosing scope, if this is an enum field
-    bool        livesInsideEnum;
+    bool        livesInsideEnum : 1;
     MemberDef  *annEnumType;  // the anonymous enum that is the type of this member
     MemberList *enumFields;   // enumeration fields
 
@@ -538,7 +539,7 @@ class MemberDefImpl
     int groupStartLine;       // line  "      "      "     "     "
     MemberDef *groupMember;
 
-    bool isTypedefValCached;
+    bool isTypedefValCached : 1;
     ClassDef *cachedTypedefValue;
     QCString cachedTypedefTemplSpec;
     QCString cachedResolvedType;
@@ -555,23 +556,23 @@ class MemberDefImpl
     QCString explicitOutputFileBase;
 
     // objective-c
-    bool implOnly; // function found in implementation but not
+    bool implOnly : 1; // function found in implementation but not
                      // in the interface
-    bool hasDocumentedParams;
-    bool hasDocumentedReturnType;
-    bool isDMember;
+    bool hasDocumentedParams : 1;
+    bool hasDocumentedReturnType : 1;
+    bool isDMember : 1;
     Relationship related;     // relationship of this to the class
-    bool stat;                // is it a static function?
-    bool proto;               // is it a prototype;
-    bool docEnumValues;       // is an enum with documented enum values.
-    bool annScope;            // member is part of an annoymous scope
-    bool annUsed;
-    bool hasCallGraph;
-    bool hasCallerGraph;
-    bool explExt;             // member was explicitly declared external
-    bool tspec;               // member is a template specialization
-    bool groupHasDocs;        // true if the entry that caused the grouping was documented
-    bool docsForDefinition;   // TRUE => documentation block is put before
+    bool stat : 1;                // is it a static function?
+    bool proto : 1;               // is it a prototype;
+    bool docEnumValues : 1;       // is an enum with documented enum values.
+    bool annScope : 1;            // member is part of an annoymous scope
+    bool annUsed : 1;
+    bool hasCallGraph : 1;
+    bool hasCallerGraph : 1;
+    bool explExt : 1;             // member was explicitly declared external
+    bool tspec : 1;               // member is a template specialization
+    bool groupHasDocs : 1;        // true if the entry that caused the grouping was documented
+    bool docsForDefinition : 1;   // TRUE => documentation block is put before
                               //         definition.
                               // FALSE => block is put before declaration.
     ClassDef *category;
@@ -705,6 +706,13 @@ void MemberDefImpl::init(Definition *def,
   hasDocumentedReturnType = FALSE;
   docProvider = 0;
   isDMember = def->getDefFileName().right(2).lower()==".d";
+
+  // share the text of these strings with other members
+  type           = StringPool::intern(type);
+  args           = StringPool::intern(args);
+  decl           = StringPool::intern(decl);
+  exception      = StringPool::intern(exception);
+  extraTypeChars = StringPool::intern(extraTypeChars);
 }
 
 
@@ -1148,6 +1156,11 @@ void MemberDef::setHidden(bool b)
   m_isLinkableCached = 0;
 }
 
+uint MemberDef::objectSize() const
+{
+  return Definition::objectSize()-sizeof(Definition)+sizeof(MemberDef)+sizeof(MemberDefImpl);
+}
+
 bool MemberDef::isLinkableInProject() const
 {
   if (m_isLinkableCached==0)
@@ -3387,7 +3400,7 @@ void MemberDef::setGroupDef(GroupDef *gd,Grouping::GroupPri_t pri,
   //printf("%s MemberDef::setGroupDef(%s)\n",name().data(),gd->name().data());
   m_impl->group=gd;
   m_impl->grouppri=pri;
-  m_impl->groupFileName=fileName;
+  m_impl->groupFileName=StringPool::intern(fileName);
   m_impl->groupStartLine=startLine;
   m_impl->groupHasDocs=hasDocs;
   m_impl->groupMember=member;
@@ -3921,13 +3934,13 @@ void MemberDef::setTypeConstraints(ArgumentList *al)
 
 void MemberDef::setType(const char *t)
 {
-  m_impl->type = t;
+  m_impl->type = StringPool::intern(t);
 }
 
 void MemberDef::setAccessorType(ClassDef *cd,const char *t)
 {
   m_impl->accessorClass = cd;
-  m_impl->accessorType = t;
+  m_impl->accessorType = StringPool::intern(t);
 }
 
 ClassDef *MemberDef::accessorClass() const
@@ -4638,7 +4651,7 @@ void MemberDef::setMemberType(MemberType t)
 
 void MemberDef::setDefinition(const char *d)
 {
-  m_impl->def=d;
+  m_impl->def=StringPool::intern(d);
 }
 
 void MemberDef::setFileDef(FileDef *fd)
@@ -4667,7 +4680,7 @@ void MemberDef::mergeMemberSpecifiers(uint64 s)
 
 void MemberDef::setBitfields(const char *s)
 {
-  m_impl->bitfields = QCString(s).simplifyWhiteSpace();
+  m_impl->bitfields = StringPool::intern(QCString(s).simplifyWhiteSpace());
 }
 
 void MemberDef::setMaxInitLines(int lines)
@@ -4685,12 +4698,12 @@ void MemberDef::setExplicitExternal(bool b)
 
 void MemberDef::setReadAccessor(const char *r)
 {
-  m_impl->read=r;
+  m_impl->read=StringPool::intern(r);
 }
 
 void MemberDef::setWriteAccessor(const char *w)
 {
-  m_impl->write=w;
+  m_impl->write=StringPool::intern(w);
 }
 
 void MemberDef::setTemplateSpecialization(bool b)
@@ -4727,7 +4740,7 @@ void MemberDef::setInheritsDocsFrom(MemberDef *md)
 
 void MemberDef::setArgsString(const char *as)
 {
-  m_impl->args = as;
+  m_impl->args = StringPool::intern(as);
 }
 
 void MemberDef::setRelatedAlso(ClassDef *cd)
@@ -4835,7 +4848,7 @@ void MemberDef::setCategoryRelation(MemberDef *md)
 
 void MemberDef::setEnumBaseType(const QCString &type)
 {
-  m_impl->enumBaseType = type;
+  m_impl->enumBaseType = StringPool::intern(type);
 }
 
 QCString MemberDef::enumBaseType() const
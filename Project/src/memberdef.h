@@ -51,6 +51,7 @@ class MemberDef : public Definition
               const ArgumentList *al);
    ~MemberDef(); 
     DefType definitionType() const        { return TypeMember; }
+    uint objectSize() const;
     // move this member into a different scope
     MemberDef *deepCopy() const;
     void moveTo(Definition *);
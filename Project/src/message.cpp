@@ -15,6 +15,7 @@
 
 #include <stdio.h>
 #include <qdatetime.h>
+#include <qmutex.h>
 #include "config.h"
 #include "util.h"
 #include "debug.h"
@@ -34,6 +35,7 @@ static const char *error_str = "error: ";
 //                            // 6 = $line,$file,$text
 
 static FILE *warnFile = stderr;
+static QMutex warnMutex; // warnings can be issued from worker threads
 
 void initWarningFormat()
 {
@@ -121,6 +123,7 @@ void msg(const char *fmt, ...)
 
 static void format_warn(const char *file,int line,const char *text)
 {
+  QMutexLocker lock(&warnMutex);
   QCString fileSubst = file==0 ? "<unknown>" : file;
   QCString lineSubst; lineSubst.setNum(line);
   QCString textSubst = text;
@@ -23,6 +23,7 @@
 #include <qstack.h>
 #include <qdict.h>
 #include <qfile.h>
+#include <qgstring.h>
 
 #include "perlmodgen.h"
 #include "docparser.h"
@@ -43,63 +44,101 @@
 #include "section.h"
 #include "util.h"
 #include "htmlentity.h"
+#include "filewriter.h"
 
 #define PERLOUTPUT_MAX_INDENTATION 40
 
+/** Buffer collecting the Perl module output. A stream that is attached
+ *  to a file writes its contents in blocks, either directly or via a
+ *  writer thread.
+ */
 class PerlModOutputStream
 {
 public:
 
-  QCString m_s;
-  FTextStream *m_t;
-
-  PerlModOutputStream(FTextStream *t = 0) : m_t(t) { }
+  PerlModOutputStream(QFile *f = 0, FileWriterPool *pool = 0, const char *fileName = 0)
+    : m_file(f), m_pool(pool), m_fileName(fileName), m_data(0), m_len(0), m_size(0), m_ok(true) { }
+  ~PerlModOutputStream() { free(m_data); }
 
-  void add(char c);
-  void add(const char *s);
-  void add(QCString &s);
+  inline void add(char c)
+  {
+    if (m_len==m_size) grow(1);
+    m_data[m_len++] = c;
+  }
+  inline void add(const char *s) { if (s) addArray(s, qstrlen(s)); }
+  inline void add(QCString &s) { addArray(s.data(), s.length()); }
   void add(int n);
   void add(unsigned int n);
+  void addArray(const char *s, uint len);
+
+  /** Returns the text collected so far. */
+  QCString text();
+  /** Writes the collected text if a complete block is available. */
+  inline void flushBlock() { if (m_len>=blockSize) flush(); }
+  /** Writes the collected text, returns false if writing failed. */
+  bool flush();
+
+private:
+  static const uint blockSize = 65536;
+  void grow(uint len);
+
+  QFile *m_file;
+  FileWriterPool *m_pool;
+  QCString m_fileName;
+  char *m_data;
+  uint m_len;
+  uint m_size;
+  bool m_ok;
 };
 
-void PerlModOutputStream::add(char c)
+void PerlModOutputStream::grow(uint len)
 {
-  if (m_t != 0)
-    (*m_t) << c;
-  else
-    m_s += c;
+  m_size = QMAX(m_len+len+1, m_size*2);
+  if (m_size<256) m_size = 256;
+  m_data = (char *)realloc(m_data, m_size);
 }
 
-void PerlModOutputStream::add(const char *s)
+void PerlModOutputStream::addArray(const char *s, uint len)
 {
-  if (m_t != 0)
-    (*m_t) << s;
-  else
-    m_s += s;
+  if (m_len+len>=m_size) grow(len);
+  memcpy(m_data+m_len, s, len);
+  m_len += len;
 }
 
-void PerlModOutputStream::add(QCString &s)
+void PerlModOutputStream::add(int n)
 {
-  if (m_t != 0)
-    (*m_t) << s;
-  else
-    m_s += s;
+  char buf[20];
+  addArray(buf, qsnprintf(buf, sizeof(buf), "%d", n));
 }
 
-void PerlModOutputStream::add(int n)
+void PerlModOutputStream::add(unsigned int n)
 {
-  if (m_t != 0)
-    (*m_t) << n;
-  else
-    m_s += n;
+  char buf[20];
+  addArray(buf, qsnprintf(buf, sizeof(buf), "%u", n));
 }
 
-void PerlModOutputStream::add(unsigned int n)
+QCString PerlModOutputStream::text()
 {
-  if (m_t != 0)
-    (*m_t) << n;
-  else
-    m_s += n;
+  add('\0');
+  m_len--;
+  return QCString(m_data);
+}
+
+bool PerlModOutputStream::flush()
+{
+  if (m_file==0 || m_len==0) return m_ok;
+  if (m_pool)
+  {
+    QGString *block = new QGString(m_len);
+    memcpy(block->data(), m_data, m_len);
+    m_pool->append(QCString(m_fileName.data()), block);
+  }
+  else if (m_file->writeBlock(m_data, m_len)!=(int)m_len)
+  {
+    m_ok = false;
+  }
+  m_len = 0;
+  return m_ok;
 }
 
 class PerlModOutput
@@ -203,7 +242,7 @@ void PerlModOutput::iopenSave()
 
 void PerlModOutput::icloseSave(QCString &s)
 {
-  s = m_stream->m_s;
+  s = m_stream->text();
   delete m_stream;
   m_stream = m_saved.pop();
 }
@@ -2140,9 +2179,17 @@ bool PerlModGenerator::generatePerlModOutput()
   QFile outputFile;
   if (!createOutputFile(outputFile, pathDoxyDocsPM))
     return false;
-  
-  FTextStream outputTextStream(&outputFile);
-  PerlModOutputStream outputStream(&outputTextStream);
+
+  // The documentation is converted on this thread, as the doc parser is
+  // not reentrant. With multiple threads the text is written in blocks by
+  // a writer thread, which appends them in order.
+  FileWriterPool *pool = 0;
+  if (getNumProcThreads()>1)
+  {
+    outputFile.close();
+    pool = new FileWriterPool(1,8);
+  }
+  PerlModOutputStream outputStream(&outputFile, pool, pathDoxyDocsPM);
   m_output.setPerlModOutputStream(&outputStream);
   m_output.add("$doxydocs=").openHash();
   
@@ -2150,14 +2197,20 @@ bool PerlModGenerator::generatePerlModOutput()
   ClassSDict::Iterator cli(*Doxygen::classSDict);
   ClassDef *cd;
   for (cli.toFirst();(cd=cli.current());++cli)
+  {
     generatePerlModForClass(cd);
+    outputStream.flushBlock();
+  }
   m_output.closeList();
 
   m_output.openList("namespaces");
   NamespaceSDict::Iterator nli(*Doxygen::namespaceSDict);
   NamespaceDef *nd;
   for (nli.toFirst();(nd=nli.current());++nli)
+  {
     generatePerlModForNamespace(nd);
+    outputStream.flushBlock();
+  }
   m_output.closeList();
 
   m_output.openList("files");
@@ -2168,7 +2221,10 @@ bool PerlModGenerator::generatePerlModOutput()
     FileNameIterator fni(*fn);
     FileDef *fd;
     for (;(fd=fni.current());++fni)
+    {
       generatePerlModForFile(fd);
+      outputStream.flushBlock();
+    }
   }
   m_output.closeList();
 
@@ -2178,6 +2234,7 @@ bool PerlModGenerator::generatePerlModOutput()
   for (;(gd=gli.current());++gli)
   {
     generatePerlModForGroup(gd);
+    outputStream.flushBlock();
   }
   m_output.closeList();
 
@@ -2187,6 +2244,7 @@ bool PerlModGenerator::generatePerlModOutput()
   for (pdi.toFirst();(pd=pdi.current());++pdi)
   {
     generatePerlModForPage(pd);
+    outputStream.flushBlock();
   }
   if (Doxygen::mainPage)
   {
@@ -2195,7 +2253,18 @@ bool PerlModGenerator::generatePerlModOutput()
   m_output.closeList();
 
   m_output.closeHash().add(";\n1;\n");
-  return true;
+  bool ok = outputStream.flush();
+  m_output.setPerlModOutputStream(0);
+  if (pool)
+  {
+    ok = pool->finish() && ok; // waits until all blocks are written
+    delete pool;
+  }
+  if (!ok)
+  {
+    err("Failed to write file %s!\n", pathDoxyDocsPM.data());
+  }
+  return ok;
 }
 
 bool PerlModGenerator::createOutputFile(QFile &f, const char *s)
@@ -8,7 +8,9 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <sys/wait.h>
+#include <sys/time.h>
 #include <errno.h>
 extern char **environ;
 #endif
@@ -24,13 +26,14 @@ extern char **environ;
 #include "portable.h"
 #ifndef NODEBUG
 #include "debug.h"
+#include "profiler.h"
 #endif
 //#include "doxygen.h"
 
 static double  g_sysElapsedTime;
 static QTime   g_time;
 
-int portable_system(const char *command,const char *args,bool commandHasConsole)
+static int runSystem(const char *command,const char *args,bool commandHasConsole)
 {
 
   if (command==0) return 1;
@@ -183,6 +186,20 @@ int portable_system(const char *command,const char *args,bool commandHasConsole)
 
 }
 
+int portable_system(const char *command,const char *args,bool commandHasConsole)
+{
+#ifndef NODEBUG
+  if (Profiler::isEnabled())
+  {
+    double start = Profiler::now();
+    int result = runSystem(command,args,commandHasConsole);
+    Profiler::addCommand(command,start,Profiler::now()-start);
+    return result;
+  }
+#endif
+  return runSystem(command,args,commandHasConsole);
+}
+
 uint portable_pid()
 {
   uint pid;
@@ -422,6 +439,21 @@ double portable_getSysElapsedTime()
   return g_sysElapsedTime;
 }
 
+double portable_getTimeStamp()
+{
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  static LARGE_INTEGER frequency;
+  if (frequency.QuadPart==0) QueryPerformanceFrequency(&frequency);
+  LARGE_INTEGER counter;
+  QueryPerformanceCounter(&counter);
+  return (double)counter.QuadPart*1000000.0/(double)frequency.QuadPart;
+#else
+  struct timeval tv;
+  gettimeofday(&tv,0);
+  return (double)tv.tv_sec*1000000.0+(double)tv.tv_usec;
+#endif
+}
+
 void portable_sleep(int ms)
 {
 #if defined(_WIN32) && !defined(__CYGWIN__)
@@ -448,4 +480,22 @@ bool portable_isAbsolutePath(const char *fileName)
   return false;
 }
 
+bool portable_link(const char *existingFile,const char *newFile)
+{
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  return CreateHardLinkA(newFile,existingFile,NULL)!=0;
+#else
+  return link(existingFile,newFile)==0;
+#endif
+}
+
+bool portable_setReadOnly(const char *fileName)
+{
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  return SetFileAttributesA(fileName,FILE_ATTRIBUTE_READONLY)!=0;
+#else
+  return chmod(fileName,0444)==0;
+#endif
+}
+
 
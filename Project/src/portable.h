@@ -33,8 +33,11 @@ int            portable_pclose(FILE *stream);
 void           portable_sysTimerStart();
 void           portable_sysTimerStop();
 double         portable_getSysElapsedTime();
+double         portable_getTimeStamp();
 void           portable_sleep(int ms);
 bool           portable_isAbsolutePath(const char *fileName);
+bool           portable_link(const char *existingFile,const char *newFile);
+bool           portable_setReadOnly(const char *fileName);
 
 extern "C" {
   void *         portable_iconv_open(const char* tocode, const char* fromcode);
@@ -24,6 +24,7 @@ void initPreprocessor();
 void cleanUpPreprocessor();
 void addSearchDir(const char *dir);
 void preprocessFile(const char *fileName,BufStr &input,BufStr &output);
+bool preReadInputFile(const char *fileName,BufStr &buf);
 void preFreeScanner();
 
 #endif
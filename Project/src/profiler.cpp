@@ -0,0 +1,418 @@
+/******************************************************************************
+ *
+ * Copyright (C) 1997-2015 by Dimitri van Heesch.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License is hereby
+ * granted. No representations are made about the suitability of this software
+ * for any purpose. It is provided "as is" without express or implied warranty.
+ * See the GNU General Public License for more details.
+ *
+ * Documents produced by Doxygen are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+ */
+
+#include <qlist.h>
+#include <qdict.h>
+#include <qfile.h>
+#include <qcache.h>
+#include <qmutex.h>
+#include <qvaluelist.h>
+
+#include "profiler.h"
+#include "portable.h"
+#include "message.h"
+#include "debug.h"
+#include "doxygen.h"
+#include "ftextstream.h"
+
+bool Profiler::s_enabled = FALSE;
+int  Profiler::s_counters[Profiler::NumCounters];
+
+/** A timed event. Events with a depth of -1 did not happen on the main thread. */
+struct ProfileEvent
+{
+  ProfileEvent(const char *n,const char *c,double s,int d)
+    : name(n), category(c), start(s), duration(0), depth(d) {}
+  QCString    name;
+  const char *category;
+  double      start;    // microseconds since Profiler::init()
+  double      duration; // microseconds
+  int         depth;
+};
+
+/** List of events sorted on start time */
+class ProfileEventList : public QList<ProfileEvent>
+{
+  private:
+    int compareValues(const ProfileEvent *e1,const ProfileEvent *e2) const
+    {
+      return e1->start<e2->start ? -1 : e1->start>e2->start ? 1 : 0;
+    }
+};
+
+/** Number of events and their total and maximum duration */
+struct ProfileTotal
+{
+  ProfileTotal(const char *n) : name(n), count(0), total(0), max(0) {}
+  void add(double duration)
+  {
+    count++;
+    total+=duration;
+    if (duration>max) max=duration;
+  }
+  QCString name;
+  int      count;
+  double   total;
+  double   max;
+};
+
+/** Totals in the order in which the names were first seen */
+class ProfileTotals
+{
+  public:
+    ProfileTotals() : m_dict(257) { m_list.setAutoDelete(TRUE); }
+    void add(const char *name,double duration)
+    {
+      ProfileTotal *t = m_dict.find(name);
+      if (t==0)
+      {
+        t = new ProfileTotal(name);
+        m_list.append(t);
+        m_dict.insert(name,t);
+      }
+      t->add(duration);
+    }
+    const QList<ProfileTotal> &list() const { return m_list; }
+  private:
+    QList<ProfileTotal> m_list;
+    QDict<ProfileTotal> m_dict;
+};
+
+static QList<ProfileEvent> g_events;        // all events, owned
+static QList<ProfileEvent> g_scopeStack;    // open scopes on the main thread
+static ProfileEvent       *g_phase = 0;     // open phase
+static QMutex              g_eventMutex;
+static double              g_startTime = 0;
+
+static const char *counterNames[Profiler::NumCounters] =
+{
+  "store_reads",
+  "docs_parsed",
+  "dot_jobs",
+  "external_commands",
+  "entry_loads",
+  "entries_loaded",
+  "code_link_cache_hits",
+  "code_link_cache_misses"
+};
+
+static const int numSlowestScopes = 20;
+
+//---------------------------------------------------------------------------
+
+static QCString escapeJson(const char *s)
+{
+  QCString result;
+  if (s==0) return result;
+  char c;
+  while ((c=*s++))
+  {
+    switch (c)
+    {
+      case '"':  result+="\\\""; break;
+      case '\\': result+="\\\\"; break;
+      case '\n': result+="\\n";  break;
+      case '\t': result+="\\t";  break;
+      default:
+        if ((unsigned char)c<0x20)
+        {
+          QCString hex;
+          hex.sprintf("\\u%04x",(unsigned char)c);
+          result+=hex;
+        }
+        else
+        {
+          result+=c;
+        }
+    }
+  }
+  return result;
+}
+
+static QCString ms(double us)
+{
+  QCString result;
+  result.sprintf("%.3f",us/1000.0);
+  return result;
+}
+
+static QCString us(double us)
+{
+  QCString result;
+  result.sprintf("%.0f",us);
+  return result;
+}
+
+static void addEventLocked(ProfileEvent *e)
+{
+  QMutexLocker lock(&g_eventMutex);
+  g_events.append(e);
+}
+
+//---------------------------------------------------------------------------
+
+void Profiler::init()
+{
+  s_enabled = Debug::isFlagSet(Debug::Profile);
+  g_events.setAutoDelete(TRUE);
+  int i;
+  for (i=0;i<NumCounters;i++) s_counters[i]=0;
+  g_startTime = portable_getTimeStamp();
+}
+
+double Profiler::now()
+{
+  return portable_getTimeStamp()-g_startTime;
+}
+
+void Profiler::beginPhase(const char *name)
+{
+  if (!s_enabled) return;
+  endPhase();
+  // phase names are progress messages, strip the trailing dots and newline
+  QCString n = QCString(name).stripWhiteSpace();
+  while (n.right(1)==".") n=n.left(n.length()-1);
+  g_phase = new ProfileEvent(n,"phase",now(),0);
+  addEventLocked(g_phase);
+}
+
+void Profiler::endPhase()
+{
+  if (!s_enabled || g_phase==0) return;
+  while (!g_scopeStack.isEmpty()) end(); // close scopes left open
+  g_phase->duration = now()-g_phase->start;
+  g_phase = 0;
+}
+
+void Profiler::begin(const char *name,const char *category)
+{
+  if (!s_enabled) return;
+  int depth = g_scopeStack.count()+(g_phase ? 1 : 0);
+  ProfileEvent *e = new ProfileEvent(name,category,now(),depth);
+  addEventLocked(e);
+  g_scopeStack.append(e);
+}
+
+void Profiler::end()
+{
+  if (!s_enabled || g_scopeStack.isEmpty()) return;
+  ProfileEvent *e = g_scopeStack.take(g_scopeStack.count()-1);
+  e->duration = now()-e->start;
+}
+
+void Profiler::addEvent(const char *name,const char *category,double start,double duration)
+{
+  if (!s_enabled) return;
+  ProfileEvent *e = new ProfileEvent(name,category,start,-1);
+  e->duration = duration;
+  addEventLocked(e);
+}
+
+void Profiler::addCommand(const char *command,double start,double duration)
+{
+  if (!s_enabled || command==0) return;
+  // use the base name of the command as the event name
+  QCString name = QCString(command).stripWhiteSpace();
+  if (name.at(0)=='"')
+  {
+    int q = name.find('"',1);
+    name = name.mid(1,q==-1 ? name.length()-1 : q-1);
+  }
+  int i = QMAX(name.findRev('/'),name.findRev('\\'));
+  if (i!=-1) name = name.mid(i+1);
+  i = name.findRev('.');
+  if (i>0) name = name.left(i);
+  ProfileEvent *e = new ProfileEvent(name,"external",start,-1);
+  e->duration = duration;
+  QMutexLocker lock(&g_eventMutex);
+  g_events.append(e);
+  s_counters[ExternalCommands]++;
+}
+
+//---------------------------------------------------------------------------
+
+static void writeTrace(const char *fileName,double endTime)
+{
+  QFile f(fileName);
+  if (!f.open(IO_WriteOnly))
+  {
+    err("Cannot open file %s for writing!\n",fileName);
+    return;
+  }
+  FTextStream t(&f);
+  t << "{\"traceEvents\":[" << endl;
+  t << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+       "\"args\":{\"name\":\"main\"}}";
+
+  // events of other threads may overlap, so they are spread over
+  // as many lanes as needed to keep the events in each lane disjoint.
+  ProfileEventList external;
+  QValueList<double> laneEnds;
+  QListIterator<ProfileEvent> eli(g_events);
+  ProfileEvent *e;
+  for (eli.toFirst();(e=eli.current());++eli)
+  {
+    if (e->depth==-1)
+    {
+      external.append(e);
+    }
+    else
+    {
+      t << "," << endl << "{\"name\":\"" << escapeJson(e->name)
+        << "\",\"cat\":\"" << e->category
+        << "\",\"ph\":\"X\",\"ts\":" << us(e->start)
+        << ",\"dur\":" << us(e->duration) << ",\"pid\":1,\"tid\":1}";
+    }
+  }
+  external.sort();
+  QListIterator<ProfileEvent> xli(external);
+  for (xli.toFirst();(e=xli.current());++xli)
+  {
+    uint lane=0;
+    QValueList<double>::Iterator it;
+    for (it=laneEnds.begin();it!=laneEnds.end() && *it>e->start;++it) lane++;
+    if (it==laneEnds.end())
+    {
+      laneEnds.append(e->start+e->duration);
+      t << "," << endl << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+        << (lane+2) << ",\"args\":{\"name\":\"external " << (lane+1) << "\"}}";
+    }
+    else
+    {
+      *it = e->start+e->duration;
+    }
+    t << "," << endl << "{\"name\":\"" << escapeJson(e->name)
+      << "\",\"cat\":\"" << e->category
+      << "\",\"ph\":\"X\",\"ts\":" << us(e->start)
+      << ",\"dur\":" << us(e->duration) << ",\"pid\":1,\"tid\":" << (lane+2) << "}";
+  }
+
+  t << "," << endl << "{\"name\":\"counters\",\"ph\":\"C\",\"ts\":" << us(endTime)
+    << ",\"pid\":1,\"args\":{";
+  int i;
+  for (i=0;i<Profiler::NumCounters;i++)
+  {
+    if (i>0) t << ",";
+    t << "\"" << counterNames[i] << "\":" << Profiler::counterValue((Profiler::Counter)i);
+  }
+  t << "}}" << endl;
+  t << "]}" << endl;
+}
+
+static void writeTotals(FTextStream &t,const char *label,const ProfileTotals &totals)
+{
+  t << "  \"" << label << "\": {";
+  QListIterator<ProfileTotal> tli(totals.list());
+  ProfileTotal *pt;
+  bool first=TRUE;
+  for (tli.toFirst();(pt=tli.current());++tli)
+  {
+    t << (first ? "" : ",") << endl;
+    t << "    \"" << escapeJson(pt->name) << "\": {\"count\": " << pt->count
+      << ", \"total_ms\": " << ms(pt->total)
+      << ", \"max_ms\": " << ms(pt->max) << "}";
+    first=FALSE;
+  }
+  t << endl << "  }";
+}
+
+static void writeSummary(const char *fileName,double endTime)
+{
+  QFile f(fileName);
+  if (!f.open(IO_WriteOnly))
+  {
+    err("Cannot open file %s for writing!\n",fileName);
+    return;
+  }
+  FTextStream t(&f);
+  ProfileTotals scopes;
+  ProfileTotals external;
+  ProfileEventList slowest;
+  QListIterator<ProfileEvent> eli(g_events);
+  ProfileEvent *e;
+
+  t << "{" << endl;
+  t << "  \"total_ms\": " << ms(endTime) << "," << endl;
+  t << "  \"phases\": [";
+  bool first=TRUE;
+  for (eli.toFirst();(e=eli.current());++eli)
+  {
+    if (e->depth==0)
+    {
+      t << (first ? "" : ",") << endl;
+      t << "    {\"name\": \"" << escapeJson(e->name)
+        << "\", \"start_ms\": " << ms(e->start)
+        << ", \"duration_ms\": " << ms(e->duration) << "}";
+      first=FALSE;
+    }
+    else if (e->depth==-1)
+    {
+      external.add(e->name,e->duration);
+    }
+    else
+    {
+      scopes.add(e->category,e->duration);
+      slowest.append(e);
+    }
+  }
+  t << endl << "  ]," << endl;
+  writeTotals(t,"scopes",scopes);
+  t << "," << endl;
+  writeTotals(t,"external",external);
+  t << "," << endl;
+
+  // the scopes that took longest, longest first
+  t << "  \"slowest_scopes\": [";
+  int i;
+  for (i=0;i<numSlowestScopes && !slowest.isEmpty();i++)
+  {
+    ProfileEvent *maxEvent = 0;
+    QListIterator<ProfileEvent> sli(slowest);
+    for (sli.toFirst();(e=sli.current());++sli)
+    {
+      if (maxEvent==0 || e->duration>maxEvent->duration) maxEvent=e;
+    }
+    slowest.removeRef(maxEvent);
+    t << (i==0 ? "" : ",") << endl;
+    t << "    {\"name\": \"" << escapeJson(maxEvent->name)
+      << "\", \"category\": \"" << maxEvent->category
+      << "\", \"duration_ms\": " << ms(maxEvent->duration) << "}";
+  }
+  t << endl << "  ]," << endl;
+
+  t << "  \"counters\": {" << endl;
+  for (i=0;i<Profiler::NumCounters;i++)
+  {
+    t << "    \"" << counterNames[i] << "\": "
+      << Profiler::counterValue((Profiler::Counter)i) << "," << endl;
+  }
+  QCache<LookupInfo> *cache = Doxygen::lookupCache;
+  t << "    \"lookup_cache_hits\": " << (cache ? cache->hits() : 0) << "," << endl;
+  t << "    \"lookup_cache_misses\": " << (cache ? cache->misses() : 0) << endl;
+  t << "  }" << endl;
+  t << "}" << endl;
+}
+
+void Profiler::writeReport(const char *outputDir)
+{
+  if (!s_enabled) return;
+  endPhase();
+  double endTime = now();
+  QCString dir = outputDir;
+  msg("Writing profile to %s/doxygen_profile.json and %s/doxygen_trace.json\n",
+      dir.data(),dir.data());
+  writeSummary(dir+"/doxygen_profile.json",endTime);
+  writeTrace(dir+"/doxygen_trace.json",endTime);
+}
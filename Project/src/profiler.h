@@ -0,0 +1,97 @@
+/******************************************************************************
+ *
+ * Copyright (C) 1997-2015 by Dimitri van Heesch.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License is hereby
+ * granted. No representations are made about the suitability of this software
+ * for any purpose. It is provided "as is" without express or implied warranty.
+ * See the GNU General Public License for more details.
+ *
+ * Documents produced by Doxygen are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+/** @brief Collects timings and counters of a doxygen run.
+ *
+ *  Profiling is enabled with the \c -d \c profile command line option.
+ *  At the end of the run a summary is written to \c doxygen_profile.json
+ *  and all recorded events to \c doxygen_trace.json in the output
+ *  directory. The latter uses the trace event format, so it can be
+ *  loaded in a trace viewer such as \c chrome://tracing.
+ *
+ *  Phases and scopes are recorded on the main thread only and nest
+ *  properly. External commands may be recorded from any thread.
+ */
+class Profiler
+{
+  public:
+    enum Counter
+    {
+      StoreReads,          //!< objects read back from the symbol store
+      DocsParsed,          //!< documentation blocks parsed
+      DotJobs,             //!< dot runs queued
+      ExternalCommands,    //!< external tools started
+      EntryLoads,          //!< entries read back from the entry storage
+      EntriesLoaded,       //!< distinct entries read back from the entry storage
+      CodeLinkCacheHits,   //!< symbol lookups of the code parser answered from its cache
+      CodeLinkCacheMisses, //!< symbol lookups of the code parser that were resolved
+      NumCounters
+    };
+
+    /** Enables the profiler if requested and starts the clock. */
+    static void init();
+    static bool isEnabled() { return s_enabled; }
+
+    /** Starts a top level phase, ending the previous one if still open. */
+    static void beginPhase(const char *name);
+    static void endPhase();
+
+    /** Starts a nested scope. Use ProfileScope rather than calling this directly. */
+    static void begin(const char *name,const char *category);
+    static void end();
+
+    /** Records an event that took place on any thread. Times are in
+     *  microseconds as returned by now().
+     */
+    static void addEvent(const char *name,const char *category,double start,double duration);
+
+    /** Records a run of external \a command. Can be called from any thread. */
+    static void addCommand(const char *command,double start,double duration);
+
+    static void count(Counter c,int n=1) { if (s_enabled) s_counters[c]+=n; }
+    static int counterValue(Counter c) { return s_counters[c]; }
+
+    /** Returns the number of microseconds since init() */
+    static double now();
+
+    /** Writes the report files to \a outputDir. */
+    static void writeReport(const char *outputDir);
+
+  private:
+    static bool s_enabled;
+    static int  s_counters[NumCounters];
+};
+
+/** Records the time spent in the enclosing block. */
+class ProfileScope
+{
+  public:
+    ProfileScope(const char *name,const char *category)
+      : m_active(Profiler::isEnabled())
+    {
+      if (m_active) Profiler::begin(name,category);
+    }
+   ~ProfileScope()
+    {
+      if (m_active) Profiler::end();
+    }
+  private:
+    bool m_active;
+};
+
+#endif
@@ -13,7 +13,9 @@
  *
  */
 #include <qdict.h>
+#include <qdir.h>
 #include <qfile.h>
+#include <qfileinfo.h>
 #include <qcstring.h>
 #include <qglobal.h>
 #include <string.h>
@@ -21,17 +23,123 @@
 #include "resourcemgr.h"
 #include "util.h"
 #include "version.h"
-#include "ftextstream.h"
 #include "message.h"
 #include "config.h"
+#include "doxygen.h"
+#include "index.h"
+#include "image.h"
+#include "portable.h"
+#include "md5.h"
 
 class ResourceMgr::Private
 {
   public:
-    Private() : resources(257) {}
+    Private() : resources(257), cacheInitialized(FALSE) {}
     QDict<Resource> resources;
+    bool            cacheInitialized;
+    QCString        cacheDir;
 };
 
+//----------------------------------------------------------------
+
+/** Reads the contents of \a fileName into \a data */
+static bool readFile(const QCString &fileName,QByteArray &data)
+{
+  QFile f(fileName);
+  if (!f.open(IO_ReadOnly)) return FALSE;
+  data.resize(f.size());
+  return f.size()==0 || f.readBlock(data.data(),f.size())==(int)f.size();
+}
+
+/** Writes \a data to \a fileName, unless the file already contains it.
+ *  An existing file is replaced rather than overwritten, as it may be
+ *  a link to the resource cache.
+ */
+static bool writeFile(const QCString &fileName,const char *data,uint size)
+{
+  if (fileHasContent(fileName,data,size)) return TRUE;
+  QFile::remove(fileName);
+  QFile f(fileName);
+  return f.open(IO_WriteOnly) && f.writeBlock(data,size)==(int)size;
+}
+
+/** Returns the name of the file that is produced for \a res */
+static QCString outputName(const Resource *res,const char *targetName)
+{
+  QCString n = res->name;
+  switch (res->type)
+  {
+    case Resource::Luminance: return n.left(n.length()-4)+".png"; // replace .lum by .png
+    case Resource::LumAlpha:  return n.left(n.length()-5)+".png"; // replace .luma by .png
+    default:                  return targetName;
+  }
+}
+
+/** Writes the resource \a res as file \a fileName, applying the color
+ *  and style settings of the configuration.
+ */
+static bool writeResource(const Resource *res,const QCString &fileName)
+{
+  switch (res->type)
+  {
+    case Resource::Verbatim:
+      return writeFile(fileName,(const char *)res->data,res->size);
+    case Resource::Luminance:
+    case Resource::LumAlpha:
+      {
+        uchar *p = (uchar*)res->data;
+        int width   = (p[0]<<8)+p[1];
+        int height  = (p[2]<<8)+p[3];
+        ColoredImage img(width,height,&p[4],
+                         res->type==Resource::LumAlpha ? &p[4+width*height] : 0,
+                         Config_getInt(HTML_COLORSTYLE_SAT),
+                         Config_getInt(HTML_COLORSTYLE_HUE),
+                         Config_getInt(HTML_COLORSTYLE_GAMMA));
+        return img.save(fileName);
+      }
+    case Resource::CSS:
+      {
+        QCString buf(res->size+1);
+        memcpy(buf.rawData(),res->data,res->size);
+        buf = replaceColorMarkers(buf);
+        if (qstrcmp(res->name,"navtree.css")==0)
+        {
+          buf = substitute(buf,"$width",QCString().setNum(Config_getInt(TREEVIEW_WIDTH))+"px");
+        }
+        else
+        {
+          buf = substitute(buf,"$doxygenversion",versionString);
+        }
+        return writeFile(fileName,buf.data(),buf.length());
+      }
+  }
+  return FALSE;
+}
+
+/** Returns the key of \a res in the resource cache. It covers the
+ *  resource data and all settings that are applied to it.
+ */
+static QCString cacheKey(const Resource *res)
+{
+  QCString settings;
+  settings.sprintf("%s\t%d\t%d\t%d\t%d\t%d\t%s\t%d\t",
+      versionString,
+      Config_getInt(HTML_COLORSTYLE_HUE),
+      Config_getInt(HTML_COLORSTYLE_SAT),
+      Config_getInt(HTML_COLORSTYLE_GAMMA),
+      Config_getInt(TREEVIEW_WIDTH),
+      Config_getBool(FAST_PNG_COMPRESSION),
+      res->name,res->type);
+  QByteArray key(settings.length()+res->size);
+  memcpy(key.data(),settings.data(),settings.length());
+  memcpy(key.data()+settings.length(),res->data,res->size);
+  uchar sig[16];
+  char name[33];
+  MD5Buffer((const unsigned char *)key.data(),key.size(),sig);
+  MD5SigToString(sig,name,33);
+  return name;
+}
+
 ResourceMgr &ResourceMgr::instance()
 {
   static ResourceMgr theInstance;
@@ -73,87 +181,149 @@ bool ResourceMgr::copyCategory(const char *categoryName,const char *targetDir) c
   return TRUE;
 }
 
+/** Returns the name of the file recording the size and digest of the
+ *  contents of the cache entry \a cacheFile.
+ */
+static QCString digestFileName(const QCString &cacheFile)
+{
+  return cacheFile+".md5";
+}
+
+/** Returns the size and MD5 digest of \a data as a string */
+static QCString contentDigest(const QByteArray &data)
+{
+  uchar sig[16];
+  char md5[33];
+  MD5Buffer((const unsigned char *)data.data(),data.size(),sig);
+  MD5SigToString(sig,md5,33);
+  QCString digest;
+  digest.sprintf("%u %s",data.size(),md5);
+  return digest;
+}
+
+/** Reads the cache entry \a cacheFile into \a data. Returns FALSE if the
+ *  entry does not exist or no longer matches the digest recorded for it.
+ */
+static bool readCacheEntry(const QCString &cacheFile,QByteArray &data)
+{
+  QByteArray recorded;
+  if (!readFile(cacheFile,data) || !readFile(digestFileName(cacheFile),recorded))
+  {
+    return FALSE;
+  }
+  QCString digest = contentDigest(data);
+  return recorded.size()==digest.length() &&
+         memcmp(recorded.data(),digest.data(),digest.length())==0;
+}
+
+/** Stores \a res in the resource cache as \a cacheFile. Other runs may use
+ *  the cache at the same time, so the files are written under temporary
+ *  names and renamed when complete. The output files are hard links to
+ *  the entries, so the entries are made read-only.
+ */
+static bool storeCacheEntry(const QCString &cacheFile,const Resource *res)
+{
+  QCString tmpFile;
+  tmpFile.sprintf("%s.%u.tmp",cacheFile.data(),portable_pid());
+  QCString tmpDigestFile = digestFileName(tmpFile);
+  bool ok = writeResource(res,tmpFile);
+  if (res->type==Resource::Luminance || res->type==Resource::LumAlpha)
+  {
+    // wait for the image, a failed one must not end up in the cache
+    ok = ImageManager::instance()->finish() && ok;
+  }
+  QByteArray data;
+  ok = ok && readFile(tmpFile,data);
+  if (ok)
+  {
+    QCString digest = contentDigest(data);
+    QDir dir;
+    // the digest goes first, so an entry never exists without one; another
+    // run storing the same entry at the same time writes the same files
+    ok = writeFile(tmpDigestFile,digest.data(),digest.length()) &&
+         portable_setReadOnly(tmpDigestFile) &&
+         portable_setReadOnly(tmpFile) &&
+         (dir.rename(tmpDigestFile,digestFileName(cacheFile)) ||
+          QFileInfo(digestFileName(cacheFile)).exists()) &&
+         (dir.rename(tmpFile,cacheFile) || QFileInfo(cacheFile).exists());
+  }
+  QFile::remove(tmpFile);
+  QFile::remove(tmpDigestFile);
+  return ok;
+}
+
+/** Returns the name of the file holding \a res in the resource cache and
+ *  reads its contents into \a data, storing the entry first if needed.
+ *  An entry that was modified since it was stored is replaced. Returns an
+ *  empty string if the cache cannot be used.
+ */
+static QCString cachedResource(const QCString &cacheDir,const Resource *res,
+                               const QCString &outName,QByteArray &data)
+{
+  QCString cacheFile = cacheDir+"/"+cacheKey(res)+"_"+outName;
+  if (readCacheEntry(cacheFile,data))
+  {
+    return cacheFile;
+  }
+  if (QFileInfo(cacheFile).exists())
+  {
+    warn_uncond("resource cache entry %s does not match its digest, storing it again\n",
+                cacheFile.data());
+    QFile::remove(cacheFile);
+    QFile::remove(digestFileName(cacheFile));
+  }
+  if (storeCacheEntry(cacheFile,res) && readCacheEntry(cacheFile,data))
+  {
+    return cacheFile;
+  }
+  return QCString();
+}
+
 bool ResourceMgr::copyResourceAs(const char *name,const char *targetDir,const char *targetName) const
 {
-  QCString pathName = QCString(targetDir)+"/"+targetName;
   const Resource *res = get(name);
-  if (res)
+  if (res==0)
   {
-    switch (res->type)
+    err("requested resource '%s' not compiled in!\n",name);
+    return FALSE;
+  }
+  if (!p->cacheInitialized)
+  {
+    p->cacheInitialized=TRUE;
+    p->cacheDir = Config_getString(RESOURCE_CACHE_DIR);
+    QDir dir;
+    if (!p->cacheDir.isEmpty() && !dir.exists(p->cacheDir) && !dir.mkdir(p->cacheDir))
     {
-      case Resource::Verbatim:
-        {
-          QFile f(pathName);
-          if (f.open(IO_WriteOnly) && f.writeBlock((const char *)res->data,res->size)==res->size)
-          {
-            return TRUE;
-          }
-        }
-        break;
-      case Resource::Luminance:
-        {
-          QCString n = name;
-          n = n.left(n.length()-4)+".png"; // replace .lum by .png
-          uchar *p = (uchar*)res->data;
-          int width   = (p[0]<<8)+p[1];
-          int height  = (p[2]<<8)+p[3];
-          ColoredImgDataItem images[2];
-          images[0].name    = n;
-          images[0].width   = width;
-          images[0].height  = height;
-          images[0].content = &p[4];
-          images[0].alpha   = 0;
-          images[1].name    = 0; // terminator
-          writeColoredImgData(targetDir,images);
-          return TRUE;
-        }
-        break;
-      case Resource::LumAlpha:
-        {
-          QCString n = name;
-          n = n.left(n.length()-5)+".png"; // replace .luma by .png
-          uchar *p = (uchar*)res->data;
-          int width   = (p[0]<<8)+p[1];
-          int height  = (p[2]<<8)+p[3];
-          ColoredImgDataItem images[2];
-          images[0].name    = n;
-          images[0].width   = width;
-          images[0].height  = height;
-          images[0].content = &p[4];
-          images[0].alpha   = &p[4+width*height];
-          images[1].name    = 0; // terminator
-          writeColoredImgData(targetDir,images);
-          return TRUE;
-        }
-        break;
-      case Resource::CSS:
-        {
-          QFile f(pathName);
-          if (f.open(IO_WriteOnly))
-          {
-            QCString buf(res->size+1);
-            memcpy(buf.rawData(),res->data,res->size);
-            FTextStream t(&f);
-            buf = replaceColorMarkers(buf);
-            if (qstrcmp(name,"navtree.css")==0)
-            {
-              t << substitute(buf,"$width",QCString().setNum(Config_getInt(TREEVIEW_WIDTH))+"px");
-            }
-            else
-            {
-              t << substitute(buf,"$doxygenversion",versionString);
-            }
-            return TRUE;
-          }
-        }
-        break;
+      err("Could not create resource cache directory %s\n",p->cacheDir.data());
+      p->cacheDir.resize(0);
+    }
+  }
+  QCString outName  = outputName(res,targetName);
+  QCString pathName = QCString(targetDir)+"/"+outName;
+  QCString cacheFile;
+  QByteArray data;
+  bool ok;
+  if (!p->cacheDir.isEmpty() &&
+      !(cacheFile=cachedResource(p->cacheDir,res,outName,data)).isEmpty())
+  {
+    // link the cached file into the output directory, or copy it if
+    // linking is not possible, e.g. because it is on another file system
+    ok = fileHasContent(pathName,data.data(),data.size());
+    if (!ok)
+    {
+      QFile::remove(pathName);
+      ok = portable_link(cacheFile,pathName) || writeFile(pathName,data.data(),data.size());
     }
   }
   else
   {
-    err("requested resource '%s' not compiled in!\n",name);
+    ok = writeResource(res,pathName);
   }
-  return FALSE;
+  if (res->type==Resource::Luminance || res->type==Resource::LumAlpha)
+  {
+    Doxygen::indexList->addImageFile(outName);
+  }
+  return ok;
 }
 
 bool ResourceMgr::copyResource(const char *name,const char *targetDir) const
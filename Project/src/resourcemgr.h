@@ -44,7 +44,10 @@ class ResourceMgr
     /** Copies a registered resource to a given target directory */
     bool copyResource(const char *name,const char *targetDir) const;
 
-    /** Copies a registered resource to a given target directory under a given target name */
+    /** Copies a registered resource to a given target directory under a given target name.
+     *  Images may still be written in the background when this returns, in which
+     *  case write errors are returned by ImageManager::finish().
+     */
     bool copyResourceAs(const char *name,const char *targetDir,const char *targetName) const;
 
     /** Gets the resource data as a C string */
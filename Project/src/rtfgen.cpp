@@ -2295,145 +2295,251 @@ bool isLeadBytes(int c)
 }
 
 
-// note: function is not reentrant!
-static void encodeForOutput(FTextStream &t,const char *s)
-{
-  if (s==0) return;
-  QCString encoding;
-  bool converted=FALSE;
-  int l = qstrlen(s);
-  static QByteArray enc;
-  if (l*4>(int)enc.size()) enc.resize(l*4); // worst case
-  encoding.sprintf("CP%s",theTranslator->trRTFansicp().data());
-  if (!encoding.isEmpty())
-  {
-    // convert from UTF-8 back to the output encoding
-    void *cd = portable_iconv_open(encoding,"UTF-8");
-    if (cd!=(void *)(-1))
+/** @brief Reads a file line by line using large block reads.
+ *
+ *  Each returned line ends with its newline (if any) and is
+ *  null terminated. It stays valid until the next call to readLine().
+ */
+class RTFLineReader
+{
+  public:
+    RTFLineReader(QFile &f) : m_file(f), m_size(blockSize), m_start(0), m_end(0),
+                              m_saved(0), m_eof(FALSE)
+    {
+      m_buf = (char *)malloc(m_size+1);
+    }
+   ~RTFLineReader()
     {
-      size_t iLeft=l;
-      size_t oLeft=enc.size();
-      char *inputPtr = (char*)s;
-      char *outputPtr = enc.data();
-      if (!portable_iconv(cd, &inputPtr, &iLeft, &outputPtr, &oLeft))
+      free(m_buf);
+    }
+    /** Returns the next line in \a line and its length in \a len,
+     *  or FALSE if the end of the file was reached.
+     */
+    bool readLine(char *&line,int &len)
+    {
+      if (m_saved) // restore the character overwritten by the terminator
       {
-        enc.resize(enc.size()-(unsigned int)oLeft);
-        converted=TRUE;
+        m_buf[m_start]=m_saved;
+        m_saved=0;
+      }
+      int searched=0,lineLen=-1;
+      while (lineLen==-1)
+      {
+        char *p = (char *)memchr(m_buf+m_start+searched,'\n',m_end-m_start-searched);
+        if (p)
+        {
+          lineLen = p-(m_buf+m_start)+1;
+        }
+        else if (m_eof)
+        {
+          lineLen = m_end-m_start;
+        }
+        else
+        {
+          searched = m_end-m_start;
+          fill();
+        }
       }
-      portable_iconv_close(cd);
+      if (lineLen==0) return FALSE; // end of file
+      // read ahead so atEnd() is known while the line is processed
+      if (m_start+lineLen==m_end && !m_eof) fill();
+      line = m_buf+m_start;
+      len  = lineLen;
+      m_start += lineLen;
+      m_saved = m_buf[m_start];
+      m_buf[m_start]='\0';
+      return TRUE;
     }
-  }
-  if (!converted) // if we did not convert anything, copy as is.
-  {
-    memcpy(enc.data(),s,l);
-    enc.resize(l);
-  }
-  uint i;
-  bool multiByte = FALSE;
-
-  for (i=0;i<enc.size();i++)
-  {
-    uchar c = (uchar)enc.at(i);
-
-    if (c>=0x80 || multiByte)
+    /** Returns TRUE if all lines have been read */
+    bool atEnd() const
     {
-      char esc[10];
-      sprintf(esc,"\\'%X",c);        // escape sequence for SBCS and DBCS(1st&2nd bytes).
-      t << esc;
-
-      if (!multiByte)
+      return m_start>=m_end && m_eof;
+    }
+  private:
+    static const int blockSize = 65536;
+    /** Moves the unread data to the start of the buffer and reads the next block */
+    void fill()
+    {
+      if (m_start>0)
       {
-        multiByte = isLeadBytes(c);  // It may be DBCS Codepages.
+        m_end-=m_start;
+        memmove(m_buf,m_buf+m_start,m_end);
+        m_start=0;
       }
-      else
+      if (m_end==m_size) // line longer than the buffer
       {
-        multiByte = FALSE;           // end of Double Bytes Character.
+        m_size+=blockSize;
+        m_buf = (char *)realloc(m_buf,m_size+1);
       }
+      int n = m_file.readBlock(m_buf+m_end,m_size-m_end);
+      if (n<=0) m_eof=TRUE; else m_end+=n;
     }
-    else
+    QFile &m_file;
+    char  *m_buf;
+    int    m_size;
+    int    m_start;
+    int    m_end;
+    char   m_saved;
+    bool   m_eof;
+};
+
+/** @brief Combines nested RTF files into a single file.
+ *
+ *  Every INCLUDETEXT field is replaced by the body of the file it refers to.
+ *  The files are read in large blocks and the output is buffered, so the
+ *  memory used does not depend on the number of pages. The text is converted
+ *  from UTF-8 to the code page of the output language as it is written.
+ */
+class RTFCombiner
+{
+  public:
+    RTFCombiner(QDir &d,QFile &out) : m_dir(d), m_out(out), m_pos(0), m_ok(TRUE)
     {
-      t << (char)c;
+      QCString encoding;
+      encoding.sprintf("CP%s",theTranslator->trRTFansicp().data());
+      m_cd = portable_iconv_open(encoding,"UTF-8");
+      int c;
+      for (c=0;c<256;c++) m_leadByte[c]=isLeadBytes(c);
+    }
+   ~RTFCombiner()
+    {
+      if (m_cd!=(void *)(-1)) portable_iconv_close(m_cd);
     }
-  }
-}
 
-/**
- * VERY brittle routine inline RTF's included by other RTF's.
- * it is recursive and ugly.
- */
-static bool preProcessFile(QDir &d,QCString &infName, FTextStream &t, bool bIncludeHeader=TRUE)
-{
-  QFile f(infName);
-  if (!f.open(IO_ReadOnly))
-  {
-    err("problems opening rtf file %s for reading\n",infName.data());
-    return FALSE;
-  }
+    /** Appends \a fileName to the output, including its RTF header if
+     *  \a includeHeader is TRUE. The file is removed afterwards.
+     *
+     *  This is VERY brittle. It works on OUR rtf files because the first
+     *  line before the body ALWAYS contains "{\comment begin body}".
+     */
+    bool combine(const QCString &fileName,bool includeHeader=TRUE)
+    {
+      QFile f(fileName);
+      if (!f.open(IO_ReadOnly))
+      {
+        err("problems opening rtf file %s for reading\n",fileName.data());
+        return FALSE;
+      }
+      RTFLineReader reader(f);
+      char *line;
+      int len;
 
-  const int maxLineLength = 10240;
-  static QCString lineBuf(maxLineLength);
+      // scan until find end of header
+      for (;;)
+      {
+        if (!reader.readLine(line,len))
+        {
+          err("read error in %s before end of RTF header!\n",fileName.data());
+          return FALSE;
+        }
+        if (strstr(line,"\\comment begin body")) break;
+        if (includeHeader) write(line,len);
+      }
 
-  // scan until find end of header
-  // this is EXTREEEEEEEMLY brittle.  It works on OUR rtf
-  // files because the first line before the body
-  // ALWAYS contains "{\comment begin body}"
-  int len;
-  for(;;)
-  {
-    lineBuf.resize(maxLineLength);
-    if ((len=f.readLine(lineBuf.rawData(),maxLineLength))==-1)
-    {
-      err("read error in %s before end of RTF header!\n",infName.data());
-      return FALSE;
+      while (reader.readLine(line,len))
+      {
+        char *inc = strstr(line,"INCLUDETEXT");
+        if (inc)
+        {
+          char *startName = strchr(inc,'"');
+          char *endName   = startName ? strchr(startName+1,'"') : 0;
+          QCString incName = endName ? QCString(startName+1).left(endName-startName-1) : QCString();
+          if (!combine(incName,FALSE)) return FALSE;
+        }
+        else if (includeHeader || !reader.atEnd())
+        {
+          write(line,len);
+        }
+        else // last line of included file, skip the final "}"
+        {
+          char *p = strrchr(line,'}');
+          if (p)
+            len = p-line;
+          else
+            err("Strange, the last char was not a '}'\n");
+          write(line,len);
+        }
+      }
+      f.close();
+      // remove temporary file
+      m_dir.remove(fileName);
+      return m_ok;
     }
-    lineBuf.resize(len+1);
-    if (lineBuf.find("\\comment begin body")!=-1) break;
-    if (bIncludeHeader) encodeForOutput(t,lineBuf.data());
-  }
 
+    /** Writes the remaining output, returns FALSE if writing failed */
+    bool flush()
+    {
+      if (m_pos>0 && m_out.writeBlock(m_buf,m_pos)!=m_pos) m_ok=FALSE;
+      m_pos=0;
+      return m_ok;
+    }
 
-  lineBuf.resize(maxLineLength);
-  while ((len=f.readLine(lineBuf.rawData(),maxLineLength))!=-1)
-  {
-    lineBuf.resize(len+1);
-    int pos;
-    if ((pos=lineBuf.find("INCLUDETEXT"))!=-1)
+  private:
+    void put(char c)
     {
-      int startNamePos  = lineBuf.find('"',pos)+1;
-      int endNamePos    = lineBuf.find('"',startNamePos);
-      QCString fileName = lineBuf.mid(startNamePos,endNamePos-startNamePos);
-      DBG_RTF(t << "{\\comment begin include " << fileName << "}" << endl)
-      if (!preProcessFile(d,fileName,t,FALSE)) return FALSE;
-      DBG_RTF(t << "{\\comment end include " << fileName << "}" << endl)
+      if (m_pos==outBufSize) flush();
+      m_buf[m_pos++]=c;
     }
-    else // no INCLUDETEXT on this line
+    /** Converts \a len characters of \a s and escapes non-ASCII characters */
+    void write(const char *s,int len)
     {
-      // elaborate hoopla to skip  the final "}" if we didn't include the
-      // headers
-      if (!f.atEnd() || bIncludeHeader)
+      const char *p = s;
+      int l = len;
+      if (m_cd!=(void *)(-1))
       {
-        encodeForOutput(t,lineBuf);
+        if (len*4>(int)m_enc.size()) m_enc.resize(len*4); // worst case
+        size_t iLeft=len;
+        size_t oLeft=m_enc.size();
+        char *inputPtr  = (char *)s;
+        char *outputPtr = m_enc.data();
+        if (!portable_iconv(m_cd, &inputPtr, &iLeft, &outputPtr, &oLeft))
+        {
+          p = m_enc.data();
+          l = m_enc.size()-(int)oLeft;
+        }
+        else // if we did not convert anything, copy as is.
+        {
+          portable_iconv(m_cd,0,0,0,0); // reset the conversion state
+        }
       }
-      else // last line of included file
+      static const char hex[] = "0123456789ABCDEF";
+      bool multiByte = FALSE;
+      int i;
+      for (i=0;i<l;i++)
       {
-        // null terminate at the last '}'
-        //char *str = strrchr(buffer,'}');
-        int pos = lineBuf.findRev('}');
-
-        if (pos != -1)
-          lineBuf.at(pos) = '\0';
+        uchar c = (uchar)p[i];
+        if (c>=0x80 || multiByte)
+        {
+          // escape sequence for SBCS and DBCS(1st&2nd bytes).
+          put('\\'); put('\'');
+          if (c>=0x10) put(hex[c>>4]);
+          put(hex[c&0xf]);
+          if (!multiByte)
+          {
+            multiByte = m_leadByte[c];  // It may be DBCS Codepages.
+          }
+          else
+          {
+            multiByte = FALSE;          // end of Double Bytes Character.
+          }
+        }
         else
-          err("Strange, the last char was not a '}'\n");
-        encodeForOutput(t,lineBuf);
+        {
+          put((char)c);
+        }
       }
     }
-    lineBuf.resize(maxLineLength);
-  }
-  f.close();
-  // remove temporary file
-  d.remove(infName);
-  return TRUE;
-}
+
+    static const int outBufSize = 65536;
+    QDir      &m_dir;
+    QFile     &m_out;
+    void      *m_cd;
+    bool       m_leadByte[256];
+    QByteArray m_enc;
+    char       m_buf[outBufSize];
+    int        m_pos;
+    bool       m_ok;
+};
 
 void RTFGenerator::startDotGraph()
 {
@@ -2609,9 +2715,9 @@ bool RTFGenerator::preProcessFileInplace(const char *path,const char *name)
     QDir::setCurrent(oldDir);
     return FALSE;
   }
-  FTextStream outt(&outf);
+  RTFCombiner combiner(thisDir,outf);
 
-  if (!preProcessFile(thisDir,mainRTFName,outt))
+  if (!combiner.combine(mainRTFName) || !combiner.flush())
   {
     // it failed, remove the temp file
     outf.close();
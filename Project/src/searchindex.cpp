@@ -37,19 +37,27 @@
 #include "filename.h"
 #include "membername.h"
 #include "resourcemgr.h"
-
-// file format: (all multi-byte values are stored in big endian format)
-//   4 byte header
-//   256*256*4 byte index (4 bytes)
-//   for each index entry: a zero terminated list of words 
-//   for each word: a \0 terminated string + 4 byte offset to the stats info
-//   padding bytes to align at 4 byte boundary
-//   for each word: the number of urls (4 bytes) 
-//               + for each url containing the word 8 bytes statistics
-//                 (4 bytes index to url string + 4 bytes frequency counter)
-//   for each url: a \0 terminated string
+#include "filewriter.h"
+
+// file format: (all 4 byte values are stored in big endian format, varints
+// use 7 bits per byte, lowest bits first, with the high bit set if more
+// bytes follow)
+//   4 byte header ("DOX2")
+//   the words sorted on byte value, in blocks of searchIndexBlockSize words
+//   for each word: varint length of the prefix shared with the previous word
+//               (0 for the first word of a block)
+//             + varint length of the rest of the word + the rest of the word
+//             + varint number of urls containing the word
+//             + for each url, sorted on url index: varint difference with
+//               the previous url index + varint frequency counter
+//   for each url: a \0 terminated name + a \0 terminated url
+//   for each url: 4 byte offset of its name
+//   for each block of words: 4 byte offset of the block (the skip index)
+//   4 byte number of words + 4 byte number of urls
+//   + 4 byte offset of the url offsets + 4 byte offset of the skip index
 
 const int numIndexEntries = 256*256;
+const uint searchIndexBlockSize = 64;
 
 //--------------------------------------------------------------------
 
@@ -244,167 +252,162 @@ void SearchIndex::addWord(const char *word,bool hiPriority)
   addWord(word,hiPriority,FALSE);
 }
 
-static void writeInt(QFile &f,int index)
+/** Writes the search index sequentially while keeping track of the
+ *  current offset in the file, so nothing needs to be computed up front.
+ */
+class SearchIndexWriter
+{
+  public:
+    SearchIndexWriter(QFile &f) : m_file(f), m_offset(0) {}
+    void writeByte(int c)
+    {
+      m_file.putch(c);
+      m_offset++;
+    }
+    void writeInt(uint v)
+    {
+      writeByte(v>>24);
+      writeByte((v>>16)&0xff);
+      writeByte((v>>8)&0xff);
+      writeByte(v&0xff);
+    }
+    void writeVarInt(uint v)
+    {
+      while (v>=0x80)
+      {
+        writeByte((v&0x7f)|0x80);
+        v>>=7;
+      }
+      writeByte(v);
+    }
+    void writeBytes(const char *s,uint len)
+    {
+      m_file.writeBlock(s,len);
+      m_offset+=len;
+    }
+    void writeString(const char *s)
+    {
+      writeBytes(s,qstrlen(s)+1);
+    }
+    uint offset() const { return m_offset; }
+  private:
+    QFile &m_file;
+    uint   m_offset;
+};
+
+static int compareIndexWords(const void *p1,const void *p2)
 {
-  f.putch(((uint)index)>>24);
-  f.putch((((uint)index)>>16)&0xff);
-  f.putch((((uint)index)>>8)&0xff);
-  f.putch(((uint)index)&0xff);
+  const IndexWord *w1 = *(const IndexWord **)p1;
+  const IndexWord *w2 = *(const IndexWord **)p2;
+  return qstrcmp(w1->word(),w2->word());
 }
 
-static void writeString(QFile &f,const char *s)
+static int compareURLInfos(const void *p1,const void *p2)
 {
-  const char *p = s;
-  while (*p) f.putch(*p++);
-  f.putch(0);
+  const URLInfo *u1 = *(const URLInfo **)p1;
+  const URLInfo *u2 = *(const URLInfo **)p2;
+  return u1->urlIdx-u2->urlIdx;
 }
 
-void SearchIndex::write(const char *fileName)
+static void writeIndexWord(SearchIndexWriter &w,const IndexWord *iw,const QCString &prevWord)
 {
-  int i;
-  int size=4; // for the header
-  size+=4*numIndexEntries; // for the index
-  int wordsOffset = size;
-  // first pass: compute the size of the wordlist
-  for (i=0;i<numIndexEntries;i++)
+  QCString word = iw->word();
+  // front coding: only store what differs from the previous word
+  uint prefixLen=0;
+  uint maxLen=QMIN(word.length(),prevWord.length());
+  while (prefixLen<maxLen && word.at(prefixLen)==prevWord.at(prefixLen)) prefixLen++;
+  w.writeVarInt(prefixLen);
+  w.writeVarInt(word.length()-prefixLen);
+  w.writeBytes(word.data()+prefixLen,word.length()-prefixLen);
+
+  // postings sorted on url index, stored as differences
+  uint numUrls = iw->urls().count();
+  URLInfo **urls = new URLInfo*[numUrls];
+  QIntDictIterator<URLInfo> uli(iw->urls());
+  URLInfo *ui;
+  uint i=0;
+  for (uli.toFirst();(ui=uli.current());++uli) urls[i++]=ui;
+  qsort(urls,numUrls,sizeof(URLInfo*),compareURLInfos);
+  w.writeVarInt(numUrls);
+  int prevIdx=0;
+  for (i=0;i<numUrls;i++)
   {
-    QList<IndexWord> *wlist = m_index[i];
-    if (!wlist->isEmpty())
-    {
-      QListIterator<IndexWord> iwi(*wlist);
-      IndexWord *iw;
-      for (iwi.toFirst();(iw=iwi.current());++iwi)
-      {
-        int ws = iw->word().length()+1; 
-        size+=ws+4; // word + url info list offset
-      }
-      size+=1; // zero list terminator
-    }
+    w.writeVarInt(urls[i]->urlIdx-prevIdx);
+    w.writeVarInt(urls[i]->freq);
+    prevIdx=urls[i]->urlIdx;
   }
+  delete[] urls;
+}
 
-  // second pass: compute the offsets in the index
-  int indexOffsets[numIndexEntries];
-  int offset=wordsOffset;
-  for (i=0;i<numIndexEntries;i++)
+void SearchIndex::write(const char *fileName)
+{
+  QFile f(fileName);
+  if (!f.open(IO_WriteOnly))
   {
-    QList<IndexWord> *wlist = m_index[i];
-    if (!wlist->isEmpty())
-    {
-      indexOffsets[i]=offset;
-      QListIterator<IndexWord> iwi(*wlist);
-      IndexWord *iw;
-      for (iwi.toFirst();(iw=iwi.current());++iwi)
-      {
-        offset+= iw->word().length()+1; 
-        offset+=4; // word + offset to url info array 
-      }
-      offset+=1; // zero list terminator
-    }
-    else
-    {
-      indexOffsets[i]=0;
-    }
+    err("Cannot open file %s for writing!\n",fileName);
+    return;
   }
-  int padding = size;
-  size = (size+3)&~3; // round up to 4 byte boundary
-  padding = size - padding;
-
-  //int statsOffset = size;
-  //IndexWord *iw;
-  int *wordStatOffsets = new int[m_words.count()];
-  
-  int count=0;
-
-  // third pass: compute offset to stats info for each word
+  SearchIndexWriter w(f);
+  w.writeBytes("DOX2",4);
+
+  // the buckets are ordered on the first two characters, so sorting the
+  // words within each bucket gives the words in sorted order
+  uint numWords = m_words.count();
+  uint numBlocks = (numWords+searchIndexBlockSize-1)/searchIndexBlockSize;
+  uint *blockOffsets = new uint[numBlocks];
+  uint count=0;
+  QCString prevWord;
+  int i;
   for (i=0;i<numIndexEntries;i++)
   {
     QList<IndexWord> *wlist = m_index[i];
     if (!wlist->isEmpty())
     {
+      uint numBucketWords = wlist->count();
+      IndexWord **words = new IndexWord*[numBucketWords];
       QListIterator<IndexWord> iwi(*wlist);
       IndexWord *iw;
-      for (iwi.toFirst();(iw=iwi.current());++iwi)
-      {
-        //printf("wordStatOffsets[%d]=%d\n",count,size);
-        wordStatOffsets[count++] = size;
-        size+=4+iw->urls().count()*8; // count + (url_index,freq) per url
-      }
-    }
-  }
-  int *urlOffsets = new int[m_urls.count()];
-  //int urlsOffset = size;
-  QIntDictIterator<URL> udi(m_urls);
-  URL *url;
-  for (udi.toFirst();(url=udi.current());++udi)
-  {
-    urlOffsets[udi.currentKey()]=size;
-    size+=url->name.length()+1+
-          url->url.length()+1;
-  }
-  //printf("Total size %x bytes (word=%x stats=%x urls=%x)\n",size,wordsOffset,statsOffset,urlsOffset);
-  QFile f(fileName);
-  if (f.open(IO_WriteOnly))
-  {
-    // write header
-    f.putch('D'); f.putch('O'); f.putch('X'); f.putch('S');
-    // write index
-    for (i=0;i<numIndexEntries;i++)
-    {
-      writeInt(f,indexOffsets[i]);
-    }
-    // write word lists
-    count=0;
-    for (i=0;i<numIndexEntries;i++)
-    {
-      QList<IndexWord> *wlist = m_index[i];
-      if (!wlist->isEmpty())
-      {
-        QListIterator<IndexWord> iwi(*wlist);
-        IndexWord *iw;
-        for (iwi.toFirst();(iw=iwi.current());++iwi)
-        {
-          writeString(f,iw->word());
-          writeInt(f,wordStatOffsets[count++]);
-        }
-        f.putch(0);
-      }
-    }
-    // write extra padding bytes
-    for (i=0;i<padding;i++) f.putch(0);
-    // write word statistics
-    for (i=0;i<numIndexEntries;i++)
-    {
-      QList<IndexWord> *wlist = m_index[i];
-      if (!wlist->isEmpty())
+      uint j=0;
+      for (iwi.toFirst();(iw=iwi.current());++iwi) words[j++]=iw;
+      qsort(words,numBucketWords,sizeof(IndexWord*),compareIndexWords);
+      for (j=0;j<numBucketWords;j++,count++)
       {
-        QListIterator<IndexWord> iwi(*wlist);
-        IndexWord *iw;
-        for (iwi.toFirst();(iw=iwi.current());++iwi)
+        if (count%searchIndexBlockSize==0) // start of a new block
         {
-          int numUrls = iw->urls().count();
-          writeInt(f,numUrls);
-          QIntDictIterator<URLInfo> uli(iw->urls());
-          URLInfo *ui;
-          for (uli.toFirst();(ui=uli.current());++uli)
-          {
-            writeInt(f,urlOffsets[ui->urlIdx]);
-            writeInt(f,ui->freq);
-          }
+          blockOffsets[count/searchIndexBlockSize]=w.offset();
+          prevWord.resize(0);
         }
+        writeIndexWord(w,words[j],prevWord);
+        prevWord=words[j]->word();
       }
+      delete[] words;
     }
-    // write urls
-    QIntDictIterator<URL> udi(m_urls);
-    URL *url;
-    for (udi.toFirst();(url=udi.current());++udi)
-    {
-      writeString(f,url->name);
-      writeString(f,url->url);
-    }
   }
 
+  // urls
+  uint numUrls = m_urlIndex+1;
+  uint *urlOffsets = new uint[numUrls];
+  uint u;
+  for (u=0;u<numUrls;u++)
+  {
+    URL *url = m_urls.find(u);
+    urlOffsets[u]=w.offset();
+    w.writeString(url ? url->name.data() : "");
+    w.writeString(url ? url->url.data()  : "");
+  }
+
+  // tables for random access and the trailer pointing to them
+  uint urlTableOffset = w.offset();
+  for (u=0;u<numUrls;u++) w.writeInt(urlOffsets[u]);
+  uint skipIndexOffset = w.offset();
+  for (u=0;u<numBlocks;u++) w.writeInt(blockOffsets[u]);
+  w.writeInt(numWords);
+  w.writeInt(numUrls);
+  w.writeInt(urlTableOffset);
+  w.writeInt(skipIndexOffset);
+
   delete[] urlOffsets;
-  delete[] wordStatOffsets;
+  delete[] blockOffsets;
 }
 
 
@@ -900,261 +903,416 @@ void createJavascriptSearchIndex()
   }
 }
 
-void writeJavascriptSearchIndex()
+/** Entries of a letter of a search index whose data is split over several
+ *  files, grouped on the character following the letter in their id.
+ */
+struct SearchShards
 {
-  int i;
-  // write index files
-  QCString searchDirName = Config_getString(HTML_OUTPUT)+"/search";
+  SearchShards(uint l) : letter(l), hasRest(FALSE) {}
+  uint     letter;  //!< the letter
+  QCString keys;    //!< the character of each shard, in order of the file names
+  bool     hasRest; //!< TRUE if there is a shard for the remaining entries
+};
 
-  for (i=0;i<NUM_SEARCH_INDICES;i++) // for each index
+/** Writes the url of \a d. To keep the files small, the url is written as
+ *  the length of the prefix it shares with the previous url of the file
+ *  and the remainder, see decodeSearchData() in search.js.
+ */
+static void writeSearchUrl(FTextStream &ti,Definition *d,QCString &lastUrl)
+{
+  QCString url = externalRef("../",d->getReference(),TRUE)+
+                 d->getOutputFileBase()+Doxygen::htmlFileExtension;
+  QCString anchor = d->anchor();
+  if (!anchor.isEmpty())
   {
-    SIntDict<SearchIndexList>::Iterator it(g_searchIndexInfo[i].symbolList);
-    SearchIndexList *sl;
-    int p=0;
-    for (it.toFirst();(sl=it.current());++it,++p) // for each letter
-    {
-      QCString baseName;
-      baseName.sprintf("%s_%x",g_searchIndexInfo[i].name.data(),p);
+    url+="#"+anchor;
+  }
+  // only share ASCII characters, so the length is the same in javascript
+  uint prefix=0;
+  while (prefix<url.length() && prefix<lastUrl.length() &&
+         url.at(prefix)==lastUrl.at(prefix) && (uchar)url.at(prefix)<0x80)
+  {
+    prefix++;
+  }
+  ti << prefix << ",'" << url.data()+prefix << "',";
+  lastUrl=url;
 
-      QCString fileName = searchDirName + "/"+baseName+".html";
-      QCString dataFileName = searchDirName + "/"+baseName+".js";
+  static bool extLinksInWindow = Config_getBool(EXT_LINKS_IN_WINDOW);
+  if (!extLinksInWindow || d->getReference().isEmpty())
+  {
+    ti << "1,";
+  }
+  else
+  {
+    ti << "0,";
+  }
+}
+
+static void writeSearchEntry(FTextStream &ti,SearchDefinitionList *dl,QCString &lastUrl)
+{
+  // format
+  // searchData[] = array of items
+  // searchData[x][0] = id
+  // searchData[x][1] = [ name + child1 + child2 + .. ]
+  // searchData[x][1][0] = name as shown
+  // searchData[x][1][y+1] = info for child y
+  // searchData[x][1][y+1][0] = length of the prefix shared with the previous url
+  // searchData[x][1][y+1][1] = rest of the url
+  // searchData[x][1][y+1][2] = 1 => target="_parent"
+  // searchData[x][1][y+1][3] = scope
+  Definition *d = dl->getFirst();
+
+  ti << "  ['" << dl->id() << "',['" << convertToXML(dl->name()) << "',[";
+
+  if (dl->count()==1) // item with a unique name
+  {
+    MemberDef  *md   = 0;
+    bool isMemberDef = d->definitionType()==Definition::TypeMember;
+    if (isMemberDef) md = (MemberDef*)d;
 
-      QFile outFile(fileName);
-      QFile dataOutFile(dataFileName);
-      if (outFile.open(IO_WriteOnly) && dataOutFile.open(IO_WriteOnly))
+    writeSearchUrl(ti,d,lastUrl);
+
+    // always write the scope, decodeSearchData() only expands complete children
+    QCString scope;
+    if (d->getOuterScope()!=Doxygen::globalScope)
+    {
+      scope = convertToXML(d->getOuterScope()->name());
+    }
+    else if (md)
+    {
+      FileDef *fd = md->getBodyDef();
+      if (fd==0) fd = md->getFileDef();
+      if (fd)
       {
+        scope = convertToXML(fd->localName());
+      }
+    }
+    ti << "'" << scope << "']]";
+  }
+  else // multiple items with the same name
+  {
+    QListIterator<Definition> di(*dl);
+    bool overloadedFunction = FALSE;
+    Definition *prevScope = 0;
+    int childCount=0;
+    for (di.toFirst();(d=di.current());)
+    {
+      ++di;
+      Definition *scope     = d->getOuterScope();
+      Definition *next      = di.current();
+      Definition *nextScope = 0;
+      MemberDef  *md        = 0;
+      bool isMemberDef = d->definitionType()==Definition::TypeMember;
+      if (isMemberDef) md = (MemberDef*)d;
+      if (next) nextScope = next->getOuterScope();
+
+      if (childCount>0)
+      {
+        ti << "],[";
+      }
+      writeSearchUrl(ti,d,lastUrl);
+
+      bool found=FALSE;
+      overloadedFunction = ((prevScope!=0 && scope==prevScope) ||
+          (scope && scope==nextScope)
+          ) && md && 
+        (md->isFunction() || md->isSlot());
+      QCString prefix;
+      if (md) prefix=convertToXML(md->localName());
+      if (overloadedFunction) // overloaded member function
+      {
+        prefix+=convertToXML(md->argsString()); 
+        // show argument list to disambiguate overloaded functions
+      }
+      else if (md) // unique member function
+      {
+        prefix+="()"; // only to show it is a function
+      }
+      QCString name;
+      if (d->definitionType()==Definition::TypeClass)
+      {
+        name = convertToXML(((ClassDef*)d)->displayName());
+        found = TRUE;
+      }
+      else if (d->definitionType()==Definition::TypeNamespace)
+      {
+        name = convertToXML(((NamespaceDef*)d)->displayName());
+        found = TRUE;
+      }
+      else if (scope==0 || scope==Doxygen::globalScope) // in global scope
+      {
+        if (md)
         {
-          FTextStream t(&outFile);
-
-          t << "<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML 1.0 Transitional//EN\""
-            " \"http://www.w3.org/TR/xhtml1/DTD/xhtml1-transitional.dtd\">" << endl;
-          t << "<html><head><title></title>" << endl;
-          t << "<meta http-equiv=\"Content-Type\" content=\"text/xhtml;charset=UTF-8\"/>" << endl;
-          t << "<meta name=\"generator\" content=\"Doxygen " << versionString << "\"/>" << endl;
-          t << "<link rel=\"stylesheet\" type=\"text/css\" href=\"search.css\"/>" << endl;
-          t << "<script type=\"text/javascript\" src=\"" << baseName << ".js\"></script>" << endl;
-          t << "<script type=\"text/javascript\" src=\"search.js\"></script>" << endl;
-          t << "</head>" << endl;
-          t << "<body class=\"SRPage\">" << endl;
-          t << "<div id=\"SRIndex\">" << endl;
-          t << "<div class=\"SRStatus\" id=\"Loading\">" << theTranslator->trLoading() << "</div>" << endl;
-          t << "<div id=\"SRResults\"></div>" << endl; // here the results will be inserted
-          t << "<script type=\"text/javascript\"><!--" << endl;
-          t << "createResults();" << endl; // this function will insert the results
-          t << "--></script>" << endl;
-          t << "<div class=\"SRStatus\" id=\"Searching\">" 
-            << theTranslator->trSearching() << "</div>" << endl;
-          t << "<div class=\"SRStatus\" id=\"NoMatches\">"
-            << theTranslator->trNoMatches() << "</div>" << endl;
-
-          t << "<script type=\"text/javascript\"><!--" << endl;
-          t << "document.getElementById(\"Loading\").style.display=\"none\";" << endl;
-          t << "document.getElementById(\"NoMatches\").style.display=\"none\";" << endl;
-          t << "var searchResults = new SearchResults(\"searchResults\");" << endl;
-          t << "searchResults.Search();" << endl;
-          t << "--></script>" << endl;
-          t << "</div>" << endl; // SRIndex
-          t << "</body>" << endl;
-          t << "</html>" << endl;
-        }
-        FTextStream ti(&dataOutFile);
-
-        ti << "var searchData=" << endl;
-        // format
-        // searchData[] = array of items
-        // searchData[x][0] = id
-        // searchData[x][1] = [ name + child1 + child2 + .. ]
-        // searchData[x][1][0] = name as shown
-        // searchData[x][1][y+1] = info for child y
-        // searchData[x][1][y+1][0] = url
-        // searchData[x][1][y+1][1] = 1 => target="_parent"
-        // searchData[x][1][y+1][2] = scope
-
-        ti << "[" << endl;
-        bool firstEntry=TRUE;
-
-        SDict<SearchDefinitionList>::Iterator li(*sl);
-        SearchDefinitionList *dl;
-        int itemCount=0;
-        for (li.toFirst();(dl=li.current());++li)
-        {
-          Definition *d = dl->getFirst();
-
-          if (!firstEntry)
+          FileDef *fd = md->getBodyDef();
+          if (fd==0) fd = md->getFileDef();
+          if (fd)
           {
-            ti << "," << endl;
+            if (!prefix.isEmpty()) prefix+=":&#160;";
+            name = prefix + convertToXML(fd->localName());
+            found = TRUE;
           }
-          firstEntry=FALSE;
+        }
+      }
+      else if (md && (md->getClassDef() || md->getNamespaceDef())) 
+        // member in class or namespace scope
+      {
+        SrcLangExt lang = md->getLanguage();
+        name = convertToXML(d->getOuterScope()->qualifiedName()) 
+          + getLanguageSpecificSeparator(lang) + prefix;
+        found = TRUE;
+      }
+      else if (scope) // some thing else? -> show scope
+      {
+        name = prefix + convertToXML(scope->name());
+        found = TRUE;
+      }
+      if (!found) // fallback
+      {
+        name = prefix + "("+theTranslator->trGlobalNamespace()+")";
+      }
 
-          ti << "  ['" << dl->id() << "',['" << convertToXML(dl->name()) << "',[";
+      ti << "'" << name << "'";
 
-          if (dl->count()==1) // item with a unique name
-          {
-            MemberDef  *md   = 0;
-            bool isMemberDef = d->definitionType()==Definition::TypeMember;
-            if (isMemberDef) md = (MemberDef*)d;
-            QCString anchor = d->anchor();
-
-            ti << "'" << externalRef("../",d->getReference(),TRUE)
-              << d->getOutputFileBase() << Doxygen::htmlFileExtension;
-            if (!anchor.isEmpty())
-            {
-              ti << "#" << anchor;
-            }
-            ti << "',";
+      prevScope = scope;
+      childCount++;
+    }
 
-            static bool extLinksInWindow = Config_getBool(EXT_LINKS_IN_WINDOW);
-            if (!extLinksInWindow || d->getReference().isEmpty())
-            {
-              ti << "1,";
-            }
-            else
-            {
-              ti << "0,";
-            }
+    ti << "]]";
+  }
+  ti << "]";
+}
 
-            if (d->getOuterScope()!=Doxygen::globalScope)
-            {
-              ti << "'" << convertToXML(d->getOuterScope()->name()) << "'";
-            }
-            else if (md)
-            {
-              FileDef *fd = md->getBodyDef();
-              if (fd==0) fd = md->getFileDef();
-              if (fd)
-              {
-                ti << "'" << convertToXML(fd->localName()) << "'";
-              }
-            }
-            else
-            {
-              ti << "''";
-            }
-            ti << "]]";
-          }
-          else // multiple items with the same name
-          {
-            QListIterator<Definition> di(*dl);
-            bool overloadedFunction = FALSE;
-            Definition *prevScope = 0;
-            int childCount=0;
-            for (di.toFirst();(d=di.current());)
-            {
-              ++di;
-              Definition *scope     = d->getOuterScope();
-              Definition *next      = di.current();
-              Definition *nextScope = 0;
-              MemberDef  *md        = 0;
-              bool isMemberDef = d->definitionType()==Definition::TypeMember;
-              if (isMemberDef) md = (MemberDef*)d;
-              if (next) nextScope = next->getOuterScope();
-              QCString anchor = d->anchor();
-
-              if (childCount>0)
-              {
-                ti << "],[";
-              }
-              ti << "'" << externalRef("../",d->getReference(),TRUE)
-                << d->getOutputFileBase() << Doxygen::htmlFileExtension;
-              if (!anchor.isEmpty())
-              {
-                ti << "#" << anchor;
-              }
-              ti << "',";
-
-              static bool extLinksInWindow = Config_getBool(EXT_LINKS_IN_WINDOW);
-              if (!extLinksInWindow || d->getReference().isEmpty())
-              {
-                ti << "1,";
-              }
-              else
-              {
-                ti << "0,";
-              }
-              bool found=FALSE;
-              overloadedFunction = ((prevScope!=0 && scope==prevScope) ||
-                  (scope && scope==nextScope)
-                  ) && md && 
-                (md->isFunction() || md->isSlot());
-              QCString prefix;
-              if (md) prefix=convertToXML(md->localName());
-              if (overloadedFunction) // overloaded member function
-              {
-                prefix+=convertToXML(md->argsString()); 
-                // show argument list to disambiguate overloaded functions
-              }
-              else if (md) // unique member function
-              {
-                prefix+="()"; // only to show it is a function
-              }
-              QCString name;
-              if (d->definitionType()==Definition::TypeClass)
-              {
-                name = convertToXML(((ClassDef*)d)->displayName());
-                found = TRUE;
-              }
-              else if (d->definitionType()==Definition::TypeNamespace)
-              {
-                name = convertToXML(((NamespaceDef*)d)->displayName());
-                found = TRUE;
-              }
-              else if (scope==0 || scope==Doxygen::globalScope) // in global scope
-              {
-                if (md)
-                {
-                  FileDef *fd = md->getBodyDef();
-                  if (fd==0) fd = md->getFileDef();
-                  if (fd)
-                  {
-                    if (!prefix.isEmpty()) prefix+=":&#160;";
-                    name = prefix + convertToXML(fd->localName());
-                    found = TRUE;
-                  }
-                }
-              }
-              else if (md && (md->getClassDef() || md->getNamespaceDef())) 
-                // member in class or namespace scope
-              {
-                SrcLangExt lang = md->getLanguage();
-                name = convertToXML(d->getOuterScope()->qualifiedName()) 
-                  + getLanguageSpecificSeparator(lang) + prefix;
-                found = TRUE;
-              }
-              else if (scope) // some thing else? -> show scope
-              {
-                name = prefix + convertToXML(scope->name());
-                found = TRUE;
-              }
-              if (!found) // fallback
-              {
-                name = prefix + "("+theTranslator->trGlobalNamespace()+")";
-              }
-
-              ti << "'" << name << "'";
-
-              prevScope = scope;
-              childCount++;
-            }
+/** Writes the entries \a entries[first..first+count-1] to data file \a fileName. */
+static void writeSearchDataFile(FileWriterPool *pool,const QCString &fileName,
+                                QList<SearchDefinitionList> &entries,uint first,uint count)
+{
+  PooledOutputFile f(fileName,pool);
+  if (!f.open())
+  {
+    err("Failed to open file '%s' for writing...\n",fileName.data());
+    return;
+  }
+  FTextStream &ti = f.stream();
+  ti << "searchData=searchData.concat(" << endl;
+  ti << "[" << endl;
+  QCString lastUrl;
+  uint i;
+  for (i=first;i<first+count;i++)
+  {
+    if (i>first)
+    {
+      ti << "," << endl;
+    }
+    writeSearchEntry(ti,entries.at(i),lastUrl);
+  }
+  if (count>0)
+  {
+    ti << endl;
+  }
+  ti << "]);" << endl;
+}
 
-            ti << "]]";
-          }
-          ti << "]";
-          itemCount++;
-        }
-        if (!firstEntry)
-        {
-          ti << endl;
-        }
+/** Writes the entries \a entries to one or more data files, each holding
+ *  at most \a shardSize entries. The names of the files are added to \a dataFiles.
+ */
+static void writeSearchDataFiles(FileWriterPool *pool,const QCString &searchDirName,
+                                 const QCString &baseName,QList<SearchDefinitionList> &entries,
+                                 uint shardSize,QStrList &dataFiles)
+{
+  uint count = entries.count();
+  if (shardSize==0 || count<=shardSize)
+  {
+    writeSearchDataFile(pool,searchDirName+"/"+baseName+".js",entries,0,count);
+    dataFiles.append(baseName+".js");
+  }
+  else
+  {
+    uint first,part=0;
+    for (first=0;first<count;first+=shardSize,part++)
+    {
+      QCString partName;
+      partName.sprintf("%s_%x.js",baseName.data(),part);
+      writeSearchDataFile(pool,searchDirName+"/"+partName,entries,first,QMIN(shardSize,count-first));
+      dataFiles.append(partName);
+    }
+  }
+}
 
-        ti << "];" << endl;
+/** Writes the results page \a baseName.html loading the data files \a dataFiles. */
+static void writeSearchResultsPage(FileWriterPool *pool,const QCString &searchDirName,
+                                   const QCString &baseName,QStrList &dataFiles)
+{
+  QCString fileName = searchDirName + "/"+baseName+".html";
+  PooledOutputFile f(fileName,pool);
+  if (!f.open())
+  {
+    err("Failed to open file '%s' for writing...\n",fileName.data());
+    return;
+  }
+  FTextStream &t = f.stream();
+
+  t << "<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML 1.0 Transitional//EN\""
+    " \"http://www.w3.org/TR/xhtml1/DTD/xhtml1-transitional.dtd\">" << endl;
+  t << "<html><head><title></title>" << endl;
+  t << "<meta http-equiv=\"Content-Type\" content=\"text/xhtml;charset=UTF-8\"/>" << endl;
+  t << "<meta name=\"generator\" content=\"Doxygen " << versionString << "\"/>" << endl;
+  t << "<link rel=\"stylesheet\" type=\"text/css\" href=\"search.css\"/>" << endl;
+  t << "<script type=\"text/javascript\"><!--" << endl;
+  t << "var searchData=[];" << endl;
+  t << "--></script>" << endl;
+  const char *dataFile;
+  for (dataFile=dataFiles.first();dataFile;dataFile=dataFiles.next())
+  {
+    t << "<script type=\"text/javascript\" src=\"" << dataFile << "\"></script>" << endl;
+  }
+  t << "<script type=\"text/javascript\" src=\"search.js\"></script>" << endl;
+  t << "</head>" << endl;
+  t << "<body class=\"SRPage\">" << endl;
+  t << "<div id=\"SRIndex\">" << endl;
+  t << "<div class=\"SRStatus\" id=\"Loading\">" << theTranslator->trLoading() << "</div>" << endl;
+  t << "<div id=\"SRResults\"></div>" << endl; // here the results will be inserted
+  t << "<script type=\"text/javascript\"><!--" << endl;
+  t << "createResults();" << endl; // this function will insert the results
+  t << "--></script>" << endl;
+  t << "<div class=\"SRStatus\" id=\"Searching\">" 
+    << theTranslator->trSearching() << "</div>" << endl;
+  t << "<div class=\"SRStatus\" id=\"NoMatches\">"
+    << theTranslator->trNoMatches() << "</div>" << endl;
+
+  t << "<script type=\"text/javascript\"><!--" << endl;
+  t << "document.getElementById(\"Loading\").style.display=\"none\";" << endl;
+  t << "document.getElementById(\"NoMatches\").style.display=\"none\";" << endl;
+  t << "var searchResults = new SearchResults(\"searchResults\");" << endl;
+  t << "searchResults.Search();" << endl;
+  t << "--></script>" << endl;
+  t << "</div>" << endl; // SRIndex
+  t << "</body>" << endl;
+  t << "</html>" << endl;
+}
 
-      }
-      else
-      {
-        err("Failed to open file '%s' for writing...\n",fileName.data());
-      }
+/** Returns the shard of the search index entry with id \a id: the character
+ *  following the first letter of the id, or 0 if the entry belongs to the
+ *  shard with the remaining entries. Must match searchShard() in search.js.
+ */
+static char searchShardKey(const QCString &id)
+{
+  if (id.isEmpty()) return 0;
+  uint pos=1;
+  uchar c = (uchar)id.at(0);
+  if (c=='_') // encoded character, see searchId()
+  {
+    pos=3;
+  }
+  else if (c>=0x80) // skip the rest of the UTF-8 sequence
+  {
+    while (pos<id.length() && ((uchar)id.at(pos)&0xC0)==0x80) pos++;
+  }
+  if (pos>=id.length()) return 0;
+  c = (uchar)id.at(pos);
+  return c<0x80 ? (char)c : 0;
+}
+
+/** Writes the data files and results pages of the letter with entries \a sl.
+ *  When the letter has more than \a shardSize entries the entries are split
+ *  in shards and \a shards is returned, describing them. Otherwise 0 is returned.
+ */
+static SearchShards *writeSearchLetter(FileWriterPool *pool,const QCString &searchDirName,
+                                       const QCString &baseName,SearchIndexList *sl,uint shardSize)
+{
+  QList<SearchDefinitionList> entries;
+  SDict<SearchDefinitionList>::Iterator li(*sl);
+  SearchDefinitionList *dl;
+  for (li.toFirst();(dl=li.current());++li)
+  {
+    entries.append(dl);
+  }
+
+  QStrList dataFiles;
+  if (shardSize==0 || entries.count()<=shardSize)
+  {
+    writeSearchDataFiles(pool,searchDirName,baseName,entries,shardSize,dataFiles);
+    writeSearchResultsPage(pool,searchDirName,baseName,dataFiles);
+    return 0;
+  }
+
+  // group the entries on the second character of their id,
+  // keeping the sorted order within each group
+  QList<SearchDefinitionList> *groups[128];
+  int i;
+  for (i=0;i<128;i++) groups[i]=0;
+  QListIterator<SearchDefinitionList> eli(entries);
+  for (eli.toFirst();(dl=eli.current());++eli)
+  {
+    int key = searchShardKey(dl->id());
+    if (groups[key]==0) groups[key] = new QList<SearchDefinitionList>;
+    groups[key]->append(dl);
+  }
+
+  SearchShards *shards = new SearchShards(sl->letter());
+  int shard=0;
+  for (i=0;i<128;i++)
+  {
+    if (groups[i]==0) continue;
+    QCString shardName;
+    if (i==0)
+    {
+      shardName = baseName+"_r";
+      shards->hasRest = TRUE;
+    }
+    else
+    {
+      shardName.sprintf("%s_%x",baseName.data(),shard++);
+      shards->keys+=(char)i;
+    }
+    QStrList shardFiles;
+    writeSearchDataFiles(pool,searchDirName,shardName,*groups[i],shardSize,shardFiles);
+    writeSearchResultsPage(pool,searchDirName,shardName,shardFiles);
+    const char *dataFile;
+    for (dataFile=shardFiles.first();dataFile;dataFile=shardFiles.next())
+    {
+      dataFiles.append(dataFile);
     }
+    delete groups[i];
   }
+  // the page for the letter as a whole, used when only one character is typed
+  writeSearchResultsPage(pool,searchDirName,baseName,dataFiles);
+  return shards;
+}
+
+void writeJavascriptSearchIndex()
+{
+  int i;
+  // write index files
+  QCString searchDirName = Config_getString(HTML_OUTPUT)+"/search";
+  uint shardSize = (uint)Config_getInt(SEARCH_SHARD_SIZE);
+
+  // the files are generated in order, and written to disk by a pool
+  // of worker threads while the next one is being generated.
+  FileWriterPool *pool = 0;
+  int numThreads = getNumProcThreads();
+  if (numThreads>1)
+  {
+    pool = new FileWriterPool(numThreads,numThreads*4);
+  }
+
+  QList<SearchShards> shards[NUM_SEARCH_INDICES];
+  for (i=0;i<NUM_SEARCH_INDICES;i++) // for each index
+  {
+    shards[i].setAutoDelete(TRUE);
+    SIntDict<SearchIndexList>::Iterator it(g_searchIndexInfo[i].symbolList);
+    SearchIndexList *sl;
+    int p=0;
+    for (it.toFirst();(sl=it.current());++it,++p) // for each letter
+    {
+      QCString baseName;
+      baseName.sprintf("%s_%x",g_searchIndexInfo[i].name.data(),p);
+      SearchShards *ls = writeSearchLetter(pool,searchDirName,baseName,sl,shardSize);
+      if (ls) shards[i].append(ls);
+    }
+  }
+
+  // wait for the pending files to be written
+  delete pool;
 
   {
     QFile f(searchDirName+"/searchdata.js");
@@ -1201,6 +1359,40 @@ void writeJavascriptSearchIndex()
       }
       if (!first) t << "\n";
       t << "};" << endl << endl;
+      // for letters that are split by their second character:
+      // the characters with a shard and whether there is a shard for the rest
+      t << "var indexSectionShards =" << endl;
+      t << "{" << endl;
+      first=TRUE;
+      j=0;
+      for (i=0;i<NUM_SEARCH_INDICES;i++)
+      {
+        if (g_searchIndexInfo[i].symbolList.count()>0)
+        {
+          if (shards[i].count()>0)
+          {
+            if (!first) t << "," << endl;
+            t << "  " << j << ": {";
+            QListIterator<SearchShards> sli(shards[i]);
+            SearchShards *ls;
+            bool firstLetter=TRUE;
+            for (sli.toFirst();(ls=sli.current());++sli)
+            {
+              if (!firstLetter) t << ",";
+              QCString letter = QString(QChar(ls->letter)).utf8();
+              if (letter=="\"" || letter=="\\") letter.prepend("\\");
+              t << "\"" << letter << "\":[\"" << ls->keys << "\","
+                << (ls->hasRest ? 1 : 0) << "]";
+              firstLetter=FALSE;
+            }
+            t << "}";
+            first=FALSE;
+          }
+          j++;
+        }
+      }
+      if (!first) t << "\n";
+      t << "};" << endl << endl;
       t << "var indexSectionLabels =" << endl;
       t << "{" << endl;
       first=TRUE;
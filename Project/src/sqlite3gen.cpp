@@ -37,8 +37,15 @@
 #include "groupdef.h"
 #include "pagedef.h"
 #include "dirdef.h"
+#include "membername.h"
 
 #include <qdir.h>
+#include <qdict.h>
+#include <qdatetime.h>
+#include <qthread.h>
+#include <qmutex.h>
+#include <qwaitcondition.h>
+#include <qqueue.h>
 #include <string.h>
 #include <sqlite3.h>
 
@@ -53,9 +60,7 @@ const char * schema_queries[][2] = {
       "\tlocal        INTEGER NOT NULL,\n"
       "\tid_src       INTEGER NOT NULL,  -- File id of the includer.\n"
       "\tid_dst       INTEGER NOT NULL   -- File id of the includee.\n"
-      ");\n"
-    "CREATE UNIQUE INDEX idx_includes ON includes\n"
-      "\t(local, id_src, id_dst);"
+      ");"
   },
   { "innerclass",
     "CREATE TABLE IF NOT EXISTS innerclass (\n"
@@ -85,9 +90,7 @@ const char * schema_queries[][2] = {
       "\tid_file      INTEGER NOT NULL, -- file where the reference is happening.\n"
       "\tline         INTEGER NOT NULL, -- line where the reference is happening.\n"
       "\tcolumn       INTEGER NOT NULL  -- column where the reference is happening.\n"
-      ");\n"
-    "CREATE UNIQUE INDEX idx_xrefs ON xrefs\n"
-      "\t(refid_src, refid_dst, id_file, line, column);"
+      ");"
   },
   { "memberdef",
     "CREATE TABLE IF NOT EXISTS memberdef (\n"
@@ -198,10 +201,32 @@ const char * schema_queries[][2] = {
   }
 };
 
+// indexes are created after all rows have been loaded
+const char * index_queries[] = {
+  "CREATE UNIQUE INDEX IF NOT EXISTS idx_includes ON includes\n"
+    "\t(local, id_src, id_dst);",
+  "CREATE UNIQUE INDEX IF NOT EXISTS idx_xrefs ON xrefs\n"
+    "\t(refid_src, refid_dst, id_file, line, column);"
+};
+
 //////////////////////////////////////////////////////
+/** Value bound to a statement parameter */
+struct SqlValue
+{
+  SqlValue() : isNull(TRUE), isText(FALSE), intValue(0) {}
+  bool     isNull;
+  bool     isText;
+  int      intValue;
+  QCString textValue;
+};
+
+/** Prepared statement together with the row currently being bound */
 struct SqlStmt {
   const char   *query;
   sqlite3_stmt *stmt;
+  int           numParams;
+  QDict<int>   *paramIndex; // parameter name -> index
+  SqlValue     *row;        // values bound for the next row
 };
 //////////////////////////////////////////////////////
 SqlStmt incl_insert = { "INSERT INTO includes "
@@ -210,10 +235,6 @@ SqlStmt incl_insert = { "INSERT INTO includes "
     "(:local,:id_src,:id_dst )"
     ,NULL
 };
-SqlStmt incl_select = { "SELECT COUNT(*) FROM includes WHERE "
-  "local=:local AND id_src=:id_src AND id_dst=:id_dst"
-    ,NULL
-};
 //////////////////////////////////////////////////////
 SqlStmt innerclass_insert={"INSERT INTO innerclass "
     "( refid, prot, name )"
@@ -222,24 +243,17 @@ SqlStmt innerclass_insert={"INSERT INTO innerclass "
     ,NULL
 };
 //////////////////////////////////////////////////////
-SqlStmt files_select = {"SELECT rowid FROM files WHERE name=:name"
-  ,NULL
-};
 SqlStmt files_insert = {"INSERT INTO files "
-  "( name )"
+  "( rowid, name )"
     "VALUES "
-    "(:name )"
+    "(:rowid,:name )"
     ,NULL
 };
 //////////////////////////////////////////////////////
-SqlStmt refids_select =  {"SELECT rowid FROM refids WHERE "
-  "refid=:refid"
-    ,NULL
-};
 SqlStmt refids_insert = {"INSERT INTO refids "
-  "( refid )"
+  "( rowid, refid )"
     "VALUES "
-    "(:refid )"
+    "(:rowid,:refid )"
     ,NULL
 };
 //////////////////////////////////////////////////////
@@ -251,9 +265,9 @@ SqlStmt xrefs_insert= {"INSERT INTO xrefs "
 };
 //////////////////////////////////////////////////////
 SqlStmt memberdef_insert={"INSERT INTO memberdef "
-    "( refid, prot, static, const, explicit, inline, final, sealed, new, optional, required, virt, mutable, initonly, readable, writable, gettable, settable, accessor, addable, removable, raisable, name, type, definition, argsstring, scope, initializer, kind, id_bodyfile, bodystart, bodyend, id_file, line, column, detaileddescription, briefdescription, inbodydescription)"
+    "( rowid, refid, prot, static, const, explicit, inline, final, sealed, new, optional, required, virt, mutable, initonly, readable, writable, gettable, settable, accessor, addable, removable, raisable, name, type, definition, argsstring, scope, initializer, kind, id_bodyfile, bodystart, bodyend, id_file, line, column, detaileddescription, briefdescription, inbodydescription)"
     "VALUES "
-    "(:refid,:prot,:static,:const,:explicit,:inline,:final,:sealed,:new,:optional,:required,:virt,:mutable,:initonly,:readable,:writable,:gettable,:settable,:accessor,:addable,:removable,:raisable,:name,:type,:definition,:argsstring,:scope,:initializer,:kind,:id_bodyfile,:bodystart,:bodyend,:id_file,:line,:column,:detaileddescription,:briefdescription,:inbodydescription)"
+    "(:rowid,:refid,:prot,:static,:const,:explicit,:inline,:final,:sealed,:new,:optional,:required,:virt,:mutable,:initonly,:readable,:writable,:gettable,:settable,:accessor,:addable,:removable,:raisable,:name,:type,:definition,:argsstring,:scope,:initializer,:kind,:id_bodyfile,:bodystart,:bodyend,:id_file,:line,:column,:detaileddescription,:briefdescription,:inbodydescription)"
     ,NULL
 };
 //////////////////////////////////////////////////////
@@ -278,20 +292,10 @@ SqlStmt derivedcompoundref_insert={"INSERT INTO  derivedcompoundref "
     ,NULL
 };
 //////////////////////////////////////////////////////
-SqlStmt params_select = { "SELECT rowid FROM  params WHERE "
-    "(attributes IS NULL OR attributes=:attributes) AND "
-    "(type IS NULL OR type=:type) AND "
-    "(declname IS NULL OR declname=:declname) AND "
-    "(defnname IS NULL OR defnname=:defnname) AND "
-    "(array IS NULL OR array=:array) AND "
-    "(defval IS NULL OR defval=:defval) AND "
-    "(briefdescription IS NULL OR briefdescription=:briefdescription)"
-    ,NULL
-};
 SqlStmt params_insert = { "INSERT INTO  params "
-  "( attributes, type, declname, defnname, array, defval, briefdescription ) "
+  "( rowid, attributes, type, declname, defnname, array, defval, briefdescription ) "
     "VALUES "
-    "(:attributes,:type,:declname,:defnname,:array,:defval,:briefdescription)"
+    "(:rowid,:attributes,:type,:declname,:defnname,:array,:defval,:briefdescription)"
     ,NULL
 };
 //////////////////////////////////////////////////////
@@ -340,33 +344,210 @@ class TextGeneratorSqlite3Impl : public TextGeneratorIntf
 };
 
 
-static void bindTextParameter(SqlStmt &s,const char *name,const char *value, bool _static=TRUE)
+//////////////////////////////////////////////////////
+/** Assigns row ids in memory, so that a row can be referred to without
+ *  asking the database whether it already exists.
+ */
+class SqlIdCache
+{
+  public:
+    SqlIdCache(int size) : m_ids(size), m_nextId(1) { m_ids.setAutoDelete(TRUE); }
+    /** Returns the id for \a key, \a isNew is set if the key was not seen before */
+    int id(const char *key,bool &isNew)
+    {
+      int *pId = m_ids.find(key);
+      isNew = pId==0;
+      if (pId) return *pId;
+      m_ids.insert(key,new int(m_nextId));
+      return m_nextId++;
+    }
+    /** Returns a fresh id that is not associated with a key */
+    int newId() { return m_nextId++; }
+  private:
+    QDict<int> m_ids;
+    int        m_nextId;
+};
+
+// created by generateSqlite3(), sized for the project being written
+static SqlIdCache *g_fileIds     = 0;
+static SqlIdCache *g_refIds      = 0;
+static SqlIdCache *g_paramIds    = 0;
+static SqlIdCache *g_includeKeys = 0;
+static SqlIdCache *g_xrefKeys    = 0;
+static int         g_nextMemberdefId = 1;
+
+//////////////////////////////////////////////////////
+/** Row queued for insertion by a statement */
+struct SqlRow
+{
+  SqlRow(SqlStmt *s,SqlValue *v) : stmt(s), values(v) {}
+ ~SqlRow() { delete[] values; }
+  SqlStmt  *stmt;
+  SqlValue *values;
+};
+
+/** Batch of rows that is inserted in one go */
+class SqlBatch : public QList<SqlRow>
+{
+  public:
+    SqlBatch() { setAutoDelete(TRUE); }
+};
+
+static const uint sqlBatchSize = 10000;
+
+/** Queue of filled batches shared with the writer thread */
+class SqlBatchQueue
+{
+  public:
+    SqlBatchQueue(uint maxPending) : m_maxPending(maxPending) {}
+    void enqueue(SqlBatch *batch)
+    {
+      QMutexLocker locker(&m_mutex);
+      while (m_queue.count()>=m_maxPending)
+      {
+        m_bufferNotFull.wait(&m_mutex);
+      }
+      m_queue.enqueue(batch);
+      m_bufferNotEmpty.wakeAll();
+    }
+    SqlBatch *dequeue()
+    {
+      QMutexLocker locker(&m_mutex);
+      while (m_queue.isEmpty())
+      {
+        m_bufferNotEmpty.wait(&m_mutex);
+      }
+      SqlBatch *batch = m_queue.dequeue();
+      m_bufferNotFull.wakeAll();
+      return batch;
+    }
+  private:
+    QWaitCondition   m_bufferNotEmpty;
+    QWaitCondition   m_bufferNotFull;
+    QQueue<SqlBatch> m_queue;
+    uint             m_maxPending;
+    QMutex           m_mutex;
+};
+
+static SqlBatch      *g_batch      = 0;
+static SqlBatchQueue *g_batchQueue = 0;
+static int            g_rowCount   = 0;
+
+/** Binds the values of each row in \a batch and inserts it */
+static void writeBatch(sqlite3 *db,SqlBatch *batch)
+{
+  QListIterator<SqlRow> rli(*batch);
+  SqlRow *row;
+  for (rli.toFirst();(row=rli.current());++rli)
+  {
+    sqlite3_stmt *stmt = row->stmt->stmt;
+    int i;
+    for (i=0;i<row->stmt->numParams;i++)
+    {
+      const SqlValue &v = row->values[i];
+      if (v.isNull) continue;
+      if (v.isText)
+      {
+        sqlite3_bind_text(stmt,i+1,v.textValue.data(),v.textValue.length(),SQLITE_STATIC);
+      }
+      else
+      {
+        sqlite3_bind_int(stmt,i+1,v.intValue);
+      }
+    }
+    int rc = sqlite3_step(stmt);
+    if (rc!=SQLITE_DONE && rc!=SQLITE_ROW)
+    {
+      msg("sqlite3_step failed: %s\n", sqlite3_errmsg(db));
+    }
+    else
+    {
+      g_rowCount++;
+    }
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+  }
+}
+
+/** Thread that inserts the batches produced by the generator */
+class SqlWriterThread : public QThread
+{
+  public:
+    SqlWriterThread(sqlite3 *db,SqlBatchQueue *queue) : m_db(db), m_queue(queue) {}
+    void run()
+    {
+      SqlBatch *batch;
+      while ((batch=m_queue->dequeue()))
+      {
+        writeBatch(m_db,batch);
+        delete batch;
+      }
+    }
+  private:
+    sqlite3       *m_db;
+    SqlBatchQueue *m_queue;
+};
+
+static void flushBatch(sqlite3 *db)
+{
+  if (g_batch==0 || g_batch->isEmpty()) return;
+  if (g_batchQueue)
+  {
+    g_batchQueue->enqueue(g_batch);
+  }
+  else
+  {
+    writeBatch(db,g_batch);
+    delete g_batch;
+  }
+  g_batch = new SqlBatch;
+}
+
+static SqlValue &paramValue(SqlStmt &s,const char *name)
 {
-  int idx = sqlite3_bind_parameter_index(s.stmt, name);
-  sqlite3_bind_text(s.stmt, idx, value, -1, _static==TRUE?SQLITE_STATIC:SQLITE_TRANSIENT);
+  static SqlValue dummy;
+  int *idx = s.paramIndex->find(name);
+  if (idx==0)
+  {
+    msg("unknown parameter %s for query %s\n",name,s.query);
+    return dummy;
+  }
+  if (s.row==0) s.row = new SqlValue[s.numParams];
+  return s.row[*idx];
+}
+
+static void bindTextParameter(SqlStmt &s,const char *name,const char *value)
+{
+  SqlValue &v = paramValue(s,name);
+  v.isNull    = value==0;
+  v.isText    = TRUE;
+  v.textValue = value;
 }
 
 static void bindIntParameter(SqlStmt &s,const char *name,int value)
 {
-  int idx = sqlite3_bind_parameter_index(s.stmt, name);
-  sqlite3_bind_int(s.stmt, idx, value);
+  SqlValue &v = paramValue(s,name);
+  v.isNull   = FALSE;
+  v.isText   = FALSE;
+  v.intValue = value;
 }
 
-static int step(sqlite3 *db, SqlStmt &s,bool getRowId=FALSE, bool select=FALSE)
+static void clearBindings(SqlStmt &s)
 {
-  int rowid=-1;
-  int rc = sqlite3_step(s.stmt);
-  if (rc!=SQLITE_DONE && rc!=SQLITE_ROW)
+  delete[] s.row;
+  s.row = 0;
+}
+
+/** Queues the row bound to \a s for insertion */
+static void step(sqlite3 *db, SqlStmt &s)
+{
+  if (s.row==0) s.row = new SqlValue[s.numParams];
+  g_batch->append(new SqlRow(&s,s.row));
+  s.row = 0;
+  if (g_batch->count()>=sqlBatchSize)
   {
-    msg("sqlite3_step failed: %s\n", sqlite3_errmsg(db));
-    sqlite3_clear_bindings(s.stmt);
-    return -1;
+    flushBatch(db);
   }
-  if (getRowId && select) rowid = sqlite3_column_int(s.stmt, 0); // works on selects, doesnt on inserts
-  if (getRowId && !select) rowid = sqlite3_last_insert_rowid(db); //works on inserts, doesnt on selects
-  sqlite3_reset(s.stmt);
-  sqlite3_clear_bindings(s.stmt); // XXX When should this really be called
-  return rowid;
 }
 
 static int insertFile(sqlite3 *db, const char* name)
@@ -374,12 +555,13 @@ static int insertFile(sqlite3 *db, const char* name)
   int rowid=-1;
   if (name==0) return rowid;
 
-  bindTextParameter(files_select,":name",name);
-  rowid=step(db,files_select,TRUE,TRUE);
-  if (rowid==0)
+  bool isNew;
+  rowid=g_fileIds->id(name,isNew);
+  if (isNew)
   {
+    bindIntParameter(files_insert,":rowid",rowid);
     bindTextParameter(files_insert,":name",name);
-    rowid=step(db,files_insert,TRUE);
+    step(db,files_insert);
   }
   return rowid;
 }
@@ -389,16 +571,54 @@ static int insertRefid(sqlite3 *db, const char *refid)
   int rowid=-1;
   if (refid==0) return rowid;
 
-  bindTextParameter(refids_select,":refid",refid);
-  rowid=step(db,refids_select,TRUE,TRUE);
-  if (rowid==0)
+  bool isNew;
+  rowid=g_refIds->id(refid,isNew);
+  if (isNew)
   {
+    bindIntParameter(refids_insert,":rowid",rowid);
     bindTextParameter(refids_insert,":refid",refid);
-    rowid=step(db,refids_insert,TRUE);
+    step(db,refids_insert);
   }
   return rowid;
 }
 
+static void insertInclude(sqlite3 *db, int local, int id_src, int id_dst)
+{
+  QCString key;
+  key.sprintf("%d:%d:%d",local,id_src,id_dst);
+  bool isNew;
+  g_includeKeys->id(key,isNew);
+  if (isNew)
+  {
+    bindIntParameter(incl_insert,":local",local);
+    bindIntParameter(incl_insert,":id_src",id_src);
+    bindIntParameter(incl_insert,":id_dst",id_dst);
+    step(db,incl_insert);
+  }
+}
+
+/** Inserts a parameter unless an identical one already exists and returns its id */
+static int insertParam(sqlite3 *db,const QCString &attributes,const QCString &type,
+                       const QCString &declname,const QCString &defnname,
+                       const QCString &array,const QCString &defval)
+{
+  QCString key = attributes+'\001'+type+'\001'+declname+'\001'+
+                 defnname+'\001'+array+'\001'+defval;
+  bool isNew;
+  int id_param = g_paramIds->id(key,isNew);
+  if (isNew)
+  {
+    bindIntParameter(params_insert,":rowid",id_param);
+    if (!attributes.isEmpty()) bindTextParameter(params_insert,":attributes",attributes);
+    if (!type.isEmpty())       bindTextParameter(params_insert,":type",type);
+    if (!declname.isEmpty())   bindTextParameter(params_insert,":declname",declname);
+    if (!defnname.isEmpty())   bindTextParameter(params_insert,":defnname",defnname);
+    if (!array.isEmpty())      bindTextParameter(params_insert,":array",array);
+    if (!defval.isEmpty())     bindTextParameter(params_insert,":defval",defval);
+    step(db,params_insert);
+  }
+  return id_param;
+}
 
 static void insertMemberReference(sqlite3 *db, const char*src, const char*dst, const char *file, int line, int column)
 {
@@ -408,11 +628,17 @@ static void insertMemberReference(sqlite3 *db, const char*src, const char*dst, c
   if (id_file==-1||refid_src==-1||refid_dst==-1)
     return;
 
+  QCString key;
+  key.sprintf("%d:%d:%d:%d:%d",refid_src,refid_dst,id_file,line,column);
+  bool isNew;
+  g_xrefKeys->id(key,isNew);
+  if (!isNew) return; // already recorded
+
   bindIntParameter(xrefs_insert,":refid_src",refid_src);
   bindIntParameter(xrefs_insert,":refid_dst",refid_dst);
   bindIntParameter(xrefs_insert,":id_file",id_file);
   bindIntParameter(xrefs_insert,":line",line);
-  bindIntParameter(xrefs_insert,":column",1);
+  bindIntParameter(xrefs_insert,":column",column);
   step(db,xrefs_insert);
 }
 
@@ -448,11 +674,6 @@ static void insertMemberFunctionParams(sqlite3 *db,int id_memberdef,MemberDef *m
     {
       Argument *defArg = defAli.current();
 
-      if (!a->attrib.isEmpty())
-      {
-        bindTextParameter(params_select,":attributes",a->attrib.data());
-        bindTextParameter(params_insert,":attributes",a->attrib.data());
-      }
       if (!a->type.isEmpty())
       {
         StringList l;
@@ -465,37 +686,20 @@ static void insertMemberFunctionParams(sqlite3 *db,int id_memberdef,MemberDef *m
           insertMemberReference(db,md->anchor().data(),s->data(),def->getDefFileName().data(),md->getDefLine(),1);
           ++li;
         }
-        bindTextParameter(params_select,":type",a->type.data());
-        bindTextParameter(params_insert,":type",a->type.data());
-      }
-      if (!a->name.isEmpty())
-      {
-        bindTextParameter(params_select,":declname",a->name.data());
-        bindTextParameter(params_insert,":declname",a->name.data());
       }
+      QCString defnname;
       if (defArg && !defArg->name.isEmpty() && defArg->name!=a->name)
       {
-        bindTextParameter(params_select,":defnname",defArg->name.data());
-        bindTextParameter(params_insert,":defnname",defArg->name.data());
-      }
-      if (!a->array.isEmpty())
-      {
-        bindTextParameter(params_select,":array",a->array.data());
-        bindTextParameter(params_insert,":array",a->array.data());
+        defnname = defArg->name;
       }
       if (!a->defval.isEmpty())
       {
         StringList l;
         linkifyText(TextGeneratorSqlite3Impl(l),def,md->getBodyDef(),md,a->defval);
-        bindTextParameter(params_select,":defval",a->defval.data());
-        bindTextParameter(params_insert,":defval",a->defval.data());
       }
       if (defArg) ++defAli;
 
-      int id_param=step(db,params_select,TRUE,TRUE);
-      if (id_param==0) {
-        id_param=step(db,params_insert,TRUE);
-      }
+      int id_param=insertParam(db,a->attrib,a->type,a->name,defnname,a->array,a->defval);
 
       bindIntParameter(memberdef_params_insert,":id_memberdef",id_memberdef);
       bindIntParameter(memberdef_params_insert,":id_param",id_param);
@@ -517,8 +721,10 @@ static void insertMemberDefineParams(sqlite3 *db,int id_memberdef,MemberDef *md,
       Argument *a;
       for (ali.toFirst();(a=ali.current());++ali)
       {
+        int id_param=g_paramIds->newId();
+        bindIntParameter(params_insert,":rowid",id_param);
         bindTextParameter(params_insert,":defnname",a->type.data());
-        int id_param=step(db,params_insert,TRUE);
+        step(db,params_insert);
 
         bindIntParameter(memberdef_params_insert,":id_memberdef",id_memberdef);
         bindIntParameter(memberdef_params_insert,":id_param",id_param);
@@ -550,21 +756,36 @@ static int prepareStatement(sqlite3 *db, SqlStmt &s)
     msg("prepare failed for %s\n%s\n", s.query, sqlite3_errmsg(db));
     return -1;
   }
+  // map the parameter names, so binding a value does not need the database
+  s.numParams = sqlite3_bind_parameter_count(s.stmt);
+  s.paramIndex = new QDict<int>(67);
+  s.paramIndex->setAutoDelete(TRUE);
+  int i;
+  for (i=0;i<s.numParams;i++)
+  {
+    s.paramIndex->insert(sqlite3_bind_parameter_name(s.stmt,i+1),new int(i));
+  }
+  s.row = 0;
   return rc;
 }
 
+static void finalizeStatement(SqlStmt &s)
+{
+  sqlite3_finalize(s.stmt);
+  s.stmt = 0;
+  delete s.paramIndex;
+  s.paramIndex = 0;
+  clearBindings(s);
+}
+
 static int prepareStatements(sqlite3 *db)
 {
   if (
   -1==prepareStatement(db, memberdef_insert) ||
   -1==prepareStatement(db, files_insert) ||
-  -1==prepareStatement(db, files_select) ||
   -1==prepareStatement(db, refids_insert) ||
-  -1==prepareStatement(db, refids_select) ||
   -1==prepareStatement(db, incl_insert)||
-  -1==prepareStatement(db, incl_select)||
   -1==prepareStatement(db, params_insert) ||
-  -1==prepareStatement(db, params_select) ||
   -1==prepareStatement(db, xrefs_insert) ||
   -1==prepareStatement(db, innerclass_insert) ||
   -1==prepareStatement(db, compounddef_insert) ||
@@ -579,6 +800,22 @@ static int prepareStatements(sqlite3 *db)
   return 0;
 }
 
+static void finalizeStatements()
+{
+  finalizeStatement(memberdef_insert);
+  finalizeStatement(files_insert);
+  finalizeStatement(refids_insert);
+  finalizeStatement(incl_insert);
+  finalizeStatement(params_insert);
+  finalizeStatement(xrefs_insert);
+  finalizeStatement(innerclass_insert);
+  finalizeStatement(compounddef_insert);
+  finalizeStatement(basecompoundref_insert);
+  finalizeStatement(derivedcompoundref_insert);
+  finalizeStatement(memberdef_params_insert);
+  finalizeStatement(innernamespace_insert);
+}
+
 static void beginTransaction(sqlite3 *db)
 {
   char * sErrMsg = 0;
@@ -626,6 +863,20 @@ static int initializeSchema(sqlite3* db)
   return 0;
 }
 
+static void createIndexes(sqlite3 *db)
+{
+  msg("Creating DB indexes...\n");
+  for (unsigned int k = 0; k < sizeof(index_queries) / sizeof(index_queries[0]); k++)
+  {
+    char *sErrMsg = 0;
+    if (sqlite3_exec(db, index_queries[k], NULL, NULL, &sErrMsg)!=SQLITE_OK)
+    {
+      msg("failed to execute query: %s\n\t%s\n", index_queries[k], sErrMsg);
+      sqlite3_free(sErrMsg);
+    }
+  }
+}
+
 ////////////////////////////////////////////
 static void writeInnerClasses(sqlite3*db,const ClassSDict *cl)
 {
@@ -637,7 +888,7 @@ static void writeInnerClasses(sqlite3*db,const ClassSDict *cl)
   {
     if (!cd->isHidden() && cd->name().find('@')==-1) // skip anonymous scopes
     {
-      bindTextParameter(innerclass_insert,":refid",cd->getOutputFileBase(),FALSE);
+      bindTextParameter(innerclass_insert,":refid",cd->getOutputFileBase());
       bindIntParameter(innerclass_insert,":prot",cd->protection());
       bindTextParameter(innerclass_insert,":name",cd->name());
       step(db,innerclass_insert);
@@ -656,8 +907,8 @@ static void writeInnerNamespaces(sqlite3 *db,const NamespaceSDict *nl)
     {
       if (!nd->isHidden() && nd->name().find('@')==-1) // skip anonymouse scopes
       {
-        bindTextParameter(innernamespace_insert,":refid",nd->getOutputFileBase(),FALSE);
-        bindTextParameter(innernamespace_insert,":name",nd->name(),FALSE);
+        bindTextParameter(innernamespace_insert,":refid",nd->getOutputFileBase());
+        bindTextParameter(innernamespace_insert,":name",nd->name());
         step(db,innernamespace_insert);
       }
     }
@@ -679,24 +930,12 @@ static void writeTemplateArgumentList(sqlite3* db,
       if (!a->type.isEmpty())
       {
         #warning linkifyText(TextGeneratorXMLImpl(t),scope,fileScope,0,a->type);
-        bindTextParameter(params_select,":type",a->type);
-        bindTextParameter(params_insert,":type",a->type);
-      }
-      if (!a->name.isEmpty())
-      {
-        bindTextParameter(params_select,":declname",a->name);
-        bindTextParameter(params_insert,":declname",a->name);
-        bindTextParameter(params_select,":defnname",a->name);
-        bindTextParameter(params_insert,":defnname",a->name);
       }
       if (!a->defval.isEmpty())
       {
         #warning linkifyText(TextGeneratorXMLImpl(t),scope,fileScope,0,a->defval);
-        bindTextParameter(params_select,":defval",a->defval);
-        bindTextParameter(params_insert,":defval",a->defval);
       }
-      if (!step(db,params_select,TRUE,TRUE))
-        step(db,params_insert);
+      insertParam(db,QCString(),a->type,a->name,a->name,QCString(),a->defval);
     }
   }
 }
@@ -741,7 +980,7 @@ static void generateSqlite3ForMember(sqlite3*db,MemberDef *md,Definition *def)
   //if (def->definitionType()!=Definition::TypeGroup && md->getGroupDef()) return;
   QCString memType;
   // memberdef
-  bindTextParameter(memberdef_insert,":refid",md->anchor().data(),FALSE);
+  bindTextParameter(memberdef_insert,":refid",md->anchor().data());
   bindIntParameter(memberdef_insert,":kind",md->memberType());
   bindIntParameter(memberdef_insert,":prot",md->protection());
 
@@ -821,7 +1060,7 @@ static void generateSqlite3ForMember(sqlite3*db,MemberDef *md,Definition *def)
     linkifyText(TextGeneratorSqlite3Impl(l),def,md->getBodyDef(),md,typeStr);
     if (typeStr.data())
     {
-      bindTextParameter(memberdef_insert,":type",typeStr.data(),FALSE);
+      bindTextParameter(memberdef_insert,":type",typeStr.data());
     }
 
     if (md->definition())
@@ -876,13 +1115,13 @@ static void generateSqlite3ForMember(sqlite3*db,MemberDef *md,Definition *def)
 
   if ( md->getScopeString() )
   {
-    bindTextParameter(memberdef_insert,":scope",md->getScopeString().data(),FALSE);
+    bindTextParameter(memberdef_insert,":scope",md->getScopeString().data());
   }
 
   // +Brief, detailed and inbody description
-  bindTextParameter(memberdef_insert,":briefdescription",md->briefDescription(),FALSE);
-  bindTextParameter(memberdef_insert,":detaileddescription",md->documentation(),FALSE);
-  bindTextParameter(memberdef_insert,":inbodydescription",md->inbodyDocumentation(),FALSE);
+  bindTextParameter(memberdef_insert,":briefdescription",md->briefDescription());
+  bindTextParameter(memberdef_insert,":detaileddescription",md->documentation());
+  bindTextParameter(memberdef_insert,":inbodydescription",md->inbodyDocumentation());
 
   // File location
   if (md->getDefLine() != -1)
@@ -899,7 +1138,7 @@ static void generateSqlite3ForMember(sqlite3*db,MemberDef *md,Definition *def)
         int id_bodyfile = insertFile(db,md->getBodyDef()->absFilePath());
         if (id_bodyfile == -1)
         {
-            sqlite3_clear_bindings(memberdef_insert.stmt);
+            clearBindings(memberdef_insert);
         }
         else
         {
@@ -911,7 +1150,9 @@ static void generateSqlite3ForMember(sqlite3*db,MemberDef *md,Definition *def)
     }
   }
 
-  int id_memberdef=step(db,memberdef_insert,TRUE);
+  int id_memberdef=g_nextMemberdefId++;
+  bindIntParameter(memberdef_insert,":rowid",id_memberdef);
+  step(db,memberdef_insert);
 
   if (isFunc)
   {
@@ -1006,9 +1247,9 @@ static void generateSqlite3ForClass(sqlite3 *db, ClassDef *cd)
   msg("Generating Sqlite3 output for class %s\n",cd->name().data());
 
   bindTextParameter(compounddef_insert,":name",cd->name());
-  bindTextParameter(compounddef_insert,":kind",cd->compoundTypeString(),FALSE);
+  bindTextParameter(compounddef_insert,":kind",cd->compoundTypeString());
   bindIntParameter(compounddef_insert,":prot",cd->protection());
-  bindTextParameter(compounddef_insert,":refid",cd->getOutputFileBase(),FALSE);
+  bindTextParameter(compounddef_insert,":refid",cd->getOutputFileBase());
 
   int id_file = insertFile(db,cd->getDefFileName().data());
   bindIntParameter(compounddef_insert,":id_file",id_file);
@@ -1024,19 +1265,19 @@ static void generateSqlite3ForClass(sqlite3 *db, ClassDef *cd)
     BaseClassDef *bcd;
     for (bcli.toFirst();(bcd=bcli.current());++bcli)
     {
-      bindTextParameter(basecompoundref_insert,":refid",bcd->classDef->getOutputFileBase(),FALSE);
+      bindTextParameter(basecompoundref_insert,":refid",bcd->classDef->getOutputFileBase());
       bindIntParameter(basecompoundref_insert,":prot",bcd->prot);
       bindIntParameter(basecompoundref_insert,":virt",bcd->virt);
 
       if (!bcd->templSpecifiers.isEmpty())
       {
-        bindTextParameter(basecompoundref_insert,":base",insertTemplateSpecifierInScope(bcd->classDef->name(),bcd->templSpecifiers),FALSE);
+        bindTextParameter(basecompoundref_insert,":base",insertTemplateSpecifierInScope(bcd->classDef->name(),bcd->templSpecifiers));
       }
       else
       {
-        bindTextParameter(basecompoundref_insert,":base",bcd->classDef->displayName(),FALSE);
+        bindTextParameter(basecompoundref_insert,":base",bcd->classDef->displayName());
       }
-      bindTextParameter(basecompoundref_insert,":derived",cd->displayName(),FALSE);
+      bindTextParameter(basecompoundref_insert,":derived",cd->displayName());
       step(db,basecompoundref_insert);
     }
   }
@@ -1048,16 +1289,16 @@ static void generateSqlite3ForClass(sqlite3 *db, ClassDef *cd)
     BaseClassDef *bcd;
     for (bcli.toFirst();(bcd=bcli.current());++bcli)
     {
-      bindTextParameter(derivedcompoundref_insert,":base",cd->displayName(),FALSE);
+      bindTextParameter(derivedcompoundref_insert,":base",cd->displayName());
       if (!bcd->templSpecifiers.isEmpty())
       {
-        bindTextParameter(derivedcompoundref_insert,":derived",insertTemplateSpecifierInScope(bcd->classDef->name(),bcd->templSpecifiers),FALSE);
+        bindTextParameter(derivedcompoundref_insert,":derived",insertTemplateSpecifierInScope(bcd->classDef->name(),bcd->templSpecifiers));
       }
       else
       {
-        bindTextParameter(derivedcompoundref_insert,":derived",bcd->classDef->displayName(),FALSE);
+        bindTextParameter(derivedcompoundref_insert,":derived",bcd->classDef->displayName());
       }
-      bindTextParameter(derivedcompoundref_insert,":refid",bcd->classDef->getOutputFileBase(),FALSE);
+      bindTextParameter(derivedcompoundref_insert,":refid",bcd->classDef->getOutputFileBase());
       bindIntParameter(derivedcompoundref_insert,":prot",bcd->prot);
       bindIntParameter(derivedcompoundref_insert,":virt",bcd->virt);
       step(db,derivedcompoundref_insert);
@@ -1074,17 +1315,7 @@ static void generateSqlite3ForClass(sqlite3 *db, ClassDef *cd)
     {
       int id_dst=insertFile(db,nm);
       if (id_dst!=-1) {
-        bindIntParameter(incl_select,":local",ii->local);
-        bindIntParameter(incl_select,":id_src",id_file);
-        bindIntParameter(incl_select,":id_dst",id_dst);
-        int count=step(db,incl_select,TRUE,TRUE);
-        if (count==0)
-        {
-          bindIntParameter(incl_insert,":local",ii->local);
-          bindIntParameter(incl_insert,":id_src",id_file);
-          bindIntParameter(incl_insert,":id_dst",id_dst);
-          step(db,incl_insert);
-        }
+        insertInclude(db,ii->local,id_file,id_dst);
       }
     }
   }
@@ -1188,15 +1419,7 @@ static void generateSqlite3ForFile(sqlite3 *db, FileDef *fd)
     {
       int id_src=insertFile(db,fd->absFilePath().data());
       int id_dst=insertFile(db,ii->includeName.data());
-      bindIntParameter(incl_select,":local",ii->local);
-      bindIntParameter(incl_select,":id_src",id_src);
-      bindIntParameter(incl_select,":id_dst",id_dst);
-      if (step(db,incl_select,TRUE,TRUE)==0) {
-        bindIntParameter(incl_insert,":local",ii->local);
-        bindIntParameter(incl_insert,":id_src",id_src);
-        bindIntParameter(incl_insert,":id_dst",id_dst);
-        step(db,incl_insert);
-      }
+      insertInclude(db,ii->local,id_src,id_dst);
     }
   }
 
@@ -1208,15 +1431,7 @@ static void generateSqlite3ForFile(sqlite3 *db, FileDef *fd)
     {
       int id_src=insertFile(db,ii->includeName);
       int id_dst=insertFile(db,fd->absFilePath());
-      bindIntParameter(incl_select,":local",ii->local);
-      bindIntParameter(incl_select,":id_src",id_src);
-      bindIntParameter(incl_select,":id_dst",id_dst);
-      if (step(db,incl_select,TRUE,TRUE)==0) {
-        bindIntParameter(incl_insert,":local",ii->local);
-        bindIntParameter(incl_insert,":id_src",id_src);
-        bindIntParameter(incl_insert,":id_dst",id_dst);
-        step(db,incl_insert);
-      }
+      insertInclude(db,ii->local,id_src,id_dst);
     }
   }
 
@@ -1272,6 +1487,28 @@ static void generateSqlite3ForPage(sqlite3 *db,PageDef *pd,bool isExample)
 }
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
+/** Counts the input files and the members, to size the id caches */
+static void countDefinitions(int &numFiles,int &numMembers)
+{
+  FileNameListIterator fnli(*Doxygen::inputNameList);
+  FileName *fn;
+  for (;(fn=fnli.current());++fnli)
+  {
+    numFiles+=fn->count();
+  }
+  MemberNameSDict::Iterator mnli(*Doxygen::memberNameSDict);
+  MemberName *mn;
+  for (mnli.toFirst();(mn=mnli.current());++mnli)
+  {
+    numMembers+=mn->count();
+  }
+  MemberNameSDict::Iterator fnli2(*Doxygen::functionNameSDict);
+  for (fnli2.toFirst();(mn=fnli2.current());++fnli2)
+  {
+    numMembers+=mn->count();
+  }
+}
+
 void generateSqlite3()
 {
   // + classes
@@ -1284,6 +1521,8 @@ void generateSqlite3()
 
   QCString outputDirectory = Config_getString(OUTPUT_DIRECTORY);
   QDir sqlite3Dir(outputDirectory);
+  // row ids are assigned in memory, so always start with an empty database
+  sqlite3Dir.remove("doxygen_sqlite3.db");
   sqlite3 *db;
   sqlite3_initialize();
   int rc = sqlite3_open_v2(outputDirectory+"/doxygen_sqlite3.db", &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, 0);
@@ -1305,6 +1544,33 @@ void generateSqlite3()
     return;
   }
 
+  int numFiles   = 0;
+  int numMembers = 0;
+  countDefinitions(numFiles,numMembers);
+  int numDefs = numFiles+numMembers+
+                Doxygen::classSDict->count()+Doxygen::namespaceSDict->count()+
+                Doxygen::groupSDict->count()+Doxygen::pageSDict->count();
+  g_fileIds     = new SqlIdCache(QMAX(numFiles,257));
+  g_refIds      = new SqlIdCache(QMAX(numDefs,1009));
+  g_paramIds    = new SqlIdCache(QMAX(numMembers,1009));
+  g_includeKeys = new SqlIdCache(QMAX(numFiles*4,1009));
+  g_xrefKeys    = new SqlIdCache(QMAX(numMembers*4,1009));
+  g_nextMemberdefId = 1;
+
+  // rows are collected in batches on this thread and inserted by a
+  // separate writer thread if more than one thread may be used.
+  QTime timer;
+  timer.start();
+  g_rowCount = 0;
+  g_batch = new SqlBatch;
+  SqlWriterThread *writer = 0;
+  if (getNumProcThreads()>1)
+  {
+    g_batchQueue = new SqlBatchQueue(4);
+    writer = new SqlWriterThread(db,g_batchQueue);
+    writer->start();
+  }
+
   // + classes
   ClassSDict::Iterator cli(*Doxygen::classSDict);
   ClassDef *cd;
@@ -1386,7 +1652,31 @@ void generateSqlite3()
     generateSqlite3ForPage(db,Doxygen::mainPage,FALSE);
   }
 
+  flushBatch(db);
+  delete g_batch;
+  g_batch = 0;
+  if (writer)
+  {
+    g_batchQueue->enqueue(0); // terminate the writer
+    writer->wait();
+    delete writer;
+    delete g_batchQueue;
+    g_batchQueue = 0;
+  }
+  createIndexes(db);
   endTransaction(db);
+  finalizeStatements();
+  sqlite3_close(db);
+
+  double elapsed = timer.elapsed()/1000.0;
+  msg("Inserted %d rows into the sqlite3 database in %.2f sec (%.0f rows/sec)\n",
+      g_rowCount,elapsed,elapsed>0 ? g_rowCount/elapsed : 0.0);
+
+  delete g_fileIds;     g_fileIds=0;
+  delete g_refIds;      g_refIds=0;
+  delete g_paramIds;    g_paramIds=0;
+  delete g_includeKeys; g_includeKeys=0;
+  delete g_xrefKeys;    g_xrefKeys=0;
 }
 
 #else // USE_SQLITE3
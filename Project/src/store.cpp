@@ -18,6 +18,7 @@
 
 #include "store.h"
 #include "portable.h"
+#include "profiler.h"
 
 
 #include <stdio.h>
@@ -306,6 +307,7 @@ void Store::seek(portable_off_t pos)
 {
   STORE_ASSERT(m_state==Reading);
   //printf("%x: Store::seek\n",(int)pos);
+  Profiler::count(Profiler::StoreReads);
   if (portable_fseek(m_file,pos,SEEK_SET)==-1)
   {
     fprintf(stderr,"Store::seek: Error seeking to position %d: %s\n",
@@ -0,0 +1,71 @@
+/******************************************************************************
+ *
+ * Copyright (C) 1997-2015 by Dimitri van Heesch.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License is hereby
+ * granted. No representations are made about the suitability of this software
+ * for any purpose. It is provided "as is" without express or implied warranty.
+ * See the GNU General Public License for more details.
+ *
+ * Documents produced by Doxygen are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+ */
+
+#include <qasciidict.h>
+
+#include "stringpool.h"
+
+// strings up to this length are stored inside the QCString itself,
+// so sharing them would not save anything
+static const uint maxInlineLength = sizeof(QCString)-3;
+
+// the dictionary does not copy its keys; each key points to the data of
+// the pooled string it maps to, which lives as long as the entry.
+static QAsciiDict<QCString> g_pool(10007,TRUE,FALSE);
+static ulong  g_poolSize = 0;
+static ulong  g_poolHits = 0;
+
+QCString StringPool::intern(const QCString &s)
+{
+  if (s.length()<=maxInlineLength) return s;
+  QCString *pooled = g_pool.find(s.data());
+  if (pooled)
+  {
+    g_poolHits++;
+    return *pooled;
+  }
+  if (g_pool.count()>2*g_pool.size())
+  {
+    // keep the chains short, the pool can hold millions of strings
+    g_pool.resize(g_pool.size()*4+1);
+  }
+  pooled = new QCString(s);
+  g_pool.insert(pooled->data(),pooled);
+  g_poolSize+=s.length()+1;
+  return *pooled;
+}
+
+uint StringPool::count()
+{
+  return g_pool.count();
+}
+
+ulong StringPool::size()
+{
+  return g_poolSize;
+}
+
+ulong StringPool::hits()
+{
+  return g_poolHits;
+}
+
+void StringPool::clear()
+{
+  g_pool.setAutoDelete(TRUE);
+  g_pool.clear();
+  g_pool.setAutoDelete(FALSE);
+  g_poolSize=0;
+}
@@ -0,0 +1,53 @@
+/******************************************************************************
+ *
+ * Copyright (C) 1997-2015 by Dimitri van Heesch.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation under the terms of the GNU General Public License is hereby
+ * granted. No representations are made about the suitability of this software
+ * for any purpose. It is provided "as is" without express or implied warranty.
+ * See the GNU General Public License for more details.
+ *
+ * Documents produced by Doxygen are derivative works derived from the
+ * input used in their production; they are not affected by this license.
+ *
+ */
+
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+#include <qcstring.h>
+
+/** @brief Pool of strings shared by the objects of the symbol model.
+ *
+ *  Strings longer than what a QCString stores inline are reference
+ *  counted, so storing the pooled copy of a string makes all holders of
+ *  the same text share one buffer. Use this for strings that repeat a lot,
+ *  such as file names, types and argument lists, and that are not
+ *  modified in place. Like the model itself the pool is only to be used
+ *  from the main thread.
+ */
+class StringPool
+{
+  public:
+    /** Returns a string equal to \a s that shares its data with all
+     *  other strings returned for the same text.
+     */
+    static QCString intern(const QCString &s);
+
+    /** Returns the number of different strings in the pool */
+    static uint count();
+
+    /** Returns the number of bytes used by the strings in the pool */
+    static ulong size();
+
+    /** Returns the number of times a string was found in the pool */
+    static ulong hits();
+
+    /** Removes all strings from the pool. Strings that are still in use
+     *  stay valid.
+     */
+    static void clear();
+};
+
+#endif
@@ -21,13 +21,14 @@
 #include <stdio.h>
 #include <stdarg.h>
 
-#include <qxml.h>
 #include <qstack.h>
 #include <qdict.h>
 #include <qfileinfo.h>
 #include <qlist.h>
-#include <qstring.h>
-#include <qstringlist.h>
+#include <qvaluelist.h>
+#include <qvector.h>
+#include <qthread.h>
+#include <qmutex.h>
 
 #include "entry.h"
 #include "classdef.h"
@@ -39,6 +40,59 @@
 #include "filedef.h"
 #include "filename.h"
 #include "section.h"
+#include "config.h"
+#include "portable.h"
+#include "bufstr.h"
+
+/** List of names read from a tag file.
+ *
+ *  The strings are kept in UTF-8 so the parser never has to touch the
+ *  (shared) QString machinery, which allows tag files to be read on
+ *  worker threads.
+ */
+typedef QValueList<QCString> TagStringList;
+
+/** Attributes of an element in a tag file, as raw UTF-8 name/value pairs */
+class TagAttributes
+{
+  public:
+    enum { MaxAttributes = 16 };
+    TagAttributes() : m_count(0) {}
+    void clear() { m_count=0; }
+    bool append(const QCString &name,const QCString &value)
+    {
+      if (m_count==MaxAttributes) return FALSE;
+      m_names[m_count]=name;
+      m_values[m_count]=value;
+      m_count++;
+      return TRUE;
+    }
+    /** Returns the value of attribute \a name or an empty string if
+     *  the attribute was not specified.
+     */
+    QCString value(const char *name) const
+    {
+      int i;
+      for (i=0;i<m_count;i++)
+      {
+        if (m_names[i]==name) return m_values[i];
+      }
+      return QCString();
+    }
+  private:
+    QCString m_names[MaxAttributes];
+    QCString m_values[MaxAttributes];
+    int m_count;
+};
+
+/** Appends \a len bytes from \a s to string \a str */
+static inline void appendBytes(QCString &str,const char *s,int len)
+{
+  if (len<=0) return;
+  int curLen = str.length();
+  str.resize(curLen+len+1);
+  memcpy(str.rawData()+curLen,s,len);
+}
 
 /** Information about an linkable anchor */
 class TagAnchorInfo
@@ -105,7 +159,7 @@ class TagClassInfo
     QList<BaseInfo> *bases;
     QList<TagMemberInfo> members;
     QList<QCString> *templateArguments;
-    QStringList classList;
+    TagStringList classList;
     Kind kind;
     bool isObjC;
 };
@@ -118,8 +172,8 @@ class TagNamespaceInfo
     QCString name;
     QCString filename;
     QCString clangId;
-    QStringList classList;
-    QStringList namespaceList;
+    TagStringList classList;
+    TagStringList namespaceList;
     TagAnchorInfoList docAnchors;
     QList<TagMemberInfo> members;
 };
@@ -133,7 +187,7 @@ class TagPackageInfo
     QCString filename;
     TagAnchorInfoList docAnchors;
     QList<TagMemberInfo> members;
-    QStringList classList;
+    TagStringList classList;
 };
 
 /** Container for include info that can be read from a tagfile */
@@ -157,8 +211,8 @@ class TagFileInfo
     QCString filename;
     TagAnchorInfoList docAnchors;
     QList<TagMemberInfo> members;
-    QStringList classList;
-    QStringList namespaceList;
+    TagStringList classList;
+    TagStringList namespaceList;
     QList<TagIncludeInfo> includes;
 };
 
@@ -172,12 +226,12 @@ class TagGroupInfo
     QCString filename;
     TagAnchorInfoList docAnchors;
     QList<TagMemberInfo> members;
-    QStringList subgroupList;
-    QStringList classList;
-    QStringList namespaceList;
-    QStringList fileList;
-    QStringList pageList;
-    QStringList dirList;
+    TagStringList subgroupList;
+    TagStringList classList;
+    TagStringList namespaceList;
+    TagStringList fileList;
+    TagStringList pageList;
+    TagStringList dirList;
 };
 
 /** Container for page specific info that can be read from a tagfile */
@@ -197,18 +251,22 @@ class TagDirInfo
     QCString name;
     QCString filename;
     QCString path;
-    QStringList subdirList;
-    QStringList fileList;
+    TagStringList subdirList;
+    TagStringList fileList;
     TagAnchorInfoList docAnchors;
 };
 
+class TagIndexWriter;
+class TagIndexReader;
+
 /** Tag file parser. 
  *
- *  Reads an XML-structured tagfile and builds up the structure in
- *  memory. The method buildLists() is used to transfer/translate 
+ *  Receives the elements of an XML-structured tagfile from a 
+ *  TagFileReader and builds up the structure in memory. 
+ *  The method buildLists() is used to transfer/translate 
  *  the structures to the doxygen engine.
  */
-class TagFileParser : public QXmlDefaultHandler
+class TagFileParser
 {
     enum State { Invalid,
                  InClass,
@@ -224,10 +282,10 @@ class TagFileParser : public QXmlDefaultHandler
                };
     class StartElementHandler
     {
-        typedef void (TagFileParser::*Handler)(const QXmlAttributes &attrib); 
+        typedef void (TagFileParser::*Handler)(const TagAttributes &attrib); 
       public:
         StartElementHandler(TagFileParser *parent, Handler h) : m_parent(parent), m_handler(h) {}
-        void operator()(const QXmlAttributes &attrib) { (m_parent->*m_handler)(attrib); }
+        void operator()(const TagAttributes &attrib) { (m_parent->*m_handler)(attrib); }
       private:
         TagFileParser *m_parent;
         Handler m_handler;
@@ -251,6 +309,14 @@ class TagFileParser : public QXmlDefaultHandler
     {
       m_startElementHandlers.setAutoDelete(TRUE);
       m_endElementHandlers.setAutoDelete(TRUE);
+      m_stateStack.setAutoDelete(TRUE);
+      m_tagFileClasses.setAutoDelete(TRUE);
+      m_tagFileFiles.setAutoDelete(TRUE);
+      m_tagFileNamespaces.setAutoDelete(TRUE);
+      m_tagFileGroups.setAutoDelete(TRUE);
+      m_tagFilePages.setAutoDelete(TRUE);
+      m_tagFilePackages.setAutoDelete(TRUE);
+      m_tagFileDirs.setAutoDelete(TRUE);
       m_curClass=0;
       m_curFile=0;
       m_curNamespace=0;
@@ -262,33 +328,38 @@ class TagFileParser : public QXmlDefaultHandler
       m_curEnumValue=0;
       m_curIncludes=0;
       m_state = Invalid;
-      m_locator = 0;
+      m_lineNr = 1;
+    }
+
+    void setLineNumber(int lineNr)
+    {
+      m_lineNr = lineNr;
     }
 
-    void setDocumentLocator ( QXmlLocator * locator )
+    void setFileName( const QCString &fileName )
     {
-      m_locator = locator;
+      m_inputFileName = fileName;
     }
 
-    void setFileName( const QString &fileName )
+    const QCString &fileName() const
     {
-      m_inputFileName = fileName.utf8();
+      return m_inputFileName;
     }
 
     void warn(const char *fmt)
     {
-      ::warn(m_inputFileName,m_locator->lineNumber(),fmt);
+      ::warn(m_inputFileName,m_lineNr,fmt);
     }
     void warn(const char *fmt,const char *s)
     {
-      ::warn(m_inputFileName,m_locator->lineNumber(),fmt,s);
+      ::warn(m_inputFileName,m_lineNr,fmt,s);
     }
 
-    void startCompound( const QXmlAttributes& attrib )
+    void startCompound( const TagAttributes& attrib )
     {
       m_curString = "";
-      QString kind = attrib.value("kind");
-      QString isObjC = attrib.value("objc");
+      QCString kind = attrib.value("kind");
+      QCString isObjC = attrib.value("objc");
       if (kind=="class")
       {
         m_curClass = new TagClassInfo;
@@ -413,13 +484,13 @@ class TagFileParser : public QXmlDefaultHandler
       }
     }
 
-    void startMember( const QXmlAttributes& attrib)
+    void startMember( const TagAttributes& attrib)
     {
       m_curMember = new TagMemberInfo;
-      m_curMember->kind = attrib.value("kind").utf8();
-      QCString protStr   = attrib.value("protection").utf8();
-      QCString virtStr   = attrib.value("virtualness").utf8();
-      QCString staticStr = attrib.value("static").utf8();
+      m_curMember->kind = attrib.value("kind");
+      QCString protStr   = attrib.value("protection");
+      QCString virtStr   = attrib.value("virtualness");
+      QCString staticStr = attrib.value("static");
       if (protStr=="protected")
       {
         m_curMember->prot = Protected;
@@ -459,15 +530,15 @@ class TagFileParser : public QXmlDefaultHandler
       }
     }
 
-    void startEnumValue( const QXmlAttributes& attrib)
+    void startEnumValue( const TagAttributes& attrib)
     {
       if (m_state==InMember)
       {
         m_curString = "";
         m_curEnumValue = new TagEnumValueInfo;
-        m_curEnumValue->file = attrib.value("file").utf8();
-        m_curEnumValue->anchor = attrib.value("anchor").utf8();
-        m_curEnumValue->clangid = attrib.value("clangid").utf8();
+        m_curEnumValue->file = attrib.value("file");
+        m_curEnumValue->anchor = attrib.value("anchor");
+        m_curEnumValue->clangid = attrib.value("clangid");
         m_stateStack.push(new State(m_state));
         m_state = InEnumValue;
       }
@@ -557,15 +628,15 @@ class TagFileParser : public QXmlDefaultHandler
       }
     }
 
-    void startStringValue(const QXmlAttributes& )
+    void startStringValue(const TagAttributes& )
     {
       m_curString = "";
     }
 
-    void startDocAnchor(const QXmlAttributes& attrib )
+    void startDocAnchor(const TagAttributes& attrib )
     {
-      m_fileName = attrib.value("file").utf8();
-      m_title = attrib.value("title").utf8();
+      m_fileName = attrib.value("file");
+      m_title = attrib.value("title");
       m_curString = "";
     }
 
@@ -597,13 +668,13 @@ class TagFileParser : public QXmlDefaultHandler
       }
     }
 
-    void startBase(const QXmlAttributes& attrib )
+    void startBase(const TagAttributes& attrib )
     {
       m_curString="";
       if (m_state==InClass && m_curClass)
       {
-        QString protStr = attrib.value("protection");
-        QString virtStr = attrib.value("virtualness");
+        QCString protStr = attrib.value("protection");
+        QCString virtStr = attrib.value("virtualness");
         Protection prot = Public;
         Specifier  virt = Normal;
         if (protStr=="protected")
@@ -643,15 +714,15 @@ class TagFileParser : public QXmlDefaultHandler
       }
     }
 
-    void startIncludes(const QXmlAttributes& attrib )
+    void startIncludes(const TagAttributes& attrib )
     {
       if (m_state==InFile && m_curFile)
       {
         m_curIncludes = new TagIncludeInfo;
-        m_curIncludes->id = attrib.value("id").utf8();
-        m_curIncludes->name = attrib.value("name").utf8();
-        m_curIncludes->isLocal = attrib.value("local").utf8()=="yes" ? TRUE : FALSE;
-        m_curIncludes->isImported = attrib.value("imported").utf8()=="yes" ? TRUE : FALSE;
+        m_curIncludes->id = attrib.value("id");
+        m_curIncludes->name = attrib.value("name");
+        m_curIncludes->isLocal = attrib.value("local")=="yes" ? TRUE : FALSE;
+        m_curIncludes->isImported = attrib.value("imported")=="yes" ? TRUE : FALSE;
         m_curFile->includes.append(m_curIncludes);
       }
       else
@@ -787,7 +858,7 @@ class TagFileParser : public QXmlDefaultHandler
       }
     }
 
-    void startIgnoreElement(const QXmlAttributes& )
+    void startIgnoreElement(const TagAttributes& )
     {
     }
 
@@ -795,7 +866,7 @@ class TagFileParser : public QXmlDefaultHandler
     {
     }
 
-    bool startDocument()
+    void startDocument()
     {
       m_state = Invalid;
 
@@ -807,15 +878,6 @@ class TagFileParser : public QXmlDefaultHandler
       m_curPackage=0;
       m_curDir=0;
 
-      m_stateStack.setAutoDelete(TRUE);
-      m_tagFileClasses.setAutoDelete(TRUE);
-      m_tagFileFiles.setAutoDelete(TRUE);
-      m_tagFileNamespaces.setAutoDelete(TRUE);
-      m_tagFileGroups.setAutoDelete(TRUE);
-      m_tagFilePages.setAutoDelete(TRUE);
-      m_tagFilePackages.setAutoDelete(TRUE);
-      m_tagFileDirs.setAutoDelete(TRUE);
-
       m_startElementHandlers.insert("compound",    new StartElementHandler(this,&TagFileParser::startCompound));
       m_startElementHandlers.insert("member",      new StartElementHandler(this,&TagFileParser::startMember));
       m_startElementHandlers.insert("enumvalue",   new StartElementHandler(this,&TagFileParser::startEnumValue));
@@ -863,52 +925,63 @@ class TagFileParser : public QXmlDefaultHandler
       m_endElementHandlers.insert("tagfile",     new EndElementHandler(this,&TagFileParser::endIgnoreElement));
       m_endElementHandlers.insert("templarg",    new EndElementHandler(this,&TagFileParser::endTemplateArg));
       m_endElementHandlers.insert("type",        new EndElementHandler(this,&TagFileParser::endType));
-
-      return TRUE;
     }
 
-    bool startElement( const QString&, const QString&, 
-                       const QString&name, const QXmlAttributes& attrib )
+    void startElement( const char *name, const TagAttributes& attrib )
     {
-      //printf("startElement `%s'\n",name.data());
-      StartElementHandler *handler = m_startElementHandlers[name.utf8()];
+      //printf("startElement `%s'\n",name);
+      StartElementHandler *handler = m_startElementHandlers[name];
       if (handler)
       {
         (*handler)(attrib);
       }
       else 
       {
-        warn("Unknown tag `%s' found!\n",name.data());
+        warn("Unknown tag `%s' found!\n",name);
       }
-      return TRUE;
     }
 
-    bool endElement( const QString&, const QString&, const QString& name )
+    void endElement( const char *name )
     {
-      //printf("endElement `%s'\n",name.data());
-      EndElementHandler *handler = m_endElementHandlers[name.utf8()];
+      //printf("endElement `%s'\n",name);
+      EndElementHandler *handler = m_endElementHandlers[name];
       if (handler)
       {
         (*handler)();
       }
       else 
       {
-        warn("Unknown tag `%s' found!\n",name.data());
+        warn("Unknown tag `%s' found!\n",name);
       }
-      return TRUE;
     }
 
-    bool characters ( const QString & ch ) 
+    void characters( const char *ch, int len )
     {
-      m_curString+=ch.utf8();
-      return TRUE;
+      appendBytes(m_curString,ch,len);
+    }
+
+    void clear()
+    {
+      m_tagFileClasses.clear();
+      m_tagFileFiles.clear();
+      m_tagFileNamespaces.clear();
+      m_tagFileGroups.clear();
+      m_tagFilePages.clear();
+      m_tagFilePackages.clear();
+      m_tagFileDirs.clear();
     }
 
     void dump();
     void buildLists(Entry *root);
     void addIncludes();
+    void writeIndex(TagIndexWriter &w);
+    bool readIndex(TagIndexReader &r);
     
   private:
+    void writeMembers(TagIndexWriter &w,const QList<TagMemberInfo> &members);
+    void readMembers(TagIndexReader &r,QList<TagMemberInfo> &members);
+    void writeDocAnchors(TagIndexWriter &w,const TagAnchorInfoList &l);
+    void readDocAnchors(TagIndexReader &r,TagAnchorInfoList &l);
     void buildMemberList(Entry *ce,QList<TagMemberInfo> &members);
     void addDocAnchors(Entry *e,const TagAnchorInfoList &l);
     QList<TagClassInfo>        m_tagFileClasses;
@@ -936,39 +1009,337 @@ class TagFileParser : public QXmlDefaultHandler
     QCString                   m_title;
     State                      m_state;
     QStack<State>              m_stateStack;
-    QXmlLocator               *m_locator;
+    int                        m_lineNr;
     QCString                   m_inputFileName;
 };
 
-/** Error handler for the XML tag file parser. 
+//---------------------------------------------------------------------------
+
+/** Reader for XML-structured tag files.
  *
- *  Basically dumps all fatal error to stderr using err().
+ *  Tag files are written by doxygen itself and only use a small subset of
+ *  XML: elements, attributes, character data, comments and the predefined
+ *  and numeric character references. Instead of going through a generic
+ *  SAX parser, which decodes the whole file to UTF-16, this reader reads
+ *  the file with a single block read and scans the UTF-8 bytes directly,
+ *  passing elements and text on to a TagFileParser.
  */
-class TagFileErrorHandler : public QXmlErrorHandler
+class TagFileReader
 {
   public:
-    virtual ~TagFileErrorHandler() {}
-    bool warning( const QXmlParseException & )
+    TagFileReader(TagFileParser &parser,const char *fileName)
+      : m_parser(parser), m_fileName(fileName), m_pos(0), m_end(0), m_lineNr(1) {}
+
+    /** Reads and parses the file. Returns FALSE if the file could not
+     *  be read or is not well-formed.
+     */
+    bool parse()
     {
-      return FALSE;
+      FILE *f = portable_fopen(m_fileName,"rb");
+      if (f==0)
+      {
+        err("Could not open tag file %s for reading\n",m_fileName.data());
+        return FALSE;
+      }
+      fseek(f,0,SEEK_END);
+      long size = ftell(f);
+      fseek(f,0,SEEK_SET);
+      if (size<0) size=0;
+      QCString contents((int)size+1);
+      size = (long)fread(contents.rawData(),1,size,f);
+      fclose(f);
+      contents.rawData()[size]='\0';
+      return parseBuffer(contents.data(),(int)size);
     }
-    bool error( const QXmlParseException & )
+
+  private:
+    bool parseBuffer(const char *buf,int size)
     {
+      m_pos = buf;
+      m_end = buf+size;
+      m_lineNr = 1;
+      // skip UTF-8 byte order mark
+      if (size>=3 && (uchar)buf[0]==0xEF && (uchar)buf[1]==0xBB && (uchar)buf[2]==0xBF)
+      {
+        m_pos+=3;
+      }
+      m_parser.startDocument();
+      int depth=0;
+      while (m_pos<m_end)
+      {
+        if (*m_pos!='<')
+        {
+          if (!readText()) return FALSE;
+        }
+        else if (startsWith("<?"))
+        {
+          if (!skipPast("?>")) return fatal("unterminated processing instruction");
+        }
+        else if (startsWith("<!--"))
+        {
+          if (!skipPast("-->")) return fatal("unterminated comment");
+        }
+        else if (startsWith("<![CDATA["))
+        {
+          m_pos+=9;
+          const char *start=m_pos;
+          if (!skipPast("]]>")) return fatal("unterminated CDATA section");
+          m_parser.characters(start,(int)(m_pos-start-3));
+        }
+        else if (startsWith("<!"))
+        {
+          if (!skipPast(">")) return fatal("unterminated declaration");
+        }
+        else if (startsWith("</"))
+        {
+          m_pos+=2;
+          if (!readName(m_name)) return fatal("expected element name");
+          skipSpaces();
+          if (m_pos>=m_end || *m_pos!='>') return fatal("expected '>'");
+          m_pos++;
+          if (--depth<0) return fatal("unexpected end tag");
+          m_parser.setLineNumber(m_lineNr);
+          m_parser.endElement(m_name);
+        }
+        else
+        {
+          m_pos++;
+          if (!readName(m_name)) return fatal("expected element name");
+          m_attribs.clear();
+          bool empty=FALSE;
+          for (;;)
+          {
+            skipSpaces();
+            if (m_pos>=m_end) return fatal("unexpected end of file");
+            if (*m_pos=='>')
+            {
+              m_pos++;
+              break;
+            }
+            else if (*m_pos=='/' && m_pos+1<m_end && m_pos[1]=='>')
+            {
+              m_pos+=2;
+              empty=TRUE;
+              break;
+            }
+            else if (!readAttribute())
+            {
+              return FALSE;
+            }
+          }
+          m_parser.setLineNumber(m_lineNr);
+          m_parser.startElement(m_name,m_attribs);
+          if (empty)
+          {
+            m_parser.endElement(m_name);
+          }
+          else
+          {
+            depth++;
+          }
+        }
+      }
+      if (depth!=0) return fatal("unexpected end of file");
+      return TRUE;
+    }
+
+    bool fatal(const char *msg)
+    {
+      err("Fatal error at line %d of tag file %s: %s\n",
+          m_lineNr,m_fileName.data(),msg);
       return FALSE;
     }
-    bool fatalError( const QXmlParseException &exception )
+
+    bool startsWith(const char *s) const
     {
-      err("Fatal error at line %d column %d: %s\n",
-          exception.lineNumber(),exception.columnNumber(),
-          exception.message().data());
+      const char *p=m_pos;
+      while (*s && p<m_end && *p==*s) p++,s++;
+      return *s==0;
+    }
+
+    /** Moves the read position past the first occurrence of \a s */
+    bool skipPast(const char *s)
+    {
+      char c=*s;
+      while (m_pos<m_end)
+      {
+        if (*m_pos==c && startsWith(s))
+        {
+          m_pos+=qstrlen(s);
+          return TRUE;
+        }
+        if (*m_pos=='\n') m_lineNr++;
+        m_pos++;
+      }
       return FALSE;
     }
-    QString errorString() { return ""; }
 
-  private:
-    QString errorMsg;
+    void skipSpaces()
+    {
+      while (m_pos<m_end && (*m_pos==' ' || *m_pos=='\t' || *m_pos=='\r' || *m_pos=='\n'))
+      {
+        if (*m_pos=='\n') m_lineNr++;
+        m_pos++;
+      }
+    }
+
+    static bool isNameChar(char c)
+    {
+      return (c>='a' && c<='z') || (c>='A' && c<='Z') || (c>='0' && c<='9') ||
+             c=='_' || c=='-' || c=='.' || c==':' || (c&0x80);
+    }
+
+    /** Reads a name into \a name, which has room for MaxNameLen characters */
+    bool readName(char *name)
+    {
+      int len=0;
+      while (m_pos<m_end && isNameChar(*m_pos))
+      {
+        if (len<MaxNameLen) name[len++]=*m_pos;
+        m_pos++;
+      }
+      name[len]='\0';
+      return len>0;
+    }
+
+    bool readAttribute()
+    {
+      char name[MaxNameLen+1];
+      if (!readName(name)) return fatal("expected attribute name");
+      skipSpaces();
+      if (m_pos>=m_end || *m_pos!='=') return fatal("expected '=' after attribute name");
+      m_pos++;
+      skipSpaces();
+      if (m_pos>=m_end || (*m_pos!='"' && *m_pos!='\'')) return fatal("expected quoted attribute value");
+      char quote=*m_pos++;
+      QCString value;
+      while (m_pos<m_end && *m_pos!=quote)
+      {
+        const char *start=m_pos;
+        while (m_pos<m_end && *m_pos!=quote && *m_pos!='&')
+        {
+          if (*m_pos=='\n') m_lineNr++;
+          m_pos++;
+        }
+        appendBytes(value,start,(int)(m_pos-start));
+        if (m_pos<m_end && *m_pos=='&')
+        {
+          char ent[8];
+          int len=readReference(ent);
+          if (len<0) return FALSE;
+          appendBytes(value,ent,len);
+        }
+      }
+      if (m_pos>=m_end) return fatal("unterminated attribute value");
+      m_pos++;
+      if (!m_attribs.append(name,value))
+      {
+        return fatal("too many attributes");
+      }
+      return TRUE;
+    }
+
+    bool readText()
+    {
+      while (m_pos<m_end && *m_pos!='<')
+      {
+        const char *start=m_pos;
+        while (m_pos<m_end && *m_pos!='<' && *m_pos!='&')
+        {
+          if (*m_pos=='\n') m_lineNr++;
+          m_pos++;
+        }
+        if (m_pos>start) m_parser.characters(start,(int)(m_pos-start));
+        if (m_pos<m_end && *m_pos=='&')
+        {
+          char ent[8];
+          int len=readReference(ent);
+          if (len<0) return FALSE;
+          m_parser.characters(ent,len);
+        }
+      }
+      return TRUE;
+    }
+
+    /** Decodes the character reference at the read position into its
+     *  UTF-8 representation in \a out. Returns the number of bytes
+     *  written or -1 in case of an error.
+     */
+    int readReference(char *out)
+    {
+      const char *start=++m_pos;
+      while (m_pos<m_end && *m_pos!=';' && m_pos-start<12) m_pos++;
+      if (m_pos>=m_end || *m_pos!=';') { fatal("unterminated character reference"); return -1; }
+      int len=(int)(m_pos-start);
+      m_pos++;
+      if      (len==2 && qstrncmp(start,"lt",2)==0)   { out[0]='<';  return 1; }
+      else if (len==2 && qstrncmp(start,"gt",2)==0)   { out[0]='>';  return 1; }
+      else if (len==3 && qstrncmp(start,"amp",3)==0)  { out[0]='&';  return 1; }
+      else if (len==4 && qstrncmp(start,"quot",4)==0) { out[0]='"';  return 1; }
+      else if (len==4 && qstrncmp(start,"apos",4)==0) { out[0]='\''; return 1; }
+      else if (len>1 && start[0]=='#')
+      {
+        uint code=0;
+        int i=1;
+        bool hex = start[1]=='x' || start[1]=='X';
+        if (hex) i++;
+        if (i==len) { fatal("invalid character reference"); return -1; }
+        for (;i<len;i++)
+        {
+          char c=start[i];
+          if      (c>='0' && c<='9')        code=code*(hex?16:10)+(c-'0');
+          else if (hex && c>='a' && c<='f') code=code*16+(c-'a'+10);
+          else if (hex && c>='A' && c<='F') code=code*16+(c-'A'+10);
+          else { fatal("invalid character reference"); return -1; }
+        }
+        return encodeUtf8(code,out);
+      }
+      fatal("unknown entity");
+      return -1;
+    }
+
+    static int encodeUtf8(uint code,char *out)
+    {
+      if (code<0x80)
+      {
+        out[0]=(char)code;
+        return 1;
+      }
+      else if (code<0x800)
+      {
+        out[0]=(char)(0xC0|(code>>6));
+        out[1]=(char)(0x80|(code&0x3F));
+        return 2;
+      }
+      else if (code<0x10000)
+      {
+        out[0]=(char)(0xE0|(code>>12));
+        out[1]=(char)(0x80|((code>>6)&0x3F));
+        out[2]=(char)(0x80|(code&0x3F));
+        return 3;
+      }
+      else
+      {
+        out[0]=(char)(0xF0|((code>>18)&0x07));
+        out[1]=(char)(0x80|((code>>12)&0x3F));
+        out[2]=(char)(0x80|((code>>6)&0x3F));
+        out[3]=(char)(0x80|(code&0x3F));
+        return 4;
+      }
+    }
+
+    enum { MaxNameLen = 63 };
+    TagFileParser &m_parser;
+    QCString       m_fileName;
+    const char    *m_pos;
+    const char    *m_end;
+    int            m_lineNr;
+    char           m_name[MaxNameLen+1];
+    TagAttributes  m_attribs;
 };
 
+//---------------------------------------------------------------------------
+
 /*! Dumps the internal structures. For debugging only! */
 void TagFileParser::dump()
 {
@@ -1009,11 +1380,11 @@ void TagFileParser::dump()
   {
     msg("namespace `%s'\n",nd->name.data());
     msg("  filename `%s'\n",nd->filename.data());
-    QStringList::Iterator it;
+    TagStringList::Iterator it;
     for ( it = nd->classList.begin(); 
         it != nd->classList.end(); ++it ) 
     {
-      msg( "  class: %s \n", (*it).latin1() );
+      msg( "  class: %s \n", (*it).data() );
     }
 
     QListIterator<TagMemberInfo> mci(nd->members);
@@ -1034,16 +1405,16 @@ void TagFileParser::dump()
   {
     msg("file `%s'\n",fd->name.data());
     msg("  filename `%s'\n",fd->filename.data());
-    QStringList::Iterator it;
+    TagStringList::Iterator it;
     for ( it = fd->namespaceList.begin(); 
         it != fd->namespaceList.end(); ++it ) 
     {
-      msg( "  namespace: %s \n", (*it).latin1() );
+      msg( "  namespace: %s \n", (*it).data() );
     }
     for ( it = fd->classList.begin(); 
         it != fd->classList.end(); ++it ) 
     {
-      msg( "  class: %s \n", (*it).latin1() );
+      msg( "  class: %s \n", (*it).data() );
     }
 
     QListIterator<TagMemberInfo> mci(fd->members);
@@ -1072,31 +1443,31 @@ void TagFileParser::dump()
   {
     msg("group `%s'\n",gd->name.data());
     msg("  filename `%s'\n",gd->filename.data());
-    QStringList::Iterator it;
+    TagStringList::Iterator it;
     for ( it = gd->namespaceList.begin(); 
         it != gd->namespaceList.end(); ++it ) 
     {
-      msg( "  namespace: %s \n", (*it).latin1() );
+      msg( "  namespace: %s \n", (*it).data() );
     }
     for ( it = gd->classList.begin(); 
         it != gd->classList.end(); ++it ) 
     {
-      msg( "  class: %s \n", (*it).latin1() );
+      msg( "  class: %s \n", (*it).data() );
     }
     for ( it = gd->fileList.begin(); 
         it != gd->fileList.end(); ++it ) 
     {
-      msg( "  file: %s \n", (*it).latin1() );
+      msg( "  file: %s \n", (*it).data() );
     }
     for ( it = gd->subgroupList.begin(); 
         it != gd->subgroupList.end(); ++it ) 
     {
-      msg( "  subgroup: %s \n", (*it).latin1() );
+      msg( "  subgroup: %s \n", (*it).data() );
     }
     for ( it = gd->pageList.begin(); 
         it != gd->pageList.end(); ++it ) 
     {
-      msg( "  page: %s \n", (*it).latin1() );
+      msg( "  page: %s \n", (*it).data() );
     }
 
     QListIterator<TagMemberInfo> mci(gd->members);
@@ -1126,16 +1497,16 @@ void TagFileParser::dump()
   {
     msg("dir `%s'\n",dd->name.data());
     msg("  path `%s'\n",dd->path.data());
-    QStringList::Iterator it;
+    TagStringList::Iterator it;
     for ( it = dd->fileList.begin(); 
         it != dd->fileList.end(); ++it ) 
     {
-      msg( "  file: %s \n", (*it).latin1() );
+      msg( "  file: %s \n", (*it).data() );
     }
     for ( it = dd->subdirList.begin(); 
         it != dd->subdirList.end(); ++it ) 
     {
-      msg( "  subdir: %s \n", (*it).latin1() );
+      msg( "  subdir: %s \n", (*it).data() );
     }
   }
 }
@@ -1524,22 +1895,756 @@ void TagFileParser::addIncludes()
   }
 }
 
-void parseTagFile(Entry *root,const char *fullName)
+//---------------------------------------------------------------------------
+
+#define TAG_INDEX_MAGIC   (('D'<<24)+('X'<<16)+('T'<<8)+'I')
+#define TAG_INDEX_VERSION 1
+
+/** Writer for the binary index of a tag file.
+ *
+ *  The index consists of a header, a pool with each distinct string 
+ *  stored once, and a record section in which the compounds and members 
+ *  refer to strings by their index in the pool. All integers are
+ *  stored as 4 byte big-endian values.
+ */
+class TagIndexWriter
+{
+  public:
+    TagIndexWriter(int expectedSize) 
+      : m_pool(QMAX(1009,expectedSize/64)|1), 
+        m_strings(QMAX(1024,expectedSize/4)), 
+        m_records(QMAX(1024,expectedSize/4)),
+        m_numStrings(0)
+    {
+      m_pool.setAutoDelete(TRUE);
+      addString(""); // id 0 is the empty string
+    }
+    void writeInt(int v)
+    {
+      appendInt(m_records,v);
+    }
+    void writeBool(bool b)
+    {
+      m_records.addChar(b ? 1 : 0);
+    }
+    void writeString(const QCString &str)
+    {
+      if (str.isEmpty())
+      {
+        writeInt(0);
+        return;
+      }
+      int *id = m_pool.find(str);
+      writeInt(id ? *id : addString(str));
+    }
+    void writeStringList(const TagStringList &l)
+    {
+      writeInt(l.count());
+      TagStringList::ConstIterator it;
+      for (it=l.begin();it!=l.end();++it) writeString(*it);
+    }
+    bool save(const char *fileName,uint xmlSize)
+    {
+      QFile f(fileName);
+      if (!f.open(IO_WriteOnly))
+      {
+        err("Could not open %s for writing\n",fileName);
+        return FALSE;
+      }
+      BufStr header(24);
+      appendInt(header,TAG_INDEX_MAGIC);
+      appendInt(header,TAG_INDEX_VERSION);
+      appendInt(header,xmlSize);
+      appendInt(header,m_numStrings);
+      appendInt(header,m_strings.curPos());
+      appendInt(header,m_records.curPos());
+      bool ok = f.writeBlock(header.data(),header.curPos())==(int)header.curPos() &&
+                f.writeBlock(m_strings.data(),m_strings.curPos())==(int)m_strings.curPos() &&
+                f.writeBlock(m_records.data(),m_records.curPos())==(int)m_records.curPos();
+      if (!ok)
+      {
+        err("Failed to write tag file index %s\n",fileName);
+      }
+      return ok;
+    }
+
+  private:
+    static void appendInt(BufStr &buf,uint v)
+    {
+      char b[4];
+      b[0]=(char)(v>>24);
+      b[1]=(char)((v>>16)&0xff);
+      b[2]=(char)((v>>8)&0xff);
+      b[3]=(char)(v&0xff);
+      buf.addArray(b,4);
+    }
+    int addString(const QCString &str)
+    {
+      int id = m_numStrings++;
+      if (id>0) m_pool.insert(str,new int(id));
+      appendInt(m_strings,str.length());
+      m_strings.addArray(str.data(),str.length());
+      return id;
+    }
+    QDict<int> m_pool;
+    BufStr m_strings;
+    BufStr m_records;
+    int m_numStrings;
+};
+
+/** Reader for the binary index of a tag file written by TagIndexWriter.
+ *
+ *  The whole index is read with a single block read. Strings that occur 
+ *  multiple times share the same QCString data after loading.
+ */
+class TagIndexReader
+{
+  public:
+    TagIndexReader() : m_pos(0), m_end(0), m_strings(0), m_numStrings(0), m_error(FALSE) {}
+   ~TagIndexReader() { delete[] m_strings; }
+    bool open(const char *fileName)
+    {
+      FILE *f = portable_fopen(fileName,"rb");
+      if (f==0) return FALSE;
+      fseek(f,0,SEEK_END);
+      long size = ftell(f);
+      fseek(f,0,SEEK_SET);
+      if (size<24) { fclose(f); return FALSE; }
+      m_contents.resize((int)size+1);
+      size = (long)fread(m_contents.rawData(),1,size,f);
+      fclose(f);
+      m_pos = m_contents.data();
+      m_end = m_pos+size;
+      if ((uint)readInt()!=TAG_INDEX_MAGIC || readInt()!=TAG_INDEX_VERSION)
+      {
+        return FALSE;
+      }
+      m_xmlSize        = (uint)readInt();
+      m_numStrings     = readInt();
+      int stringBytes  = readInt();
+      int recordBytes  = readInt();
+      if (m_numStrings<1 || stringBytes<0 || recordBytes<0 ||
+          m_end-m_pos!=(long)stringBytes+recordBytes)
+      {
+        return FALSE;
+      }
+      m_strings = new QCString[m_numStrings];
+      int i;
+      for (i=0;i<m_numStrings && !m_error;i++)
+      {
+        int len = readInt();
+        if (len<0 || m_end-m_pos<len)
+        {
+          m_error=TRUE;
+        }
+        else if (len>0)
+        {
+          appendBytes(m_strings[i],m_pos,len);
+          m_pos+=len;
+        }
+      }
+      return !m_error;
+    }
+    /** Returns the size of the XML tag file the index was made for */
+    uint xmlSize() const { return m_xmlSize; }
+    bool hasError() const { return m_error; }
+    bool atEnd() const { return m_pos==m_end; }
+    int readInt()
+    {
+      if (m_end-m_pos<4) { m_error=TRUE; return 0; }
+      const uchar *b = (const uchar *)m_pos;
+      m_pos+=4;
+      return (int)(((uint)b[0]<<24)+((uint)b[1]<<16)+((uint)b[2]<<8)+(uint)b[3]);
+    }
+    bool readBool()
+    {
+      if (m_pos>=m_end) { m_error=TRUE; return FALSE; }
+      return *m_pos++!=0;
+    }
+    QCString readString()
+    {
+      int id = readInt();
+      if (id<0 || id>=m_numStrings) { m_error=TRUE; return QCString(); }
+      return m_strings[id];
+    }
+    void readStringList(TagStringList &l)
+    {
+      int i,count = readCount();
+      for (i=0;i<count;i++) l.append(readString());
+    }
+    /** Reads an element count, which is bounded by the remaining size */
+    int readCount()
+    {
+      int count = readInt();
+      if (count<0 || count>m_end-m_pos) { m_error=TRUE; return 0; }
+      return count;
+    }
+
+  private:
+    QCString m_contents;
+    const char *m_pos;
+    const char *m_end;
+    QCString *m_strings;
+    int m_numStrings;
+    uint m_xmlSize;
+    bool m_error;
+};
+
+void TagFileParser::writeDocAnchors(TagIndexWriter &w,const TagAnchorInfoList &l)
+{
+  w.writeInt(l.count());
+  QListIterator<TagAnchorInfo> tli(l);
+  TagAnchorInfo *ta;
+  for (;(ta=tli.current());++tli)
+  {
+    w.writeString(ta->label);
+    w.writeString(ta->fileName);
+    w.writeString(ta->title);
+  }
+}
+
+void TagFileParser::readDocAnchors(TagIndexReader &r,TagAnchorInfoList &l)
+{
+  int i,count = r.readCount();
+  for (i=0;i<count && !r.hasError();i++)
+  {
+    QCString label    = r.readString();
+    QCString fileName = r.readString();
+    QCString title    = r.readString();
+    l.append(new TagAnchorInfo(fileName,label,title));
+  }
+}
+
+void TagFileParser::writeMembers(TagIndexWriter &w,const QList<TagMemberInfo> &members)
+{
+  w.writeInt(members.count());
+  QListIterator<TagMemberInfo> mii(members);
+  TagMemberInfo *tmi;
+  for (;(tmi=mii.current());++mii)
+  {
+    w.writeString(tmi->type);
+    w.writeString(tmi->name);
+    w.writeString(tmi->anchorFile);
+    w.writeString(tmi->anchor);
+    w.writeString(tmi->arglist);
+    w.writeString(tmi->kind);
+    w.writeString(tmi->clangId);
+    writeDocAnchors(w,tmi->docAnchors);
+    w.writeInt(tmi->prot);
+    w.writeInt(tmi->virt);
+    w.writeBool(tmi->isStatic);
+    w.writeInt(tmi->enumValues.count());
+    QListIterator<TagEnumValueInfo> evi(tmi->enumValues);
+    TagEnumValueInfo *ev;
+    for (;(ev=evi.current());++evi)
+    {
+      w.writeString(ev->name);
+      w.writeString(ev->file);
+      w.writeString(ev->anchor);
+      w.writeString(ev->clangid);
+    }
+  }
+}
+
+void TagFileParser::readMembers(TagIndexReader &r,QList<TagMemberInfo> &members)
+{
+  int i,count = r.readCount();
+  for (i=0;i<count && !r.hasError();i++)
+  {
+    TagMemberInfo *tmi = new TagMemberInfo;
+    tmi->type       = r.readString();
+    tmi->name       = r.readString();
+    tmi->anchorFile = r.readString();
+    tmi->anchor     = r.readString();
+    tmi->arglist    = r.readString();
+    tmi->kind       = r.readString();
+    tmi->clangId    = r.readString();
+    readDocAnchors(r,tmi->docAnchors);
+    tmi->prot       = (Protection)r.readInt();
+    tmi->virt       = (Specifier)r.readInt();
+    tmi->isStatic   = r.readBool();
+    int j,numValues = r.readCount();
+    for (j=0;j<numValues && !r.hasError();j++)
+    {
+      TagEnumValueInfo *ev = new TagEnumValueInfo;
+      ev->name    = r.readString();
+      ev->file    = r.readString();
+      ev->anchor  = r.readString();
+      ev->clangid = r.readString();
+      tmi->enumValues.append(ev);
+    }
+    members.append(tmi);
+  }
+}
+
+/*! Writes the structures read from the tag file as a binary index */
+void TagFileParser::writeIndex(TagIndexWriter &w)
+{
+  // classes
+  w.writeInt(m_tagFileClasses.count());
+  QListIterator<TagClassInfo> cit(m_tagFileClasses);
+  TagClassInfo *tci;
+  for (;(tci=cit.current());++cit)
+  {
+    w.writeInt(tci->kind);
+    w.writeBool(tci->isObjC);
+    w.writeString(tci->name);
+    w.writeString(tci->filename);
+    w.writeString(tci->clangId);
+    writeDocAnchors(w,tci->docAnchors);
+    if (tci->bases)
+    {
+      w.writeInt(tci->bases->count());
+      QListIterator<BaseInfo> bii(*tci->bases);
+      BaseInfo *bi;
+      for (;(bi=bii.current());++bii)
+      {
+        w.writeString(bi->name);
+        w.writeInt(bi->prot);
+        w.writeInt(bi->virt);
+      }
+    }
+    else
+    {
+      w.writeInt(-1);
+    }
+    if (tci->templateArguments)
+    {
+      w.writeInt(tci->templateArguments->count());
+      QListIterator<QCString> sli(*tci->templateArguments);
+      QCString *argName;
+      for (;(argName=sli.current());++sli)
+      {
+        w.writeString(*argName);
+      }
+    }
+    else
+    {
+      w.writeInt(-1);
+    }
+    writeMembers(w,tci->members);
+    w.writeStringList(tci->classList);
+  }
+
+  // files
+  w.writeInt(m_tagFileFiles.count());
+  QListIterator<TagFileInfo> fit(m_tagFileFiles);
+  TagFileInfo *tfi;
+  for (;(tfi=fit.current());++fit)
+  {
+    w.writeString(tfi->name);
+    w.writeString(tfi->path);
+    w.writeString(tfi->filename);
+    writeDocAnchors(w,tfi->docAnchors);
+    writeMembers(w,tfi->members);
+    w.writeStringList(tfi->classList);
+    w.writeStringList(tfi->namespaceList);
+    w.writeInt(tfi->includes.count());
+    QListIterator<TagIncludeInfo> iii(tfi->includes);
+    TagIncludeInfo *ii;
+    for (;(ii=iii.current());++iii)
+    {
+      w.writeString(ii->id);
+      w.writeString(ii->name);
+      w.writeString(ii->text);
+      w.writeBool(ii->isLocal);
+      w.writeBool(ii->isImported);
+    }
+  }
+
+  // namespaces
+  w.writeInt(m_tagFileNamespaces.count());
+  QListIterator<TagNamespaceInfo> nit(m_tagFileNamespaces);
+  TagNamespaceInfo *tni;
+  for (;(tni=nit.current());++nit)
+  {
+    w.writeString(tni->name);
+    w.writeString(tni->filename);
+    w.writeString(tni->clangId);
+    w.writeStringList(tni->classList);
+    w.writeStringList(tni->namespaceList);
+    writeDocAnchors(w,tni->docAnchors);
+    writeMembers(w,tni->members);
+  }
+
+  // groups
+  w.writeInt(m_tagFileGroups.count());
+  QListIterator<TagGroupInfo> git(m_tagFileGroups);
+  TagGroupInfo *tgi;
+  for (;(tgi=git.current());++git)
+  {
+    w.writeString(tgi->name);
+    w.writeString(tgi->title);
+    w.writeString(tgi->filename);
+    writeDocAnchors(w,tgi->docAnchors);
+    writeMembers(w,tgi->members);
+    w.writeStringList(tgi->subgroupList);
+    w.writeStringList(tgi->classList);
+    w.writeStringList(tgi->namespaceList);
+    w.writeStringList(tgi->fileList);
+    w.writeStringList(tgi->pageList);
+    w.writeStringList(tgi->dirList);
+  }
+
+  // pages
+  w.writeInt(m_tagFilePages.count());
+  QListIterator<TagPageInfo> pit(m_tagFilePages);
+  TagPageInfo *tpi;
+  for (;(tpi=pit.current());++pit)
+  {
+    w.writeString(tpi->name);
+    w.writeString(tpi->title);
+    w.writeString(tpi->filename);
+    writeDocAnchors(w,tpi->docAnchors);
+  }
+
+  // packages
+  w.writeInt(m_tagFilePackages.count());
+  QListIterator<TagPackageInfo> pkit(m_tagFilePackages);
+  TagPackageInfo *tpgi;
+  for (;(tpgi=pkit.current());++pkit)
+  {
+    w.writeString(tpgi->name);
+    w.writeString(tpgi->filename);
+    writeDocAnchors(w,tpgi->docAnchors);
+    writeMembers(w,tpgi->members);
+    w.writeStringList(tpgi->classList);
+  }
+
+  // directories
+  w.writeInt(m_tagFileDirs.count());
+  QListIterator<TagDirInfo> dit(m_tagFileDirs);
+  TagDirInfo *tdi;
+  for (;(tdi=dit.current());++dit)
+  {
+    w.writeString(tdi->name);
+    w.writeString(tdi->filename);
+    w.writeString(tdi->path);
+    w.writeStringList(tdi->subdirList);
+    w.writeStringList(tdi->fileList);
+    writeDocAnchors(w,tdi->docAnchors);
+  }
+}
+
+/*! Reads the structures from a binary index written by writeIndex().
+ *  Returns FALSE if the index is corrupt.
+ */
+bool TagFileParser::readIndex(TagIndexReader &r)
+{
+  int i,j,count;
+
+  // classes
+  count = r.readCount();
+  for (i=0;i<count && !r.hasError();i++)
+  {
+    TagClassInfo *tci = new TagClassInfo;
+    tci->kind     = (TagClassInfo::Kind)r.readInt();
+    tci->isObjC   = r.readBool();
+    tci->name     = r.readString();
+    tci->filename = r.readString();
+    tci->clangId  = r.readString();
+    readDocAnchors(r,tci->docAnchors);
+    int numBases = r.readInt();
+    if (numBases>=0)
+    {
+      tci->bases = new QList<BaseInfo>;
+      tci->bases->setAutoDelete(TRUE);
+      for (j=0;j<numBases && !r.hasError();j++)
+      {
+        QCString name = r.readString();
+        Protection prot = (Protection)r.readInt();
+        Specifier virt = (Specifier)r.readInt();
+        tci->bases->append(new BaseInfo(name,prot,virt));
+      }
+    }
+    int numArgs = r.readInt();
+    if (numArgs>=0)
+    {
+      tci->templateArguments = new QList<QCString>;
+      tci->templateArguments->setAutoDelete(TRUE);
+      for (j=0;j<numArgs && !r.hasError();j++)
+      {
+        tci->templateArguments->append(new QCString(r.readString()));
+      }
+    }
+    readMembers(r,tci->members);
+    r.readStringList(tci->classList);
+    m_tagFileClasses.append(tci);
+  }
+
+  // files
+  count = r.readCount();
+  for (i=0;i<count && !r.hasError();i++)
+  {
+    TagFileInfo *tfi = new TagFileInfo;
+    tfi->name     = r.readString();
+    tfi->path     = r.readString();
+    tfi->filename = r.readString();
+    readDocAnchors(r,tfi->docAnchors);
+    readMembers(r,tfi->members);
+    r.readStringList(tfi->classList);
+    r.readStringList(tfi->namespaceList);
+    int numIncludes = r.readCount();
+    for (j=0;j<numIncludes && !r.hasError();j++)
+    {
+      TagIncludeInfo *ii = new TagIncludeInfo;
+      ii->id         = r.readString();
+      ii->name       = r.readString();
+      ii->text       = r.readString();
+      ii->isLocal    = r.readBool();
+      ii->isImported = r.readBool();
+      tfi->includes.append(ii);
+    }
+    m_tagFileFiles.append(tfi);
+  }
+
+  // namespaces
+  count = r.readCount();
+  for (i=0;i<count && !r.hasError();i++)
+  {
+    TagNamespaceInfo *tni = new TagNamespaceInfo;
+    tni->name     = r.readString();
+    tni->filename = r.readString();
+    tni->clangId  = r.readString();
+    r.readStringList(tni->classList);
+    r.readStringList(tni->namespaceList);
+    readDocAnchors(r,tni->docAnchors);
+    readMembers(r,tni->members);
+    m_tagFileNamespaces.append(tni);
+  }
+
+  // groups
+  count = r.readCount();
+  for (i=0;i<count && !r.hasError();i++)
+  {
+    TagGroupInfo *tgi = new TagGroupInfo;
+    tgi->name     = r.readString();
+    tgi->title    = r.readString();
+    tgi->filename = r.readString();
+    readDocAnchors(r,tgi->docAnchors);
+    readMembers(r,tgi->members);
+    r.readStringList(tgi->subgroupList);
+    r.readStringList(tgi->classList);
+    r.readStringList(tgi->namespaceList);
+    r.readStringList(tgi->fileList);
+    r.readStringList(tgi->pageList);
+    r.readStringList(tgi->dirList);
+    m_tagFileGroups.append(tgi);
+  }
+
+  // pages
+  count = r.readCount();
+  for (i=0;i<count && !r.hasError();i++)
+  {
+    TagPageInfo *tpi = new TagPageInfo;
+    tpi->name     = r.readString();
+    tpi->title    = r.readString();
+    tpi->filename = r.readString();
+    readDocAnchors(r,tpi->docAnchors);
+    m_tagFilePages.append(tpi);
+  }
+
+  // packages
+  count = r.readCount();
+  for (i=0;i<count && !r.hasError();i++)
+  {
+    TagPackageInfo *tpgi = new TagPackageInfo;
+    tpgi->name     = r.readString();
+    tpgi->filename = r.readString();
+    readDocAnchors(r,tpgi->docAnchors);
+    readMembers(r,tpgi->members);
+    r.readStringList(tpgi->classList);
+    m_tagFilePackages.append(tpgi);
+  }
+
+  // directories
+  count = r.readCount();
+  for (i=0;i<count && !r.hasError();i++)
+  {
+    TagDirInfo *tdi = new TagDirInfo;
+    tdi->name     = r.readString();
+    tdi->filename = r.readString();
+    tdi->path     = r.readString();
+    r.readStringList(tdi->subdirList);
+    r.readStringList(tdi->fileList);
+    readDocAnchors(r,tdi->docAnchors);
+    m_tagFileDirs.append(tdi);
+  }
+
+  return !r.hasError() && r.atEnd();
+}
+
+/** Returns the name of the binary index belonging to tag file \a fullName */
+static QCString tagIndexFileName(const char *fullName)
+{
+  return QCString(fullName)+".idx";
+}
+
+/** Returns TRUE if tag file \a fullName has a binary index that is at
+ *  least as recent as the tag file itself.
+ */
+static bool hasUpToDateTagIndex(const char *fullName)
+{
+  QFileInfo xfi(fullName);
+  QFileInfo ifi(tagIndexFileName(fullName));
+  return ifi.exists() && ifi.isFile() && ifi.lastModified()>=xfi.lastModified();
+}
+
+/** Fills \a parser with the contents of tag file \a fullName, using the
+ *  binary index if \a useIndex is TRUE and the index is valid.
+ */
+static void loadTagFile(TagFileParser &parser,const char *fullName,uint xmlSize,bool useIndex)
+{
+  if (useIndex)
+  {
+    TagIndexReader r;
+    if (r.open(tagIndexFileName(fullName)) && r.xmlSize()==xmlSize && parser.readIndex(r))
+    {
+      return;
+    }
+    warn_uncond("binary index %s does not match tag file %s, reading the tag file instead\n",
+        tagIndexFileName(fullName).data(),fullName);
+    parser.clear();
+  }
+  TagFileReader reader(parser,fullName);
+  reader.parse();
+}
+
+void writeTagFileIndex(const char *fullName)
 {
   QFileInfo fi(fullName);
   if (!fi.exists()) return;
-  TagFileParser handler( fullName ); // tagName
-  handler.setFileName(fullName);
-  TagFileErrorHandler errorHandler;
-  QFile xmlFile( fullName );
-  QXmlInputSource source( xmlFile );
-  QXmlSimpleReader reader;
-  reader.setContentHandler( &handler );
-  reader.setErrorHandler( &errorHandler );
-  reader.parse( source );
-  handler.buildLists(root);
-  handler.addIncludes();
-  //handler.dump();
+  uint xmlSize = fi.size();
+  TagFileParser parser(fullName);
+  parser.setFileName(fullName);
+  TagFileReader reader(parser,fullName);
+  if (reader.parse())
+  {
+    TagIndexWriter w(xmlSize);
+    parser.writeIndex(w);
+    w.save(tagIndexFileName(fullName),xmlSize);
+  }
 }
 
+//---------------------------------------------------------------------------
+
+/** A tag file to be read by a TagFileThread */
+struct TagFileJob
+{
+  TagFileJob(const QCString &name,uint size,bool index)
+    : parser(name), fullName(name), xmlSize(size), useIndex(index)
+  {
+    parser.setFileName(name);
+  }
+  TagFileParser parser;
+  QCString fullName;
+  uint xmlSize;
+  bool useIndex;
+};
+
+/** Set of tag files that are read in parallel by TagFileThread workers */
+class TagFileJobs
+{
+  public:
+    TagFileJobs() : m_next(0) {}
+    void addJob(TagFileJob *job)
+    {
+      m_jobs.resize(m_jobs.size()+1);
+      m_jobs.insert(m_jobs.size()-1,job);
+    }
+    /** Returns the next job that still has to be done or 0 if
+     *  all jobs have been handed out.
+     */
+    TagFileJob *next()
+    {
+      QMutexLocker locker(&m_mutex);
+      if (m_next>=m_jobs.size()) return 0;
+      return m_jobs.at(m_next++);
+    }
+    uint count() const { return m_jobs.size(); }
+  private:
+    QVector<TagFileJob> m_jobs;
+    uint m_next;
+    QMutex m_mutex;
+};
 
+/** Worker thread that reads tag files */
+class TagFileThread : public QThread
+{
+  public:
+    TagFileThread(TagFileJobs *jobs) : m_jobs(jobs) {}
+    void run()
+    {
+      TagFileJob *job;
+      while ((job=m_jobs->next()))
+      {
+        loadTagFile(job->parser,job->fullName,job->xmlSize,job->useIndex);
+      }
+    }
+  private:
+    TagFileJobs *m_jobs;
+};
+
+/** Tag files that have been read by preloadTagFiles() but not yet 
+ *  merged into the entry tree by parseTagFile().
+ */
+static QDict<TagFileJob> g_preloadedTagFiles(257);
+
+void preloadTagFiles(const QStrList &tagFileList)
+{
+  int numThreads = getNumProcThreads();
+  if (numThreads<2 || tagFileList.count()<2) return; // nothing to gain
+
+  TagFileJobs jobs;
+  QStrListIterator it(tagFileList);
+  const char *s;
+  for (;(s=it.current());++it)
+  {
+    QCString fileName = s;
+    int eqPos = fileName.find('=');
+    if (eqPos!=-1) fileName = fileName.left(eqPos).stripWhiteSpace();
+    QFileInfo fi(fileName);
+    if (fi.exists() && fi.isFile())
+    {
+      QCString fullName = fi.absFilePath().utf8();
+      if (g_preloadedTagFiles.find(fullName)==0)
+      {
+        TagFileJob *job = new TagFileJob(fullName,fi.size(),hasUpToDateTagIndex(fullName));
+        jobs.addJob(job);
+        g_preloadedTagFiles.insert(fullName,job);
+      }
+    }
+  }
+
+  numThreads = QMIN(numThreads,(int)jobs.count());
+  msg("Reading %d tag files using %d threads...\n",jobs.count(),numThreads);
+  QList<TagFileThread> threads;
+  threads.setAutoDelete(TRUE);
+  int i;
+  for (i=0;i<numThreads;i++)
+  {
+    TagFileThread *thread = new TagFileThread(&jobs);
+    thread->start();
+    threads.append(thread);
+  }
+  for (i=0;i<numThreads;i++)
+  {
+    threads.at(i)->wait();
+  }
+}
+
+void parseTagFile(Entry *root,const char *fullName)
+{
+  TagFileJob *job = g_preloadedTagFiles.take(fullName);
+  if (job==0) // not read in advance
+  {
+    QFileInfo fi(fullName);
+    if (!fi.exists()) return;
+    job = new TagFileJob(fullName,fi.size(),hasUpToDateTagIndex(fullName));
+    loadTagFile(job->parser,fullName,job->xmlSize,job->useIndex);
+  }
+  job->parser.buildLists(root);
+  job->parser.addIncludes();
+  //job->parser.dump();
+  delete job;
+}
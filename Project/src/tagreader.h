@@ -20,7 +20,10 @@
 #define TAGREADER_H
 
 class Entry;
+class QStrList;
 
+void preloadTagFiles(const QStrList &tagFileList);
 void parseTagFile(Entry *root,const char *fullPathName);
+void writeTagFileIndex(const char *fullPathName);
 
 #endif
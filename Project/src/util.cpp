@@ -23,10 +23,12 @@
 #include "md5.h"
 
 #include <qregexp.h>
+#include <qvaluelist.h>
 #include <qfileinfo.h>
 #include <qdir.h>
 #include <qdatetime.h>
 #include <qcache.h>
+#include <qthread.h>
 
 #include "util.h"
 #include "message.h"
@@ -59,6 +61,7 @@
 #include "namespacedef.h"
 #include "membername.h"
 #include "filename.h"
+#include "filtercache.h"
 #include "membergroup.h"
 #include "dirdef.h"
 #include "htmlentity.h"
@@ -7700,23 +7703,13 @@ bool readInputFile(const char *fileName,BufStr &inBuf,bool filter,bool isSourceC
   }
   else
   {
-    QCString cmd=filterName+" \""+fileName+"\"";
-    Debug::print(Debug::ExtCmd,0,"Executing popen(`%s`)\n",qPrint(cmd));
-    FILE *f=portable_popen(cmd,"r");
-    if (!f)
+    uint orgPos = inBuf.curPos();
+    if (!FilterCache::readFilteredFile(fileName,filterName,inBuf))
     {
       err("could not execute filter %s\n",filterName.data());
       return FALSE;
     }
-    const int bufSize=1024;
-    char buf[bufSize];
-    int numRead;
-    while ((numRead=(int)fread(buf,1,bufSize,f))>0)
-    {
-      //printf(">>>>>>>>Reading %d bytes\n",numRead);
-      inBuf.addArray(buf,numRead),size+=numRead;
-    }
-    portable_pclose(f);
+    size=inBuf.curPos()-orgPos;
     inBuf.at(inBuf.curPos()) ='\0';
     Debug::print(Debug::FilterOutput, 0, "Filter output\n");
     Debug::print(Debug::FilterOutput,0,"-------------\n%s\n-------------\n",qPrint(inBuf));
@@ -7784,38 +7777,149 @@ QCString filterTitle(const QCString &title)
 
 bool patternMatch(const QFileInfo &fi,const QStrList *patList)
 {
-  bool found=FALSE;
-  if (patList)
-  { 
-    QStrListIterator it(*patList);
-    QCString pattern;
+  return FilePatternSet(patList).match(fi);
+}
 
-    QCString fn = fi.fileName().data();
-    QCString fp = fi.filePath().data();
-    QCString afp= fi.absFilePath().data();
+//----------------------------------------------------------------------------
 
-    for (it.toFirst();(pattern=it.current());++it)
-    {
-      if (!pattern.isEmpty())
-      {
-        int i=pattern.find('=');
-        if (i!=-1) pattern=pattern.left(i); // strip of the extension specific filter name
+struct FilePatternSet::Private
+{
+  Private() : extensions(257), matchAll(FALSE), empty(TRUE) {}
+  QDict<void>            extensions; // *.ext patterns, keyed on ext
+  QValueList<QCString>   literals;   // patterns without wildcards
+  QValueList<QCString>   prefixes;   // lit* patterns
+  QValueList<QCString>   suffixes;   // *lit patterns
+  QValueList<QCString>   infixes;    // *lit* patterns
+  QValueList<QRegExp>    regExps;    // all other patterns
+  bool                   matchAll;   // a * pattern was found
+  bool                   empty;
+};
 
 #if defined(_WIN32) || defined(__MACOSX__) // Windows or MacOSX
-        QRegExp re(pattern,FALSE,TRUE); // case insensitive match 
+static const bool patternCaseSensitive = FALSE;
 #else                // unix
-        QRegExp re(pattern,TRUE,TRUE);  // case sensitive match
+static const bool patternCaseSensitive = TRUE;
 #endif
-        found = re.match(fn)!=-1 ||
-                re.match(fp)!=-1 ||
-                re.match(afp)!=-1;
-        if (found) break;
-        //printf("Matching `%s' against pattern `%s' found=%d\n",
-        //    fi->fileName().data(),pattern.data(),found);
+
+static bool hasWildcards(const QCString &s)
+{
+  return s.find('*')!=-1 || s.find('?')!=-1 || s.find('[')!=-1;
+}
+
+FilePatternSet::FilePatternSet(const QStrList *patList)
+{
+  p = new Private;
+  if (patList==0) return;
+  QStrListIterator it(*patList);
+  QCString pattern;
+  for (it.toFirst();(pattern=it.current());++it)
+  {
+    int i=pattern.find('=');
+    if (i!=-1) pattern=pattern.left(i); // strip of the extension specific filter name
+    if (pattern.isEmpty()) continue;
+    p->empty=FALSE;
+
+    QCString lit = patternCaseSensitive ? pattern : pattern.lower();
+    bool leadingStar  = lit.at(0)=='*';
+    bool trailingStar = lit.length()>1 && lit.at(lit.length()-1)=='*';
+    if (leadingStar)  lit=lit.mid(1);
+    if (trailingStar) lit=lit.left(lit.length()-1);
+
+    if (lit.isEmpty()) // * or **
+    {
+      p->matchAll=TRUE;
+    }
+    else if (hasWildcards(lit))
+    {
+      p->regExps.append(QRegExp(pattern,patternCaseSensitive,TRUE));
+    }
+    else if (leadingStar && trailingStar)
+    {
+      p->infixes.append(lit);
+    }
+    else if (leadingStar)
+    {
+      if (lit.length()>1 && lit.at(0)=='.' && lit.find('.',1)==-1 && lit.find('/')==-1)
+      {
+        p->extensions.insert(lit.mid(1),(void*)0x8);
       }
+      else
+      {
+        p->suffixes.append(lit);
+      }
+    }
+    else if (trailingStar)
+    {
+      p->prefixes.append(lit);
+    }
+    else
+    {
+      p->literals.append(lit);
     }
   }
-  return found;
+}
+
+FilePatternSet::~FilePatternSet()
+{
+  delete p;
+}
+
+bool FilePatternSet::match(const QFileInfo &fi) const
+{
+  if (p->empty) return FALSE;
+  if (p->matchAll) return TRUE;
+  return match(fi.fileName().data(),fi.filePath().data(),fi.absFilePath().data());
+}
+
+static bool endsWith(const QCString &s,const QCString &suffix)
+{
+  uint sl=s.length(),l=suffix.length();
+  return sl>=l && qstrcmp(s.data()+sl-l,suffix.data())==0;
+}
+
+bool FilePatternSet::match(const QCString &fileName,const QCString &filePath,
+                           const QCString &absFilePath) const
+{
+  if (p->empty) return FALSE;
+  if (p->matchAll) return TRUE;
+  QCString fn  = patternCaseSensitive ? fileName    : fileName.lower();
+  QCString fp  = patternCaseSensitive ? filePath    : filePath.lower();
+  QCString afp = patternCaseSensitive ? absFilePath : absFilePath.lower();
+
+  // the file name is a suffix of both paths, so a suffix without a slash
+  // can only match if it matches the file name
+  if (!p->extensions.isEmpty())
+  {
+    int i=fn.findRev('.');
+    if (i!=-1 && p->extensions.find(fn.data()+i+1)) return TRUE;
+  }
+  QValueList<QCString>::ConstIterator it;
+  for (it=p->suffixes.begin();it!=p->suffixes.end();++it)
+  {
+    if (endsWith(fp,*it) || endsWith(afp,*it)) return TRUE;
+  }
+  for (it=p->infixes.begin();it!=p->infixes.end();++it)
+  {
+    if (fp.find(*it)!=-1 || afp.find(*it)!=-1) return TRUE;
+  }
+  for (it=p->literals.begin();it!=p->literals.end();++it)
+  {
+    if (fn==*it || fp==*it || afp==*it) return TRUE;
+  }
+  for (it=p->prefixes.begin();it!=p->prefixes.end();++it)
+  {
+    if (fn.left((*it).length())==*it ||
+        fp.left((*it).length())==*it ||
+        afp.left((*it).length())==*it) return TRUE;
+  }
+  QValueList<QRegExp>::ConstIterator rit;
+  for (rit=p->regExps.begin();rit!=p->regExps.end();++rit)
+  {
+    if ((*rit).match(fileName)!=-1 ||
+        (*rit).match(filePath)!=-1 ||
+        (*rit).match(absFilePath)!=-1) return TRUE;
+  }
+  return FALSE;
 }
 
 #if 0 // move to HtmlGenerator::writeSummaryLink
@@ -7896,17 +8000,11 @@ void writeColoredImgData(const char *dir,ColoredImgDataItem data[])
   {
     QCString fileName;
     fileName=(QCString)dir+"/"+data->name;
-    QFile f(fileName);
-    if (f.open(IO_WriteOnly))
-    {
-      ColoredImage img(data->width,data->height,data->content,data->alpha,
-                       sat,hue,gamma);
-      img.save(fileName);
-    }
-    else
-    {
-      fprintf(stderr,"Warning: Cannot open file %s for writing\n",data->name);
-    }
+    // the image is written by the ImageManager, which reports write errors
+    // and leaves files with the same content untouched
+    ColoredImage img(data->width,data->height,data->content,data->alpha,
+                     sat,hue,gamma);
+    img.save(fileName);
     Doxygen::indexList->addImageFile(data->name);
     data++;
   }
@@ -7970,6 +8068,9 @@ bool copyFile(const QCString &src,const QCString &dest)
   if (sf.open(IO_ReadOnly))
   {
     QFileInfo fi(src);
+    // replace rather than overwrite dest, it may be a hard link to an
+    // entry of the RESOURCE_CACHE_DIR
+    QFile::remove(dest);
     QFile df(dest);
     if (df.open(IO_WriteOnly))
     {
@@ -7993,6 +8094,31 @@ bool copyFile(const QCString &src,const QCString &dest)
   return TRUE;
 }
 
+/** Returns TRUE if \a fileName exists and contains the \a size bytes of
+ *  \a data. Only plain C I/O is used, so it can be called from other threads.
+ */
+bool fileHasContent(const char *fileName,const char *data,uint size)
+{
+  FILE *f = portable_fopen(fileName,"rb");
+  if (f==0) return FALSE;
+  bool same=FALSE;
+  if (portable_fseek(f,0,SEEK_END)==0 && portable_ftell(f)==(portable_off_t)size)
+  {
+    char buf[4096];
+    uint pos=0,n;
+    rewind(f);
+    same=TRUE;
+    while (same && (n=(uint)fread(buf,1,sizeof(buf),f))>0)
+    {
+      same = pos+n<=size && memcmp(buf,data+pos,n)==0;
+      pos+=n;
+    }
+    same = same && pos==size;
+  }
+  fclose(f);
+  return same;
+}
+
 /** Returns the section of text, in between a pair of markers. 
  *  Full lines are returned, excluding the lines on which the markers appear.
  */
@@ -8592,3 +8718,13 @@ bool openOutputFile(const char *outFile,QFile &f)
   return fileOpened;
 }
 
+/** Returns the number of threads that may be used for work that can
+ *  be done in parallel, as configured by NUM_PROC_THREADS.
+ */
+int getNumProcThreads()
+{
+  int numThreads = QMIN(32,Config_getInt(NUM_PROC_THREADS));
+  if (numThreads==0) numThreads = QMAX(1,QThread::idealThreadCount());
+  return numThreads;
+}
+
@@ -424,6 +424,27 @@ QCString filterTitle(const QCString &title);
 
 bool patternMatch(const QFileInfo &fi,const QStrList *patList);
 
+/** @brief A list of wildcard patterns (as used by FILE_PATTERNS and
+ *  EXCLUDE_PATTERNS) compiled once for matching many files.
+ *
+ *  Patterns that only consist of a literal with leading and/or trailing
+ *  `*` are matched with plain string operations, and patterns of the
+ *  form `*.ext` with a single dictionary lookup of the file's extension.
+ *  Only the remaining patterns need a regular expression.
+ */
+class FilePatternSet
+{
+  public:
+    FilePatternSet(const QStrList *patList);
+   ~FilePatternSet();
+    bool match(const QFileInfo &fi) const;
+    bool match(const QCString &fileName,const QCString &filePath,
+               const QCString &absFilePath) const;
+  private:
+    struct Private;
+    Private *p;
+};
+
 QCString externalLinkTarget();
 QCString externalRef(const QCString &relPath,const QCString &ref,bool href);
 int nextUtf8CharPosition(const QCString &utf8Str,int len,int startPos);
@@ -444,6 +465,8 @@ void writeColoredImgData(const char *dir,ColoredImgDataItem data[]);
 QCString replaceColorMarkers(const char *str);
 
 bool copyFile(const QCString &src,const QCString &dest);
+
+bool fileHasContent(const char *fileName,const char *data,uint size);
 QCString extractBlock(const QCString text,const QCString marker);
 
 QCString correctURL(const QCString &url,const QCString &relPath);
@@ -477,5 +500,7 @@ bool mainPageHasTitle();
 const QDict<int> &getExtensionLookup();
 bool openOutputFile(const char *outFile,QFile &f);
 
+int getNumProcThreads();
+
 #endif
 
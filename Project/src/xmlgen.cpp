@@ -47,6 +47,7 @@
 #include "section.h"
 #include "htmlentity.h"
 #include "resourcemgr.h"
+#include "filewriter.h"
 
 // no debug info
 #define XML_DB(x) do {} while(0)
@@ -151,6 +152,13 @@ static void writeXMLHeader(FTextStream &t)
   t << "version=\"" << versionString << "\">" << endl;
 }
 
+//------------------------------------------------------------------------------------------
+
+// pool writing the compound files when NUM_PROC_THREADS is larger than 1
+static FileWriterPool *g_xmlWriterPool = 0;
+
+//------------------------------------------------------------------------------------------
+
 static void writeCombineScript()
 {
   QCString outputDirectory = Config_getString(XML_OUTPUT);
@@ -1244,13 +1252,13 @@ static void generateXMLForClass(ClassDef *cd,FTextStream &ti)
   
   QCString outputDirectory = Config_getString(XML_OUTPUT);
   QCString fileName=outputDirectory+"/"+ classOutputFileBase(cd)+".xml";
-  QFile f(fileName);
-  if (!f.open(IO_WriteOnly))
+  PooledOutputFile f(fileName,g_xmlWriterPool);
+  if (!f.open())
   {
     err("Cannot open file %s for writing!\n",fileName.data());
     return;
   }
-  FTextStream t(&f);
+  FTextStream &t = f.stream();
   //t.setEncoding(FTextStream::UnicodeUTF8);
 
   writeXMLHeader(t);
@@ -1444,13 +1452,13 @@ static void generateXMLForNamespace(NamespaceDef *nd,FTextStream &ti)
   
   QCString outputDirectory = Config_getString(XML_OUTPUT);
   QCString fileName=outputDirectory+"/"+nd->getOutputFileBase()+".xml";
-  QFile f(fileName);
-  if (!f.open(IO_WriteOnly))
+  PooledOutputFile f(fileName,g_xmlWriterPool);
+  if (!f.open())
   {
     err("Cannot open file %s for writing!\n",fileName.data());
     return;
   }
-  FTextStream t(&f);
+  FTextStream &t = f.stream();
   //t.setEncoding(FTextStream::UnicodeUTF8);
   
   writeXMLHeader(t);
@@ -1525,13 +1533,13 @@ static void generateXMLForFile(FileDef *fd,FTextStream &ti)
   
   QCString outputDirectory = Config_getString(XML_OUTPUT);
   QCString fileName=outputDirectory+"/"+fd->getOutputFileBase()+".xml";
-  QFile f(fileName);
-  if (!f.open(IO_WriteOnly))
+  PooledOutputFile f(fileName,g_xmlWriterPool);
+  if (!f.open())
   {
     err("Cannot open file %s for writing!\n",fileName.data());
     return;
   }
-  FTextStream t(&f);
+  FTextStream &t = f.stream();
   //t.setEncoding(FTextStream::UnicodeUTF8);
 
   writeXMLHeader(t);
@@ -1662,14 +1670,14 @@ static void generateXMLForGroup(GroupDef *gd,FTextStream &ti)
   
   QCString outputDirectory = Config_getString(XML_OUTPUT);
   QCString fileName=outputDirectory+"/"+gd->getOutputFileBase()+".xml";
-  QFile f(fileName);
-  if (!f.open(IO_WriteOnly))
+  PooledOutputFile f(fileName,g_xmlWriterPool);
+  if (!f.open())
   {
     err("Cannot open file %s for writing!\n",fileName.data());
     return;
   }
 
-  FTextStream t(&f);
+  FTextStream &t = f.stream();
   //t.setEncoding(FTextStream::UnicodeUTF8);
   writeXMLHeader(t);
   t << "  <compounddef id=\"" 
@@ -1725,14 +1733,14 @@ static void generateXMLForDir(DirDef *dd,FTextStream &ti)
 
   QCString outputDirectory = Config_getString(XML_OUTPUT);
   QCString fileName=outputDirectory+"/"+dd->getOutputFileBase()+".xml";
-  QFile f(fileName);
-  if (!f.open(IO_WriteOnly))
+  PooledOutputFile f(fileName,g_xmlWriterPool);
+  if (!f.open())
   {
     err("Cannot open file %s for writing!\n",fileName.data());
     return;
   }
 
-  FTextStream t(&f);
+  FTextStream &t = f.stream();
   //t.setEncoding(FTextStream::UnicodeUTF8);
   writeXMLHeader(t);
   t << "  <compounddef id=\"" 
@@ -1778,14 +1786,14 @@ static void generateXMLForPage(PageDef *pd,FTextStream &ti,bool isExample)
   
   QCString outputDirectory = Config_getString(XML_OUTPUT);
   QCString fileName=outputDirectory+"/"+pageName+".xml";
-  QFile f(fileName);
-  if (!f.open(IO_WriteOnly))
+  PooledOutputFile f(fileName,g_xmlWriterPool);
+  if (!f.open())
   {
     err("Cannot open file %s for writing!\n",fileName.data());
     return;
   }
 
-  FTextStream t(&f);
+  FTextStream &t = f.stream();
   //t.setEncoding(FTextStream::UnicodeUTF8);
   writeXMLHeader(t);
   t << "  <compounddef id=\"" << pageName;
@@ -1903,6 +1911,14 @@ void generateXML()
   t << "xsi:noNamespaceSchemaLocation=\"index.xsd\" ";
   t << "version=\"" << versionString << "\">" << endl;
 
+  // compound files are generated in order, and written to disk by a pool
+  // of worker threads while the next one is being generated.
+  int numThreads = getNumProcThreads();
+  if (numThreads>1)
+  {
+    g_xmlWriterPool = new FileWriterPool(numThreads,numThreads*4);
+  }
+
   {
     ClassSDict::Iterator cli(*Doxygen::classSDict);
     ClassDef *cd;
@@ -1982,6 +1998,10 @@ void generateXML()
   //t << "  </compoundlist>" << endl;
   t << "</doxygenindex>" << endl;
 
+  // wait for the pending files to be written
+  delete g_xmlWriterPool;
+  g_xmlWriterPool=0;
+
   writeCombineScript();
 }
 
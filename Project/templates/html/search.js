@@ -321,10 +321,17 @@ function SearchBox(name, resultsPath, inFrame, label)
     var hasResultsPage;
 
     var idx = indexSectionsWithContent[this.searchIndex].indexOf(idxChar);
-    if (idx!=-1)
+    var shard = '';
+    if (idx!=-1 && typeof indexSectionShards!='undefined' &&
+        indexSectionShards[this.searchIndex] &&
+        indexSectionShards[this.searchIndex][idxChar])
+    {
+       shard = searchShard(searchValue.toLowerCase(),indexSectionShards[this.searchIndex][idxChar]);
+    }
+    if (idx!=-1 && shard!=null)
     {
        var hexCode=idx.toString(16);
-       resultsPage = this.resultsPath + '/' + indexSectionNames[this.searchIndex] + '_' + hexCode + '.html';
+       resultsPage = this.resultsPath + '/' + indexSectionNames[this.searchIndex] + '_' + hexCode + shard + '.html';
        resultsPageWithSearch = resultsPage+'?'+escape(searchValue);
        hasResultsPage = true;
     }
@@ -719,8 +726,60 @@ function setClassAttr(elem,attr)
   elem.setAttribute('className',attr);
 }
 
+// Returns the suffix of the results page for search value s in a letter
+// whose entries are split by their second character (see searchShardKey()
+// in searchindex.cpp). shards[0] holds the characters having a shard and
+// shards[1] tells if there is a shard for the other entries. Returns ''
+// to use the page of the whole letter, or null if nothing can match.
+function searchShard(s,shards)
+{
+  var id = convertToId(s);
+  var pos = 1;
+  var code = id.charCodeAt(0);
+  if (id.charAt(0)=='_') // encoded character
+  {
+    pos = 3;
+  }
+  else if (0xD800 <= code && code <= 0xDBFF) // surrogate pair
+  {
+    pos = 2;
+  }
+  if (id.length<=pos) // only the first character was typed
+  {
+    return '';
+  }
+  var c = id.charAt(pos);
+  if (c.charCodeAt(0)<0x80)
+  {
+    var q = shards[0].indexOf(c);
+    return q!=-1 ? '_'+q.toString(16) : null;
+  }
+  return shards[1] ? '_r' : null;
+}
+
+// Expands the urls of the search data. A child [n,'rest',target,scope]
+// stands for [url,target,scope], where url consists of the first n
+// characters of the url of the previous child followed by rest.
+function decodeSearchData()
+{
+  var lastUrl = '';
+  for (var e=0; e<searchData.length; e++)
+  {
+    var item = searchData[e][1];
+    for (var c=1; c<item.length; c++)
+    {
+      if (item[c].length==4)
+      {
+        lastUrl = lastUrl.substr(0,item[c][0])+item[c][1];
+        item[c] = [lastUrl,item[c][2],item[c][3]];
+      }
+    }
+  }
+}
+
 function createResults()
 {
+  decodeSearchData();
   var results = document.getElementById("SRResults");
   for (var e=0; e<searchData.length; e++)
   {
@@ -48,6 +48,19 @@ function readInt($file)
   return ($b1<<24)|($b2<<16)|($b3<<8)|$b4;
 }
 
+function readVarInt($file)
+{
+  $result=0;
+  $shift=0;
+  do
+  {
+    $b = ord(fgetc($file));
+    $result |= ($b&0x7f)<<$shift;
+    $shift+=7;
+  } while ($b&0x80);
+  return $result;
+}
+
 function readString($file)
 {
   $result="";
@@ -62,111 +75,156 @@ function readHeader($file)
   return $header;
 }
 
-function computeIndex($word)
+function readTrailer($file)
+{
+  fseek($file,-16,SEEK_END);
+  $numWords  = readInt($file);
+  $numUrls   = readInt($file);
+  $urlTable  = readInt($file);
+  $skipIndex = readInt($file);
+  return array("numWords"  => $numWords,
+               "numUrls"   => $numUrls,
+               "urlTable"  => $urlTable,
+               "skipIndex" => $skipIndex,
+               "numBlocks" => (int)(($numWords+63)/64)
+              );
+}
+
+function readBlockOffset($file,&$trailer,$block)
 {
-  // Simple hashing that allows for substring search
-  if (strlen($word)<2) return -1;
-  // high char of the index
-  $hi = ord($word{0});
-  if ($hi==0) return -1;
-  // low char of the index
-  $lo = ord($word{1});
-  if ($lo==0) return -1;
-  // return index
-  return $hi*256+$lo;
+  fseek($file,$trailer["skipIndex"]+$block*4);
+  return readInt($file);
 }
 
-function search($file,$word,&$statsList)
+function readFirstWord($file,$offset)
 {
-  $index = computeIndex($word);
-  if ($index!=-1) // found a valid index
+  fseek($file,$offset);
+  readVarInt($file); // always 0 at the start of a block
+  $len = readVarInt($file);
+  return $len>0 ? fread($file,$len) : "";
+}
+
+function findBlock($file,&$trailer,$word)
+{
+  // binary search for the last block starting with a word <= $word
+  $lo=0;
+  $hi=$trailer["numBlocks"]-1;
+  $found=0;
+  while ($lo<=$hi)
   {
-    fseek($file,$index*4+4); // 4 bytes per entry, skip header
-    $index = readInt($file);
-    if ($index) // found words matching the hash key
+    $mid=(int)(($lo+$hi)/2);
+    if (strcmp(readFirstWord($file,readBlockOffset($file,$trailer,$mid)),$word)<=0)
+    {
+      $found=$mid;
+      $lo=$mid+1;
+    }
+    else
     {
-      $start=sizeof($statsList);
-      $count=$start;
-      fseek($file,$index);
-      $w = readString($file);
-      while ($w)
+      $hi=$mid-1;
+    }
+  }
+  return $found;
+}
+
+function search($file,&$trailer,$word,&$statsList)
+{
+  if (strlen($word)>=2 && $trailer["numBlocks"]>0)
+  {
+    $start=sizeof($statsList);
+    $count=$start;
+    $block = findBlock($file,$trailer,$word);
+    fseek($file,readBlockOffset($file,$trailer,$block));
+    $w="";
+    for ($i=$block*64;$i<$trailer["numWords"];$i++)
+    {
+      $prefixLen = readVarInt($file);
+      $len = readVarInt($file);
+      $w = substr($w,0,$prefixLen).($len>0 ? fread($file,$len) : "");
+      $numDocs = readVarInt($file);
+      $docs = array();
+      $idx = 0;
+      for ($j=0;$j<$numDocs;$j++)
       {
-        $statIdx = readInt($file);
-        if ($word==substr($w,0,strlen($word)))
-        { // found word that matches (as substring)
-          $statsList[$count++]=array(
-              "word"=>$word,
-              "match"=>$w,
-              "index"=>$statIdx,
-              "full"=>strlen($w)==strlen($word),
-              "docs"=>array()
-              );
-        }
-        $w = readString($file);
+        $idx += readVarInt($file);
+        $docs[$j] = array("idx"=>$idx,"freq"=>readVarInt($file));
       }
-      $totalHi=0;
-      $totalFreqHi=0;
-      $totalFreqLo=0;
-      for ($count=$start;$count<sizeof($statsList);$count++)
+      if ($word==substr($w,0,strlen($word)))
+      { // found word that matches (as substring)
+        $statsList[$count++]=array(
+            "word"=>$word,
+            "match"=>$w,
+            "postings"=>$docs,
+            "full"=>strlen($w)==strlen($word),
+            "docs"=>array()
+            );
+      }
+      else if (strcmp($w,$word)>0) // past all words starting with $word
       {
-        $statInfo = &$statsList[$count];
-        $multiplier = 1;
-        // whole word matches have a double weight
-        if ($statInfo["full"]) $multiplier=2;
-        fseek($file,$statInfo["index"]); 
-        $numDocs = readInt($file);
-        $docInfo = array();
-        // read docs info + occurrence frequency of the word
-        for ($i=0;$i<$numDocs;$i++)
+        break;
+      }
+    }
+    $totalHi=0;
+    $totalFreqHi=0;
+    $totalFreqLo=0;
+    for ($count=$start;$count<sizeof($statsList);$count++)
+    {
+      $statInfo = &$statsList[$count];
+      $multiplier = 1;
+      // whole word matches have a double weight
+      if ($statInfo["full"]) $multiplier=2;
+      $numDocs = sizeof($statInfo["postings"]);
+      $docInfo = array();
+      // docs info + occurrence frequency of the word
+      for ($i=0;$i<$numDocs;$i++)
+      {
+        $idx=$statInfo["postings"][$i]["idx"];
+        $freq=$statInfo["postings"][$i]["freq"];
+        $docInfo[$i]=array("idx"  => $idx,
+                           "freq" => $freq>>1,
+                           "rank" => 0.0,
+                           "hi"   => $freq&1
+                          );
+        if ($freq&1) // word occurs in high priority doc
         {
-          $idx=readInt($file); 
-          $freq=readInt($file); 
-          $docInfo[$i]=array("idx"  => $idx,
-                             "freq" => $freq>>1,
-                             "rank" => 0.0,
-                             "hi"   => $freq&1
-                            );
-          if ($freq&1) // word occurs in high priority doc
-          {
-            $totalHi++;
-            $totalFreqHi+=$freq*$multiplier;
-          }
-          else // word occurs in low priority doc
-          {
-            $totalFreqLo+=$freq*$multiplier;
-          }
+          $totalHi++;
+          $totalFreqHi+=$freq*$multiplier;
         }
-        // read name and url info for the doc
-        for ($i=0;$i<$numDocs;$i++)
+        else // word occurs in low priority doc
         {
-          fseek($file,$docInfo[$i]["idx"]);
-          $docInfo[$i]["name"]=readString($file);
-          $docInfo[$i]["url"]=readString($file);
+          $totalFreqLo+=$freq*$multiplier;
         }
-        $statInfo["docs"]=$docInfo;
       }
-      $totalFreq=($totalHi+1)*$totalFreqLo + $totalFreqHi;
-      for ($count=$start;$count<sizeof($statsList);$count++)
+      // read name and url info for the doc
+      for ($i=0;$i<$numDocs;$i++)
+      {
+        fseek($file,$trailer["urlTable"]+$docInfo[$i]["idx"]*4);
+        fseek($file,readInt($file));
+        $docInfo[$i]["name"]=readString($file);
+        $docInfo[$i]["url"]=readString($file);
+      }
+      $statInfo["docs"]=$docInfo;
+    }
+    $totalFreq=($totalHi+1)*$totalFreqLo + $totalFreqHi;
+    for ($count=$start;$count<sizeof($statsList);$count++)
+    {
+      $statInfo = &$statsList[$count];
+      $multiplier = 1;
+      // whole word matches have a double weight
+      if ($statInfo["full"]) $multiplier=2;
+      for ($i=0;$i<sizeof($statInfo["docs"]);$i++)
       {
-        $statInfo = &$statsList[$count];
-        $multiplier = 1;
-        // whole word matches have a double weight
-        if ($statInfo["full"]) $multiplier=2;
-        for ($i=0;$i<sizeof($statInfo["docs"]);$i++)
+        $docInfo = &$statInfo["docs"];
+        // compute frequency rank of the word in each doc
+        $freq=$docInfo[$i]["freq"];
+        if ($docInfo[$i]["hi"])
+        {
+          $statInfo["docs"][$i]["rank"]=
+            (float)($freq*$multiplier+$totalFreqLo)/$totalFreq;
+        }
+        else
         {
-          $docInfo = &$statInfo["docs"];
-          // compute frequency rank of the word in each doc
-          $freq=$docInfo[$i]["freq"];
-          if ($docInfo[$i]["hi"])
-          {
-            $statInfo["docs"][$i]["rank"]=
-              (float)($freq*$multiplier+$totalFreqLo)/$totalFreq;
-          }
-          else
-          {
-            $statInfo["docs"][$i]["rank"]=
-              (float)($freq*$multiplier)/$totalFreq;
-          }
+          $statInfo["docs"][$i]["rank"]=
+            (float)($freq*$multiplier)/$totalFreq;
         }
       }
     }
@@ -316,10 +374,11 @@ function run_query($query)
   {
     die("Error: Search index file could NOT be opened!");
   }
-  if (readHeader($file)!="DOXS")
+  if (readHeader($file)!="DOX2")
   {
     die("Error: Header of index file is invalid!");
   }
+  $trailer = readTrailer($file);
   $results = array();
   $requiredWords = array();
   $forbiddenWords = array();
@@ -332,7 +391,7 @@ function run_query($query)
     if (!in_array($word,$foundWords))
     {
       $foundWords[]=$word;
-      search($file,strtolower($word),$results);
+      search($file,$trailer,strtolower($word),$results);
     }
     $word=strtok(" ");
   }
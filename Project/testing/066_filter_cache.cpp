@@ -0,0 +1,12 @@
+// objective: test that the input filter output is cached per file name and contents
+// check: 066__filter__cache_8cpp.xml
+// check: __066__filter__cache_8cpp.xml
+// config: INPUT = $INPUTDIR/066_filter_cache.cpp $INPUTDIR/_066_filter_cache.cpp
+// config: INPUT_FILTER = "sh $INPUTDIR/filter_cache.sh"
+// config: FILTER_SOURCE_FILES = YES
+// config: XML_PROGRAMLISTING = YES
+// config: NUM_PROC_THREADS = 2
+/** \file
+ *  \brief Filtered copy of FILE_NAME.
+ */
+/* filtered from FILE_NAME */
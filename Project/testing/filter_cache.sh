@@ -0,0 +1,6 @@
+#!/bin/sh
+# Input filter used by test 066: drops the test header and replaces
+# FILE_NAME by the base name of the filtered file, so two files with the
+# same contents get different output.
+name=`basename "$1" .cpp`
+sed -e '/^\/\/ /d' -e "s/FILE_NAME/$name/g" "$1"